@@ -91,4 +91,17 @@ FUNCTION(GTest_add_target target_name)
     target_link_libraries(${target_name} PRIVATE gtest_main)
     gtest_discover_tests(${target_name})
 
-ENDFUNCTION()
\ No newline at end of file
+ENDFUNCTION()
+
+#
+# Bench_add_target sets the build path and flags for a benchmark executable
+# and places the result in the ${CMAKE_BINARY_DIR}/bench_bin. Benchmarks are
+# built without the sanitizers so the timings are not skewed by them
+#
+FUNCTION(Bench_add_target target_name)
+    set_target_properties(
+            ${target_name} PROPERTIES
+            RUNTIME_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR}/bench_bin
+            COMPILE_OPTIONS "-O2;-Wall;-Werror"
+    )
+ENDFUNCTION()
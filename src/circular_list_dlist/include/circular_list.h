@@ -51,12 +51,17 @@ typedef enum
 
 
 clist_t * clist_init(uint32_t list_size, clist_match_t (* compare_func)(void *, void *), void (* free_func)(void *));
+clist_t * clist_init_intrusive(uint32_t list_size,
+                               size_t link_offset,
+                               clist_match_t (* compare_func)(void *, void *),
+                               void (* free_func)(void *));
 void clist_destroy(clist_t * clist, clist_delete_t remove_nodes);
 size_t clist_get_length(clist_t * clist);
 void * clist_get_value(clist_t * clist);
 void * clist_get_next(clist_t * clist);
 void * clist_find(clist_t * clist, void * node);
 void * clist_remove(clist_t * clist, void * node);
+void clist_unlink(clist_t * clist, void * node);
 void clist_quick_sort(clist_t * clist,
                       sort_order_t order,
                       clist_compare_t (* compare_func)(void *, void *));
@@ -1,17 +1,30 @@
 #include <circular_list.h>
 #include <dl_list.h>
+#include <dl_ilist.h>
 #include <stdio.h>
 #include <malloc.h>
+#include <assert.h>
 
 typedef struct clist_t
 {
-    dlist_t * dlist;
+    dlist_t * dlist;            // NULL for an intrusive clist
     dlist_iter_t * iter;
+    ilist_t ilist;              // Links embedded in the nodes of an intrusive clist
+    ilist_link_t * current;     // Position of the rotation of an intrusive clist
+    size_t link_offset;         // Offset of the link in the nodes
     uint32_t clist_size;
     clist_match_t (* compare_func)(void *, void *);
     void (* free_func)(void *);
 } clist_t;
 
+static void * get_node(clist_t * clist, ilist_link_t * link);
+static ilist_link_t * get_link(clist_t * clist, void * node);
+static ilist_link_t * get_link_by_index(clist_t * clist, int32_t index);
+static ilist_link_t * find_link(clist_t * clist, void * node);
+static void unlink_node(clist_t * clist, ilist_link_t * link);
+
+
+
 /*!
  * @brief Initialize the circular linked list with a size limit. If any errors
  * occur then a NULL is returned otherwise a pointer to the clist is retured.
@@ -59,6 +72,43 @@ clist_t * clist_init(uint32_t list_size, clist_match_t (* compare_func)(void *,
     return clist;
 }
 
+/*!
+ * @brief Initialize a circular linked list that chains the nodes together
+ * through an ilist_link_t embedded in each node instead of allocating a
+ * dlist node for them. Inserting and removing never allocate.
+ * @param list_size
+ * @param link_offset Offset of the ilist_link_t in the nodes, from offsetof
+ * @param compare_func
+ * @param free_func
+ * @return NULL or error or clist_t pointer
+ */
+clist_t * clist_init_intrusive(uint32_t list_size,
+                               size_t link_offset,
+                               clist_match_t (* compare_func)(void *, void *),
+                               void (* free_func)(void *))
+{
+    clist_t * clist = (clist_t *)malloc(sizeof(clist_t));
+    if (NULL == clist)
+    {
+        fprintf(stderr, "[!] Unable to allocate memory for circular "
+                        "linked list\n");
+        return NULL;
+    }
+
+    * clist = (clist_t) {
+        .dlist          = NULL,
+        .iter           = NULL,
+        .current        = NULL,
+        .link_offset    = link_offset,
+        .clist_size     = list_size,
+        .compare_func   = compare_func,
+        .free_func      = free_func,
+    };
+    ilist_init(&clist->ilist);
+
+    return clist;
+}
+
 /*!
  * @brief Free the circular linked list with the option of freeing all the nodes
  * using the free function pointer.
@@ -68,6 +118,18 @@ clist_t * clist_init(uint32_t list_size, clist_match_t (* compare_func)(void *,
  */
 void clist_destroy(clist_t * clist, clist_delete_t remove_nodes)
 {
+    if (NULL == clist->dlist)
+    {
+        ilist_link_t * link = ilist_pop_head(&clist->ilist);
+        while ((FREE_NODES_TRUE == remove_nodes) && (NULL != link))
+        {
+            clist->free_func(get_node(clist, link));
+            link = ilist_pop_head(&clist->ilist);
+        }
+        free(clist);
+        return;
+    }
+
     dlist_destroy_iter(clist->iter);
     if (FREE_NODES_TRUE == remove_nodes)
     {
@@ -89,6 +151,10 @@ void clist_destroy(clist_t * clist, clist_delete_t remove_nodes)
  */
 size_t clist_get_length(clist_t * clist)
 {
+    if (NULL == clist->dlist)
+    {
+        return ilist_get_length(&clist->ilist);
+    }
     return dlist_get_length(clist->dlist);
 }
 
@@ -111,6 +177,34 @@ size_t clist_get_length(clist_t * clist)
 clist_result_t clist_insert(clist_t * clist, void * node, int32_t index, clist_location_t insert_at)
 {
     clist_result_t result = C_SUCCESS;
+    if (NULL == clist->dlist)
+    {
+        ilist_link_t * link = get_link(clist, node);
+        if ((HEAD == insert_at) || (ilist_is_empty(&clist->ilist)))
+        {
+            ilist_push_head(&clist->ilist, link);
+        }
+        else if (TAIL == insert_at)
+        {
+            ilist_push_tail(&clist->ilist, link);
+        }
+        else
+        {
+            ilist_link_t * position = get_link_by_index(clist, index);
+            if (NULL == position)
+            {
+                return C_FAIL;
+            }
+            ilist_insert_before(&clist->ilist, position, link);
+        }
+
+        if (NULL == clist->current)
+        {
+            clist->current = link;
+        }
+        return result;
+    }
+
     if (HEAD == insert_at)
     {
         dlist_prepend(clist->dlist, node);
@@ -143,6 +237,10 @@ clist_result_t clist_insert(clist_t * clist, void * node, int32_t index, clist_l
  */
 void * clist_get_value(clist_t * clist)
 {
+    if (NULL == clist->dlist)
+    {
+        return get_node(clist, clist->current);
+    }
     return iter_get_value(clist->iter);
 }
 
@@ -155,6 +253,20 @@ void * clist_get_value(clist_t * clist)
  */
 void * clist_get_next(clist_t * clist)
 {
+    if (NULL == clist->dlist)
+    {
+        if (NULL == clist->current)
+        {
+            return NULL;
+        }
+        clist->current = ilist_get_next(&clist->ilist, clist->current);
+        if (NULL == clist->current)
+        {
+            clist->current = ilist_get_head(&clist->ilist);
+        }
+        return get_node(clist, clist->current);
+    }
+
     void * node = dlist_get_iter_next(clist->iter);
     if (NULL == node)
     {
@@ -176,6 +288,10 @@ void * clist_get_next(clist_t * clist)
  */
 void * clist_find(clist_t * clist, void * node)
 {
+    if (NULL == clist->dlist)
+    {
+        return get_node(clist, find_link(clist, node));
+    }
     return dlist_get_by_value(clist->dlist, node);
 }
 
@@ -189,15 +305,158 @@ void * clist_find(clist_t * clist, void * node)
  */
 void * clist_remove(clist_t * clist, void * node)
 {
+    if (NULL == clist->dlist)
+    {
+        ilist_link_t * link = find_link(clist, node);
+        if (NULL != link)
+        {
+            unlink_node(clist, link);
+        }
+        return get_node(clist, link);
+    }
+
     // get the index of the node in the iter if any to understand if we need
     // to manipulate the iter object
     return dlist_remove_value(clist->dlist, node);
 }
 
+/*!
+ * @brief Remove the node itself from an intrusive circular linked list in
+ * O(1). If the node is the current node of the rotation, the rotation moves
+ * on to the next node.
+ * @param clist Circular linked list created with clist_init_intrusive
+ * @param node Node in the list
+ */
+void clist_unlink(clist_t * clist, void * node)
+{
+    assert(clist);
+    assert(node);
+    assert(NULL == clist->dlist);
+    unlink_node(clist, get_link(clist, node));
+}
+
 void clist_quick_sort(clist_t * clist,
                       sort_order_t order,
                       clist_compare_t (* compare_func)(void *, void *))
 {
-    dlist_quick_sort(clist->dlist, (sort_direction_t)order,
+    if (NULL == clist->dlist)
+    {
+        ilist_sort(&clist->ilist, clist->link_offset, (sort_direction_t)order,
+                   (dlist_compare_t (*)(void *, void *))compare_func);
+        clist->current = ilist_get_head(&clist->ilist);
+        return;
+    }
+    dlist_merge_sort(clist->dlist, (sort_direction_t)order,
                      (dlist_compare_t (*)(void *, void *))compare_func);
 }
+
+/*!
+ * @brief Return the node the link is embedded in
+ * @param clist
+ * @param link
+ * @return Node or NULL if the link is NULL
+ */
+static void * get_node(clist_t * clist, ilist_link_t * link)
+{
+    return (NULL == link) ? NULL : (char *)link - clist->link_offset;
+}
+
+/*!
+ * @brief Return the link embedded in the node
+ * @param clist
+ * @param node
+ * @return Link of the node
+ */
+static ilist_link_t * get_link(clist_t * clist, void * node)
+{
+    return (ilist_link_t *)((char *)node + clist->link_offset);
+}
+
+/*!
+ * @brief Return the link at the index. A negative index counts back from the
+ * tail with -1 being the tail.
+ * @param clist
+ * @param index
+ * @return Link or NULL if the index is out of range
+ */
+static ilist_link_t * get_link_by_index(clist_t * clist, int32_t index)
+{
+    size_t length = ilist_get_length(&clist->ilist);
+    size_t position = (size_t)index;
+    if (index < 0)
+    {
+        if ((size_t)(-(int64_t)index) > length)
+        {
+            return NULL;
+        }
+        position = length - (size_t)(-(int64_t)index);
+    }
+    if (position >= length)
+    {
+        return NULL;
+    }
+
+    // Walk from the nearer end
+    ilist_link_t * link = NULL;
+    if (position < (length / 2))
+    {
+        link = ilist_get_head(&clist->ilist);
+        for (size_t i = 0; i < position; i++)
+        {
+            link = ilist_get_next(&clist->ilist, link);
+        }
+    }
+    else
+    {
+        link = ilist_get_tail(&clist->ilist);
+        for (size_t i = length - 1; i > position; i--)
+        {
+            link = ilist_get_prev(&clist->ilist, link);
+        }
+    }
+    return link;
+}
+
+/*!
+ * @brief Find the link of the first node matching with the comparison
+ * function
+ * @param clist
+ * @param node
+ * @return Link or NULL if not found
+ */
+static ilist_link_t * find_link(clist_t * clist, void * node)
+{
+    ilist_link_t * link = ilist_get_head(&clist->ilist);
+    while (NULL != link)
+    {
+        if (CLIST_MATCH == clist->compare_func(get_node(clist, link), node))
+        {
+            return link;
+        }
+        link = ilist_get_next(&clist->ilist, link);
+    }
+    return NULL;
+}
+
+/*!
+ * @brief Remove the link from the list while keeping the rotation on a node
+ * of the list
+ * @param clist
+ * @param link
+ */
+static void unlink_node(clist_t * clist, ilist_link_t * link)
+{
+    if (clist->current == link)
+    {
+        clist->current = ilist_get_next(&clist->ilist, link);
+        if (NULL == clist->current)
+        {
+            clist->current = ilist_get_head(&clist->ilist);
+        }
+    }
+    ilist_remove(&clist->ilist, link);
+    if (ilist_is_empty(&clist->ilist))
+    {
+        clist->current = NULL;
+    }
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <circular_list.h>
+#include <dl_ilist.h>
 
 // Function to create payloads for testing
 char * get_payload(const char * string)
@@ -150,3 +151,72 @@ TEST_F(CListTestFixture, TestAbilityToDeleteAll)
     }
 
 }
+
+/*
+ * Node with an embedded link for the intrusive circular linked list
+ */
+typedef struct
+{
+    char word[16];
+    ilist_link_t link;
+} word_node_t;
+
+clist_compare_t compare_word_nodes(void * l, void * r)
+{
+    return compare_payloads(((word_node_t *)l)->word, ((word_node_t *)r)->word);
+}
+
+clist_match_t match_word_nodes(void * l, void * r)
+{
+    return match_payloads(((word_node_t *)l)->word, ((word_node_t *)r)->word);
+}
+
+TEST(CListIntrusiveTest, RotateSortAndUnlink)
+{
+    std::vector<std::string> words = {
+        "one", "two", "Three", "four", "5", "six", "seven"
+    };
+    std::vector<word_node_t> nodes(words.size());
+    clist_t * clist = clist_init_intrusive((uint32_t)words.size(),
+                                           offsetof(word_node_t, link),
+                                           match_word_nodes, nullptr);
+    ASSERT_NE(clist, nullptr);
+    EXPECT_EQ(clist_get_value(clist), nullptr);
+    for (size_t i = 0; i < words.size(); i++)
+    {
+        snprintf(nodes[i].word, sizeof(nodes[i].word), "%s", words[i].c_str());
+        clist_insert(clist, &nodes[i], 0, TAIL);
+    }
+    EXPECT_EQ(clist_get_length(clist), words.size());
+
+    // The rotation wraps around to the head
+    word_node_t * node = (word_node_t *)clist_get_value(clist);
+    for (size_t i = 0; i < (words.size() * 2); i++)
+    {
+        EXPECT_STREQ(node->word, words[i % words.size()].c_str());
+        node = (word_node_t *)clist_get_next(clist);
+    }
+
+    word_node_t target = {"four", {}};
+    EXPECT_EQ(clist_find(clist, &target), &nodes[3]);
+    EXPECT_EQ(clist_remove(clist, &target), &nodes[3]);
+    EXPECT_EQ(clist_find(clist, &target), nullptr);
+    EXPECT_EQ(clist_insert(clist, &nodes[3], -1, INDEX), C_SUCCESS);
+    EXPECT_EQ(clist_insert(clist, &target, 20, INDEX), C_FAIL);
+
+    std::sort(words.begin(), words.end());
+    clist_quick_sort(clist, C_ASCENDING, compare_word_nodes);
+    node = (word_node_t *)clist_get_value(clist);
+    for (std::string & word : words)
+    {
+        EXPECT_STREQ(node->word, word.c_str());
+        node = (word_node_t *)clist_get_next(clist);
+    }
+
+    // Unlinking the current node moves the rotation to the next node
+    clist_unlink(clist, node);
+    EXPECT_STREQ(((word_node_t *)clist_get_value(clist))->word,
+                 words[1].c_str());
+    EXPECT_EQ(clist_get_length(clist), words.size() - 1);
+    clist_destroy(clist, FREE_NODES_FALSE);
+}
@@ -0,0 +1,200 @@
+/*
+ * Compares the unrolled list against the dlist on a large list. Each list is
+ * walked from head to tail (the dlist also with dlist_for_each), searched by
+ * value for items near the tail (the dlist also with a hash index) and
+ * indexed at random positions. The dlist is also read by every index in
+ * order.
+ *
+ * Usage: dlist_bench [item_count] [query_count]
+ */
+#include <dl_list.h>
+#include <dl_ulist.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/*
+ * Sum of the visited items, printed so the compiler can not drop the work
+ */
+static uint64_t checksum = 0;
+
+static dlist_match_t match_ints(void * data1, void * data2)
+{
+    if (* (int *)data1 == * (int *)data2)
+    {
+        return DLIST_MATCH;
+    }
+    return DLIST_MISS_MATCH;
+}
+
+static size_t hash_int(void * data)
+{
+    return (size_t)* (int *)data;
+}
+
+static void add_to_checksum(void * data, void * context)
+{
+    * (uint64_t *)context += (uint64_t)* (int *)data;
+}
+
+template <typename Func>
+static double time_ns(Func func)
+{
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+static void report(const char * name, const char * operation, double elapsed,
+                   size_t count)
+{
+    printf("%-8s %-12s %12.2f ns/op\n", name, operation,
+           elapsed / (double)count);
+}
+
+static void bench_dlist(std::vector<int> & values,
+                        const std::vector<int> & targets,
+                        const std::vector<int32_t> & indexes)
+{
+    dlist_t * dlist = dlist_init(match_ints);
+    double elapsed = time_ns([&]() {
+        for (int & value : values)
+        {
+            dlist_append(dlist, &value);
+        }
+    });
+    report("dlist", "append", elapsed, values.size());
+
+    elapsed = time_ns([&]() {
+        dlist_iter_t * iter = dlist_get_iterable(dlist, ITER_HEAD);
+        for (int * value = (int *)iter_get_value(iter); NULL != value;
+             value = (int *)dlist_get_iter_next(iter))
+        {
+            checksum += (uint64_t)* value;
+        }
+        dlist_destroy_iter(iter);
+    });
+    report("dlist", "iterate", elapsed, values.size());
+
+    elapsed = time_ns([&]() {
+        dlist_for_each(dlist, add_to_checksum, &checksum);
+    });
+    report("dlist", "for each", elapsed, values.size());
+
+    elapsed = time_ns([&]() {
+        for (int target : targets)
+        {
+            checksum += (uint64_t)* (int *)dlist_get_by_value(dlist, &target);
+        }
+    });
+    report("dlist", "by value", elapsed, targets.size());
+
+    dlist_set_hash_index(dlist, hash_int);
+    elapsed = time_ns([&]() {
+        for (int target : targets)
+        {
+            checksum += (uint64_t)* (int *)dlist_get_by_value(dlist, &target);
+        }
+    });
+    report("dlist", "hashed", elapsed, targets.size());
+
+    elapsed = time_ns([&]() {
+        for (int32_t index : indexes)
+        {
+            checksum += (uint64_t)* (int *)dlist_get_by_index(dlist, index);
+        }
+    });
+    report("dlist", "by index", elapsed, indexes.size());
+
+    elapsed = time_ns([&]() {
+        int32_t length = (int32_t)values.size();
+        for (int32_t index = 0; index < length; index++)
+        {
+            checksum += (uint64_t)* (int *)dlist_get_by_index(dlist, index);
+        }
+    });
+    report("dlist", "index walk", elapsed, values.size());
+    dlist_destroy(dlist);
+}
+
+static void bench_ulist(std::vector<int> & values,
+                        const std::vector<int> & targets,
+                        const std::vector<int32_t> & indexes)
+{
+    ulist_t * ulist = ulist_init(match_ints);
+    double elapsed = time_ns([&]() {
+        for (int & value : values)
+        {
+            ulist_append(ulist, &value);
+        }
+    });
+    report("ulist", "append", elapsed, values.size());
+
+    elapsed = time_ns([&]() {
+        ulist_iter_t iter;
+        ulist_iter_init(ulist, &iter, ITER_HEAD);
+        for (int * value = (int *)ulist_iter_next(&iter); NULL != value;
+             value = (int *)ulist_iter_next(&iter))
+        {
+            checksum += (uint64_t)* value;
+        }
+    });
+    report("ulist", "iterate", elapsed, values.size());
+
+    elapsed = time_ns([&]() {
+        for (int target : targets)
+        {
+            checksum += (uint64_t)* (int *)ulist_get_by_value(ulist, &target);
+        }
+    });
+    report("ulist", "by value", elapsed, targets.size());
+
+    elapsed = time_ns([&]() {
+        for (int32_t index : indexes)
+        {
+            checksum += (uint64_t)* (int *)ulist_get_by_index(ulist, index);
+        }
+    });
+    report("ulist", "by index", elapsed, indexes.size());
+    ulist_destroy(ulist);
+}
+
+int main(int argc, char ** argv)
+{
+    size_t item_count = 1000000;
+    size_t query_count = 20;
+    if (argc > 1)
+    {
+        item_count = strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2)
+    {
+        query_count = strtoul(argv[2], NULL, 10);
+    }
+
+    std::vector<int> values(item_count);
+    for (size_t i = 0; i < item_count; i++)
+    {
+        values[i] = (int)i;
+    }
+
+    // Searches look for items in the last quarter of the list
+    std::mt19937 engine(7);
+    std::vector<int> targets(query_count);
+    std::vector<int32_t> indexes(query_count);
+    for (size_t i = 0; i < query_count; i++)
+    {
+        targets[i] = (int)(item_count - 1 - (engine() % (item_count / 4)));
+        indexes[i] = (int32_t)(engine() % item_count);
+    }
+
+    printf("%zu items, %zu queries\n", item_count, query_count);
+    bench_dlist(values, targets, indexes);
+    bench_ulist(values, targets, indexes);
+    printf("checksum %llu\n", (unsigned long long)checksum);
+    return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef DATA_STRUCTURES_C_DLIST_ADT_INCLUDE_DL_ILIST_H_
+#define DATA_STRUCTURES_C_DLIST_ADT_INCLUDE_DL_ILIST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+#include <stdbool.h>
+#include <stddef.h>
+#include <dl_list.h>
+
+/*
+ * Intrusive doubly linked list. The caller embeds an ilist_link_t in their
+ * own structure and the list chains the links together, so no memory is
+ * allocated by the list. ilist_entry turns a link back into its structure.
+ */
+typedef struct ilist_link_t
+{
+    struct ilist_link_t * next;
+    struct ilist_link_t * prev;
+} ilist_link_t;
+
+// The head is a sentinel link, the list is circular through it
+typedef struct ilist_t
+{
+    ilist_link_t head;
+    size_t length;
+} ilist_t;
+
+#define ilist_entry(link, type, member) \
+    ((type *)((char *)(link) - offsetof(type, member)))
+
+// constructors
+void ilist_init(ilist_t * list);
+void ilist_link_init(ilist_link_t * link);
+
+// inserting methods
+void ilist_push_head(ilist_t * list, ilist_link_t * link);
+void ilist_push_tail(ilist_t * list, ilist_link_t * link);
+void ilist_insert_before(ilist_t * list, ilist_link_t * position, ilist_link_t * link);
+void ilist_insert_after(ilist_t * list, ilist_link_t * position, ilist_link_t * link);
+
+// manipulation methods
+ilist_link_t * ilist_pop_head(ilist_t * list);
+ilist_link_t * ilist_pop_tail(ilist_t * list);
+void ilist_remove(ilist_t * list, ilist_link_t * link);
+void ilist_sort(ilist_t * list,
+                size_t link_offset,
+                sort_direction_t direction,
+                dlist_compare_t (* compare_func)(void *, void *));
+
+// traversal methods
+ilist_link_t * ilist_get_head(ilist_t * list);
+ilist_link_t * ilist_get_tail(ilist_t * list);
+ilist_link_t * ilist_get_next(ilist_t * list, ilist_link_t * link);
+ilist_link_t * ilist_get_prev(ilist_t * list, ilist_link_t * link);
+
+// metadata methods
+bool ilist_is_empty(ilist_t * list);
+size_t ilist_get_length(ilist_t * list);
+bool ilist_is_linked(ilist_link_t * link);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+#endif //DATA_STRUCTURES_C_DLIST_ADT_INCLUDE_DL_ILIST_H_
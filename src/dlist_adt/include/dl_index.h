@@ -0,0 +1,27 @@
+#ifndef DATA_STRUCTURES_C_DLIST_ADT_INCLUDE_DL_INDEX_H_
+#define DATA_STRUCTURES_C_DLIST_ADT_INCLUDE_DL_INDEX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+#include <dl_list.h>
+
+// Hash index of the nodes of a dlist by their data, used by the dlist API
+// once an index was requested with dlist_set_hash_index.
+typedef struct dlist_index_t dlist_index_t;
+
+dlist_index_t * index_init(size_t (* hash_func)(void *));
+void index_destroy(dlist_index_t * index);
+void index_clear(dlist_index_t * index);
+size_t (* index_get_hash_func(dlist_index_t * index))(void *);
+valid_ptr_t index_add(dlist_index_t * index, dnode_t * node);
+void index_remove(dlist_index_t * index, dnode_t * node);
+dnode_t * index_find(dlist_index_t * index,
+                     void * data,
+                     dlist_match_t (* compare_func)(void *, void *),
+                     bool * is_unique);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+#endif //DATA_STRUCTURES_C_DLIST_ADT_INCLUDE_DL_INDEX_H_
@@ -55,16 +55,39 @@ typedef enum
 
 typedef struct dlist_t dlist_t;
 typedef struct dlist_iter_t dlist_iter_t;
+typedef struct dlist_pool_t dlist_pool_t;
+
+// Cursors are plain values owned by the caller, usually on the stack. They
+// are not registered with the dlist, so creating one costs nothing, but any
+// insert, removal or sort of the dlist invalidates them.
+typedef struct dlist_cursor_t
+{
+    dlist_t * dlist;
+    dnode_t * node;
+    int32_t index;
+    uint64_t generation;    // Generation of the dlist the cursor is valid for
+} dlist_cursor_t;
 
 // constructors and descriptors
 dlist_t * dlist_init(dlist_match_t (* compare_func)(void *, void *));
+dlist_t * dlist_init_pooled(dlist_match_t (* compare_func)(void *, void *),
+                            dlist_pool_t * pool);
 void dlist_destroy(dlist_t * dlist);
 void dlist_destroy_free(dlist_t * dlist, void (* free_func)(void *));
 
+// node pools
+dlist_pool_t * dlist_pool_init(void);
+void dlist_pool_destroy(dlist_pool_t * pool);
+
+// hash index
+dlist_result_t dlist_set_hash_index(dlist_t * dlist, size_t (* hash_func)(void *));
+
 // inserting methods
 void dlist_append(dlist_t * dlist, void * data);
 void dlist_prepend(dlist_t * dlist, void * data);
 dlist_result_t dlist_insert(dlist_t * dlist, void * data, int32_t index);
+dnode_t * dlist_append_node(dlist_t * dlist, void * data);
+dnode_t * dlist_prepend_node(dlist_t * dlist, void * data);
 
 
 // manipulation methods
@@ -73,6 +96,29 @@ void * dlist_pop_head(dlist_t * dlist);
 void * dlist_get_by_value(dlist_t * dlist, void * data);
 void * dlist_get_by_index(dlist_t * dlist, int32_t index);
 void * dlist_remove_value(dlist_t * dlist, void * data);
+dnode_t * dlist_find_node(dlist_t * dlist, void * data);
+void * dlist_remove_node(dlist_t * dlist, dnode_t * node);
+
+// bulk methods
+void dlist_for_each(dlist_t * dlist,
+                    void (* func)(void * data, void * context),
+                    void * context);
+size_t dlist_remove_if(dlist_t * dlist,
+                       bool (* predicate)(void * data, void * context),
+                       void * context,
+                       void (* free_func)(void *));
+void dlist_map(dlist_t * dlist,
+               void * (* func)(void * data, void * context),
+               void * context);
+
+// splicing methods
+dlist_result_t dlist_concat(dlist_t * dlist, dlist_t * other);
+dlist_result_t dlist_splice(dlist_t * dlist,
+                            int32_t index,
+                            dlist_t * other,
+                            int32_t first,
+                            int32_t count);
+dlist_t * dlist_split_at(dlist_t * dlist, int32_t index);
 
 // metadata methods
 bool dlist_is_empty(dlist_t * dlist);
@@ -93,10 +139,21 @@ void dlist_set_iter_tail(dlist_iter_t * dlist_iter);
 int32_t dlist_get_iter_index(dlist_iter_t * dlist_iter);
 void dlist_destroy_iter(dlist_iter_t * iter);
 
+// cursors
+dlist_cursor_t dlist_get_cursor(dlist_t * dlist, iter_start_t pos);
+bool dlist_cursor_is_valid(dlist_cursor_t * cursor);
+void * dlist_cursor_get_value(dlist_cursor_t * cursor);
+void * dlist_cursor_next(dlist_cursor_t * cursor);
+void * dlist_cursor_prev(dlist_cursor_t * cursor);
+int32_t dlist_cursor_get_index(dlist_cursor_t * cursor);
+
 // Sorting
 void dlist_quick_sort(dlist_t * dlist,
                       sort_direction_t direction,
                       dlist_compare_t (* compare_func)(void *, void *));
+void dlist_merge_sort(dlist_t * dlist,
+                      sort_direction_t direction,
+                      dlist_compare_t (* compare_func)(void *, void *));
 
 valid_ptr_t verify_alloc(void * ptr);
 
@@ -0,0 +1,19 @@
+#ifndef DATA_STRUCTURES_C_DLIST_ADT_INCLUDE_DL_POOL_H_
+#define DATA_STRUCTURES_C_DLIST_ADT_INCLUDE_DL_POOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+#include <dl_list.h>
+
+// Node pool functions used by the dlist API. The pool itself is created and
+// destroyed with dlist_pool_init and dlist_pool_destroy.
+dnode_t * pool_acquire_node(dlist_pool_t * pool);
+void pool_release_node(dlist_pool_t * pool, dnode_t * node);
+void pool_retain(dlist_pool_t * pool);
+void pool_release(dlist_pool_t * pool);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+#endif //DATA_STRUCTURES_C_DLIST_ADT_INCLUDE_DL_POOL_H_
@@ -0,0 +1,59 @@
+#ifndef DATA_STRUCTURES_C_DLIST_ADT_INCLUDE_DL_ULIST_H_
+#define DATA_STRUCTURES_C_DLIST_ADT_INCLUDE_DL_ULIST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <dl_list.h>
+
+/*
+ * Unrolled doubly linked list. It has the same operations as dlist_t but
+ * stores the data pointers in chunks of contiguous slots, so iterating and
+ * searching walk arrays instead of chasing a pointer per item. The match and
+ * result codes are shared with dl_list.h.
+ */
+typedef struct ulist_t ulist_t;
+typedef struct ulist_chunk_t ulist_chunk_t;
+
+// Iterators live on the stack of the caller and are never allocated. The
+// list must not be changed while an iterator is in use.
+typedef struct ulist_iter_t
+{
+    ulist_chunk_t * chunk;
+    size_t slot;
+} ulist_iter_t;
+
+// constructors and descriptors
+ulist_t * ulist_init(dlist_match_t (* compare_func)(void *, void *));
+void ulist_destroy(ulist_t * ulist);
+void ulist_destroy_free(ulist_t * ulist, void (* free_func)(void *));
+
+// inserting methods
+void ulist_append(ulist_t * ulist, void * data);
+void ulist_prepend(ulist_t * ulist, void * data);
+dlist_result_t ulist_insert(ulist_t * ulist, void * data, int32_t index);
+
+// manipulation methods
+void * ulist_pop_tail(ulist_t * ulist);
+void * ulist_pop_head(ulist_t * ulist);
+void * ulist_get_by_value(ulist_t * ulist, void * data);
+void * ulist_get_by_index(ulist_t * ulist, int32_t index);
+void * ulist_remove_value(ulist_t * ulist, void * data);
+
+// metadata methods
+bool ulist_is_empty(ulist_t * ulist);
+size_t ulist_get_length(ulist_t * ulist);
+bool ulist_value_in_ulist(ulist_t * ulist, void * data);
+
+// iterables
+void ulist_iter_init(ulist_t * ulist, ulist_iter_t * iter, iter_start_t pos);
+void * ulist_iter_next(ulist_iter_t * iter);
+void * ulist_iter_prev(ulist_iter_t * iter);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+#endif //DATA_STRUCTURES_C_DLIST_ADT_INCLUDE_DL_ULIST_H_
@@ -0,0 +1,359 @@
+#include <dl_ilist.h>
+#include <assert.h>
+
+static void link_between(ilist_t * list,
+                         ilist_link_t * prev,
+                         ilist_link_t * next,
+                         ilist_link_t * link);
+static bool is_out_of_order(ilist_link_t * left,
+                            ilist_link_t * right,
+                            size_t link_offset,
+                            sort_direction_t direction,
+                            dlist_compare_t (* compare_func)(void *, void *));
+
+
+
+/*!
+ * @brief Initialize an empty list. The list can live anywhere, including
+ * inside another structure, and never allocates memory.
+ * @param list
+ */
+void ilist_init(ilist_t * list)
+{
+    assert(list);
+    * list = (ilist_t) {
+        .head   = {
+            .next   = &list->head,
+            .prev   = &list->head
+        },
+        .length = 0
+    };
+}
+
+/*!
+ * @brief Mark the link as not being in a list
+ * @param link
+ */
+void ilist_link_init(ilist_link_t * link)
+{
+    assert(link);
+    * link = (ilist_link_t) {
+        .next   = NULL,
+        .prev   = NULL
+    };
+}
+
+/*!
+ * @brief Add the link at the head of the list in O(1)
+ * @param list
+ * @param link Link that is not in a list
+ */
+void ilist_push_head(ilist_t * list, ilist_link_t * link)
+{
+    assert(list);
+    link_between(list, &list->head, list->head.next, link);
+}
+
+/*!
+ * @brief Add the link at the tail of the list in O(1)
+ * @param list
+ * @param link Link that is not in a list
+ */
+void ilist_push_tail(ilist_t * list, ilist_link_t * link)
+{
+    assert(list);
+    link_between(list, list->head.prev, &list->head, link);
+}
+
+/*!
+ * @brief Add the link in front of the position in O(1)
+ * @param list
+ * @param position Link of the list
+ * @param link Link that is not in a list
+ */
+void ilist_insert_before(ilist_t * list, ilist_link_t * position, ilist_link_t * link)
+{
+    assert(list);
+    assert(position);
+    link_between(list, position->prev, position, link);
+}
+
+/*!
+ * @brief Add the link after the position in O(1)
+ * @param list
+ * @param position Link of the list
+ * @param link Link that is not in a list
+ */
+void ilist_insert_after(ilist_t * list, ilist_link_t * position, ilist_link_t * link)
+{
+    assert(list);
+    assert(position);
+    link_between(list, position, position->next, link);
+}
+
+/*!
+ * @brief Remove the head of the list
+ * @param list
+ * @return Link of the head or NULL if the list is empty
+ */
+ilist_link_t * ilist_pop_head(ilist_t * list)
+{
+    ilist_link_t * link = ilist_get_head(list);
+    if (NULL != link)
+    {
+        ilist_remove(list, link);
+    }
+    return link;
+}
+
+/*!
+ * @brief Remove the tail of the list
+ * @param list
+ * @return Link of the tail or NULL if the list is empty
+ */
+ilist_link_t * ilist_pop_tail(ilist_t * list)
+{
+    ilist_link_t * link = ilist_get_tail(list);
+    if (NULL != link)
+    {
+        ilist_remove(list, link);
+    }
+    return link;
+}
+
+/*!
+ * @brief Unlink the link from the list in O(1). No search is needed since the
+ * link knows its neighbours.
+ * @param list List the link is in
+ * @param link
+ */
+void ilist_remove(ilist_t * list, ilist_link_t * link)
+{
+    assert(list);
+    assert(link);
+    assert(ilist_is_linked(link));
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    ilist_link_init(link);
+    list->length--;
+}
+
+/*!
+ * @brief Sort the list with a stable merge sort. The links are relinked in
+ * place so no memory is allocated.
+ *
+ * The comparison function is given the structures the links are embedded in,
+ * found with the offset of the link inside of them.
+ * @param list
+ * @param link_offset Offset of the link in the structures, from offsetof
+ * @param direction ASCENDING or DESCENDING
+ * @param compare_func
+ */
+void ilist_sort(ilist_t * list,
+                size_t link_offset,
+                sort_direction_t direction,
+                dlist_compare_t (* compare_func)(void *, void *))
+{
+    assert(list);
+    assert(compare_func);
+    if (list->length < 2)
+    {
+        return;
+    }
+
+    // Break the circle so the links form a chain ending in NULL
+    ilist_link_t * first = list->head.next;
+    list->head.prev->next = NULL;
+
+    // Merge runs of width links in pairs until a single run is left
+    size_t width = 1;
+    size_t merges = 0;
+    ilist_link_t * tail = NULL;
+    do
+    {
+        ilist_link_t * left = first;
+        first = NULL;
+        tail = NULL;
+        merges = 0;
+        while (NULL != left)
+        {
+            merges++;
+            ilist_link_t * right = left;
+            size_t left_size = 0;
+            while ((left_size < width) && (NULL != right))
+            {
+                left_size++;
+                right = right->next;
+            }
+            size_t right_size = width;
+
+            while ((0 != left_size) || ((0 != right_size) && (NULL != right)))
+            {
+                ilist_link_t * link = NULL;
+                if ((0 == left_size)
+                    || ((0 != right_size) && (NULL != right)
+                        && (is_out_of_order(left, right, link_offset,
+                                            direction, compare_func))))
+                {
+                    link = right;
+                    right = right->next;
+                    right_size--;
+                }
+                else
+                {
+                    link = left;
+                    left = left->next;
+                    left_size--;
+                }
+
+                if (NULL == tail)
+                {
+                    first = link;
+                }
+                else
+                {
+                    tail->next = link;
+                }
+                tail = link;
+            }
+            left = right;
+        }
+        tail->next = NULL;
+        width = width * 2;
+    } while (merges > 1);
+
+    // Restore the prev links and close the circle through the head
+    ilist_link_t * prev = &list->head;
+    for (ilist_link_t * link = first; NULL != link; link = link->next)
+    {
+        prev->next = link;
+        link->prev = prev;
+        prev = link;
+    }
+    prev->next = &list->head;
+    list->head.prev = prev;
+}
+
+/*!
+ * @brief Return the head of the list
+ * @param list
+ * @return Link or NULL if the list is empty
+ */
+ilist_link_t * ilist_get_head(ilist_t * list)
+{
+    assert(list);
+    return (0 == list->length) ? NULL : list->head.next;
+}
+
+/*!
+ * @brief Return the tail of the list
+ * @param list
+ * @return Link or NULL if the list is empty
+ */
+ilist_link_t * ilist_get_tail(ilist_t * list)
+{
+    assert(list);
+    return (0 == list->length) ? NULL : list->head.prev;
+}
+
+/*!
+ * @brief Return the link after the link
+ * @param list
+ * @param link Link of the list
+ * @return Link or NULL if the link is the tail
+ */
+ilist_link_t * ilist_get_next(ilist_t * list, ilist_link_t * link)
+{
+    assert(list);
+    assert(link);
+    return (&list->head == link->next) ? NULL : link->next;
+}
+
+/*!
+ * @brief Return the link before the link
+ * @param list
+ * @param link Link of the list
+ * @return Link or NULL if the link is the head
+ */
+ilist_link_t * ilist_get_prev(ilist_t * list, ilist_link_t * link)
+{
+    assert(list);
+    assert(link);
+    return (&list->head == link->prev) ? NULL : link->prev;
+}
+
+/*!
+ * @brief Public function to check if the list is empty
+ * @param list
+ * @return True if empty
+ */
+bool ilist_is_empty(ilist_t * list)
+{
+    assert(list);
+    return 0 == list->length;
+}
+
+/*!
+ * @brief Return the number of links in the list
+ * @param list
+ * @return Number of links
+ */
+size_t ilist_get_length(ilist_t * list)
+{
+    assert(list);
+    return list->length;
+}
+
+/*!
+ * @brief Check if the link is in a list. Only links set up with
+ * ilist_link_init or removed from a list can be checked.
+ * @param link
+ * @return True if the link is in a list
+ */
+bool ilist_is_linked(ilist_link_t * link)
+{
+    assert(link);
+    return NULL != link->next;
+}
+
+/*!
+ * @brief Chain the link in between two neighbouring links
+ * @param list
+ * @param prev
+ * @param next
+ * @param link
+ */
+static void link_between(ilist_t * list,
+                         ilist_link_t * prev,
+                         ilist_link_t * next,
+                         ilist_link_t * link)
+{
+    assert(link);
+    link->prev = prev;
+    link->next = next;
+    prev->next = link;
+    next->prev = link;
+    list->length++;
+}
+
+/*!
+ * @brief Check if the right link has to be placed before the left link. Equal
+ * structures keep their order.
+ * @param left
+ * @param right
+ * @param link_offset
+ * @param direction
+ * @param compare_func
+ * @return True if the right link goes first
+ */
+static bool is_out_of_order(ilist_link_t * left,
+                            ilist_link_t * right,
+                            size_t link_offset,
+                            sort_direction_t direction,
+                            dlist_compare_t (* compare_func)(void *, void *))
+{
+    dlist_compare_t result = compare_func((char *)left - link_offset,
+                                          (char *)right - link_offset);
+    return (ASCENDING == direction) ? (DLIST_GT == result)
+                                    : (DLIST_LT == result);
+}
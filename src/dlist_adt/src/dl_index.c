@@ -0,0 +1,282 @@
+#include <dl_index.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef enum
+{
+    INDEX_BASE_SLOTS = 16,
+} dlist_index_default_t;
+
+// The hash of the data is kept next to the node so probing and growing do
+// not call the hash function again
+typedef struct index_slot_t
+{
+    size_t hash;
+    dnode_t * node;
+} index_slot_t;
+
+// Open addressing table with linear probing. Every node of the dlist has a
+// slot, so equal values share a probe sequence.
+typedef struct dlist_index_t
+{
+    index_slot_t * slots;
+    size_t capacity;                // Number of slots, a power of two
+    size_t count;                   // Nodes in the table
+    size_t removed;                 // Slots of removed nodes
+    size_t (* hash_func)(void *);
+} dlist_index_t;
+
+// Marks the slot of a removed node, probes continue past it
+static dnode_t removed_node;
+
+static size_t mix_hash(size_t hash);
+static valid_ptr_t resize_index(dlist_index_t * index, size_t capacity);
+static void place_node(dlist_index_t * index, size_t hash, dnode_t * node);
+
+
+
+/*!
+ * @brief Create an empty index hashing the data of the nodes with hash_func
+ * @param hash_func Function returning the same hash for data that match with
+ * the comparison function of the dlist
+ * @return Pointer to the index or NULL
+ */
+dlist_index_t * index_init(size_t (* hash_func)(void *))
+{
+    assert(hash_func);
+    dlist_index_t * index = (dlist_index_t *)malloc(sizeof(dlist_index_t));
+    if (INVALID_PTR == verify_alloc(index))
+    {
+        return NULL;
+    }
+
+    index_slot_t * slots = (index_slot_t *)calloc(INDEX_BASE_SLOTS,
+                                                  sizeof(index_slot_t));
+    if (INVALID_PTR == verify_alloc(slots))
+    {
+        free(index);
+        return NULL;
+    }
+
+    * index = (dlist_index_t) {
+        .slots          = slots,
+        .capacity       = INDEX_BASE_SLOTS,
+        .count          = 0,
+        .removed        = 0,
+        .hash_func      = hash_func
+    };
+    return index;
+}
+
+/*!
+ * @brief Free the index. The nodes are owned by the dlist and left alone.
+ * @param index
+ */
+void index_destroy(dlist_index_t * index)
+{
+    if (NULL == index)
+    {
+        return;
+    }
+    free(index->slots);
+    free(index);
+}
+
+/*!
+ * @brief Drop every node from the index and keep its slots
+ * @param index
+ */
+void index_clear(dlist_index_t * index)
+{
+    assert(index);
+    for (size_t slot = 0; slot < index->capacity; slot++)
+    {
+        index->slots[slot] = (index_slot_t) {
+            .hash   = 0,
+            .node   = NULL
+        };
+    }
+    index->count = 0;
+    index->removed = 0;
+}
+
+/*!
+ * @brief Return the hash function the index was created with
+ * @param index
+ * @return Hash function
+ */
+size_t (* index_get_hash_func(dlist_index_t * index))(void *)
+{
+    assert(index);
+    return index->hash_func;
+}
+
+/*!
+ * @brief Add the node to the index. The table is grown, or rebuilt without
+ * the slots of removed nodes, once three quarters of the slots are used.
+ * @param index
+ * @param node
+ * @return VALID_PTR or INVALID_PTR if the table could not be grown
+ */
+valid_ptr_t index_add(dlist_index_t * index, dnode_t * node)
+{
+    assert(index);
+    assert(node);
+    if ((index->count + index->removed + 1) * 4 > index->capacity * 3)
+    {
+        size_t capacity = (index->count * 2 >= index->capacity)
+                          ? index->capacity * 2
+                          : index->capacity;
+        if (INVALID_PTR == resize_index(index, capacity))
+        {
+            return INVALID_PTR;
+        }
+    }
+
+    place_node(index, mix_hash(index->hash_func(node->data)), node);
+    index->count++;
+    return VALID_PTR;
+}
+
+/*!
+ * @brief Remove the node from the index
+ * @param index
+ * @param node Node in the index, with the data it was added with
+ */
+void index_remove(dlist_index_t * index, dnode_t * node)
+{
+    assert(index);
+    assert(node);
+    size_t mask = index->capacity - 1;
+    size_t slot = mix_hash(index->hash_func(node->data)) & mask;
+    while (NULL != index->slots[slot].node)
+    {
+        if (node == index->slots[slot].node)
+        {
+            index->slots[slot].node = &removed_node;
+            index->count--;
+            index->removed++;
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+    assert(false);
+}
+
+/*!
+ * @brief Find a node whose data matches the data.
+ *
+ * The probe goes on after the first match to learn whether it is the only
+ * one. The index does not know the order of the nodes, so with several
+ * matches the caller has to scan the dlist for the first of them.
+ * @param index
+ * @param data
+ * @param compare_func Comparison function of the dlist
+ * @param is_unique Set to false if more than one node matches
+ * @return Matching node or NULL if there is none
+ */
+dnode_t * index_find(dlist_index_t * index,
+                     void * data,
+                     dlist_match_t (* compare_func)(void *, void *),
+                     bool * is_unique)
+{
+    assert(index);
+    assert(compare_func);
+    assert(is_unique);
+    * is_unique = true;
+
+    size_t hash = mix_hash(index->hash_func(data));
+    size_t mask = index->capacity - 1;
+    dnode_t * found = NULL;
+    for (size_t slot = hash & mask;
+         NULL != index->slots[slot].node;
+         slot = (slot + 1) & mask)
+    {
+        dnode_t * node = index->slots[slot].node;
+        if ((&removed_node == node)
+            || (hash != index->slots[slot].hash)
+            || (DLIST_MATCH != compare_func(node->data, data)))
+        {
+            continue;
+        }
+        if (NULL != found)
+        {
+            * is_unique = false;
+            break;
+        }
+        found = node;
+    }
+    return found;
+}
+
+/*!
+ * @brief Spread the bits of the hash so that hash functions returning
+ * sequential values do not fill neighbouring slots
+ * @param hash
+ * @return Mixed hash
+ */
+static size_t mix_hash(size_t hash)
+{
+    uint64_t mixed = (uint64_t)hash;
+    mixed ^= mixed >> 33;
+    mixed *= 0xff51afd7ed558ccdULL;
+    mixed ^= mixed >> 33;
+    return (size_t)mixed;
+}
+
+/*!
+ * @brief Move the nodes into a table with the new number of slots
+ * @param index
+ * @param capacity Power of two larger than the number of nodes
+ * @return VALID_PTR or INVALID_PTR, in which case the index is unchanged
+ */
+static valid_ptr_t resize_index(dlist_index_t * index, size_t capacity)
+{
+    index_slot_t * slots = (index_slot_t *)calloc(capacity,
+                                                  sizeof(index_slot_t));
+    if (INVALID_PTR == verify_alloc(slots))
+    {
+        return INVALID_PTR;
+    }
+
+    index_slot_t * old_slots = index->slots;
+    size_t old_capacity = index->capacity;
+    index->slots = slots;
+    index->capacity = capacity;
+    index->removed = 0;
+    for (size_t slot = 0; slot < old_capacity; slot++)
+    {
+        dnode_t * node = old_slots[slot].node;
+        if ((NULL != node) && (&removed_node != node))
+        {
+            place_node(index, old_slots[slot].hash, node);
+        }
+    }
+    free(old_slots);
+    return VALID_PTR;
+}
+
+/*!
+ * @brief Store the node in the first free slot of its probe sequence
+ * @param index
+ * @param hash Mixed hash of the data of the node
+ * @param node
+ */
+static void place_node(dlist_index_t * index, size_t hash, dnode_t * node)
+{
+    size_t mask = index->capacity - 1;
+    size_t slot = hash & mask;
+    while ((NULL != index->slots[slot].node)
+           && (&removed_node != index->slots[slot].node))
+    {
+        slot = (slot + 1) & mask;
+    }
+    if (&removed_node == index->slots[slot].node)
+    {
+        index->removed--;
+    }
+    index->slots[slot] = (index_slot_t) {
+        .hash   = hash,
+        .node   = node
+    };
+}
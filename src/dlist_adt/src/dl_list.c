@@ -3,6 +3,15 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <dl_iter.h>
+#include <dl_pool.h>
+#include <dl_index.h>
+
+// Start loading the next node while the current one is processed
+#if defined(__GNUC__)
+#define PREFETCH(ptr) __builtin_prefetch(ptr)
+#else
+#define PREFETCH(ptr) ((void)(ptr))
+#endif
 
 // Settings are used to reduce code complexity by setting a action flag
 typedef enum
@@ -14,6 +23,13 @@ typedef enum
     INSERT_AT
 } dlist_settings_t;
 
+// Enough pending runs for any list length, the merge rules keep the run
+// lengths growing at least as fast as the Fibonacci numbers
+typedef enum
+{
+    MAX_SORT_RUNS = 96
+} dlist_sort_default_t;
+
 
 // Manager structure
 typedef struct dlist_t
@@ -23,21 +39,39 @@ typedef struct dlist_t
     size_t length;          // number of nodes
     dlist_t * iter_list;    // dlist of iter_t objects
     bool is_iter_mgr;       // bool indicating if the dlist is a special internal dlist
+    uint64_t generation;    // bumped on every change that invalidates cursors
+    dlist_pool_t * pool;    // pool the nodes come from or NULL for malloc
+    bool is_pool_private;   // bool indicating if the pool was created for this dlist
+    dlist_index_t * index;  // hash index of the nodes by their data or NULL
+    dnode_t * finger;       // node of the last index lookup or NULL
+    int32_t finger_index;   // index of the finger node
     dlist_match_t (* compare_func)(void *, void *);
 } dlist_t;
 
 
+// Sorted run of nodes chained through next and ending in NULL
+typedef struct
+{
+    dnode_t * head;
+    size_t length;
+} sort_run_t;
+
 typedef struct
 {
     sort_direction_t direction;
     dlist_compare_t (* compare_func)(void *, void *);
-} quick_sort_t;
+    sort_run_t runs[MAX_SORT_RUNS];     // Pending runs waiting to be merged
+    size_t run_count;
+} merge_sort_t;
 
 
 // Sorting functions
-static bool do_swap(quick_sort_t * sort, dnode_t * left, dnode_t * right);
-static void swap_dnodes(dnode_t * left, dnode_t * right);
-static void quick_sort(quick_sort_t * sort, dnode_t * left, dnode_t * right);
+static bool is_out_of_order(merge_sort_t * sort, dnode_t * left, dnode_t * right);
+static dnode_t * take_run(merge_sort_t * sort, dnode_t * head, sort_run_t * run);
+static dnode_t * merge_runs(merge_sort_t * sort, dnode_t * left, dnode_t * right);
+static void merge_at(merge_sort_t * sort, size_t index);
+static void collapse_runs(merge_sort_t * sort);
+static void update_sorted_iters(dlist_t * dlist);
 
 // Private fetch
 static dnode_t * get_by_index(dlist_t * dlist, int32_t index);
@@ -45,18 +79,35 @@ static dlist_t * get_iters_list(dlist_iter_t * iter);
 
 // Private iter_list
 static dlist_match_t compare_iters(void * data1, void * data2);
-static dlist_iter_t * get_iter_of_iter_list(dlist_t * dlist);
 static bool is_iter_list_empty(dlist_t * dlist);
 static bool is_iter_list(dlist_iter_t * iter);
 
 // Node private functions
 static void dlist_destroy_(dlist_t * dlist, dlist_settings_t delete, void(*free_func)(void *));
-static dnode_t * init_node(void * data);
+static dnode_t * init_node(dlist_t * dlist, void * data);
+static void free_node(dlist_t * dlist, dnode_t * node);
 static void * remove_node(dlist_t * dlist, dnode_t * node);
-static dlist_result_t add_node(dlist_t * dlist,
-                               void * data,
-                               dlist_settings_t add_mode,
-                               int32_t at_index);
+static void * unlink_node(dlist_t * dlist, dnode_t * node, int32_t index);
+static void update_removed_iters(dlist_t * dlist, dnode_t * node, int32_t known_index);
+static void update_removed_finger(dlist_t * dlist, dnode_t * node, int32_t known_index);
+static dnode_t * find_node(dlist_t * dlist, void * data);
+static void index_node(dlist_t * dlist, dnode_t * node);
+static void rebuild_index(dlist_t * dlist);
+static bool is_node_source_shared(dlist_t * dlist, dlist_t * other);
+static void move_nodes(dlist_t * dlist,
+                       int32_t index,
+                       dlist_t * other,
+                       int32_t first,
+                       int32_t count);
+static void update_spliced_iters(dlist_t * dlist,
+                                 int32_t index,
+                                 dlist_t * other,
+                                 int32_t first,
+                                 int32_t count);
+static dnode_t * add_node(dlist_t * dlist,
+                          void * data,
+                          dlist_settings_t add_mode,
+                          int32_t at_index);
 
 
 
@@ -103,6 +154,80 @@ dlist_t * dlist_init(dlist_match_t (* compare_func)(void *, void *))
     return dlist;
 }
 
+/*!
+ * @brief Initialize a dlist whose nodes come from a node pool instead of
+ * being allocated one at a time.
+ *
+ * If pool is NULL the dlist creates a pool of its own. The nodes of a private
+ * pool are released all at once when the dlist is destroyed, in O(slabs)
+ * instead of O(n). A pool created with dlist_pool_init can be shared by
+ * several dlists, the pool is kept alive until the last of them is destroyed.
+ *
+ * @param compare_func
+ * @param pool Shared pool or NULL for a pool private to the dlist
+ * @return Null if INVALID_PTR is returned from init or dlist_t pointer
+ */
+dlist_t * dlist_init_pooled(dlist_match_t (* compare_func)(void *, void *),
+                            dlist_pool_t * pool)
+{
+    dlist_t * dlist = dlist_init(compare_func);
+    if (NULL == dlist)
+    {
+        return NULL;
+    }
+
+    if (NULL == pool)
+    {
+        pool = dlist_pool_init();
+        if (NULL == pool)
+        {
+            dlist_destroy(dlist);
+            return NULL;
+        }
+        dlist->is_pool_private = true;
+    }
+    else
+    {
+        pool_retain(pool);
+    }
+    dlist->pool = pool;
+    return dlist;
+}
+
+/*!
+ * @brief Keep a hash index of the nodes by their data, so that
+ * dlist_get_by_value, dlist_value_in_dlist, dlist_remove_value and
+ * dlist_find_node take O(1) expected time instead of scanning the dlist.
+ *
+ * The index is kept up to date by every insert and removal. Data matching
+ * with the comparison function must have the same hash. When several nodes
+ * match the searched value the dlist is still scanned for the first of them.
+ * If the index can not grow it is dropped and the searches scan again.
+ *
+ * @param dlist
+ * @param hash_func Hash of the data or NULL to drop the index
+ * @return DLIST_SUCC or DLIST_FAIL if the index could not be allocated
+ */
+dlist_result_t dlist_set_hash_index(dlist_t * dlist, size_t (* hash_func)(void *))
+{
+    assert(dlist);
+    index_destroy(dlist->index);
+    dlist->index = NULL;
+    if (NULL == hash_func)
+    {
+        return DLIST_SUCC;
+    }
+
+    assert(dlist->compare_func);
+    dlist->index = index_init(hash_func);
+    if (NULL == dlist->index)
+    {
+        return DLIST_FAIL;
+    }
+    rebuild_index(dlist);
+    return (NULL == dlist->index) ? DLIST_FAIL : DLIST_SUCC;
+}
+
 /*!
  * @brief Public function to check if the dlist is empty
  * @param dlist
@@ -151,6 +276,23 @@ void dlist_prepend(dlist_t * dlist, void * data)
     add_node(dlist, data, PREPEND, 0);
 }
 
+/*!
+ * @brief Insert a node at the head of the linked list and return the node as
+ * a handle that dlist_remove_node takes to remove it without searching for
+ * it. The removal is O(1) only while the dlist has no iters, see
+ * dlist_remove_node.
+ * @param dlist
+ * @param data
+ * @return Handle of the node, valid until the node is removed
+ */
+dnode_t * dlist_prepend_node(dlist_t * dlist, void * data)
+{
+    assert(dlist);
+    assert(data);
+
+    return add_node(dlist, data, PREPEND, 0);
+}
+
 /*!
  * @brief Insert a node at the tail of the linked list making the new node the
  * tail node.
@@ -166,6 +308,23 @@ void dlist_append(dlist_t * dlist, void * data)
     add_node(dlist, data, APPEND, 0);
 }
 
+/*!
+ * @brief Insert a node at the tail of the linked list and return the node as
+ * a handle that dlist_remove_node takes to remove it without searching for
+ * it. The removal is O(1) only while the dlist has no iters, see
+ * dlist_remove_node.
+ * @param dlist
+ * @param data
+ * @return Handle of the node, valid until the node is removed
+ */
+dnode_t * dlist_append_node(dlist_t * dlist, void * data)
+{
+    assert(dlist);
+    assert(data);
+
+    return add_node(dlist, data, APPEND, 0);
+}
+
 /*!
  * @brief Insert a node at the given index. The new node will maintain the index
  * given in the parameter. If the index is not within the invalid range then
@@ -183,7 +342,8 @@ dlist_result_t dlist_insert(dlist_t * dlist, void * data, int32_t index)
     assert(dlist);
     assert(data);
 
-    return add_node(dlist, data, INSERT_AT, index);
+    return (NULL == add_node(dlist, data, INSERT_AT, index)) ? DLIST_FAIL
+                                                             : DLIST_SUCC;
 }
 
 /*!
@@ -261,78 +421,259 @@ void * dlist_remove_value(dlist_t * dlist, void * data)
 {
     assert(dlist);
     assert(data);
-    iter_search_t * search = iter_search_by_value_plus(dlist, data);
-    if (NULL == search)
+
+    // A single scan finds the node, the iters are updated by remove_node
+    dnode_t * node = find_node(dlist, data);
+    if (NULL == node)
     {
         return NULL;
     }
+    return remove_node(dlist, node);
+}
 
-    /*
-     * If the current iter being compared is not the iter manager, we need to
-     * see if the node being removed is either a head or tail value. If it is
-     * we need to iterate over all the iter lists created and update their
-     * node pointers IF they are pointing to either the trial or head.
-     *
-     * If an iter node is pointing at a tail node, we need to move that node
-     * to the left so that when the node is removed, the iter node does not
-     * point to a NULL value.
-     *
-     * If the iter node is pointing at a head node, we need to move that node
-     * to the right but not increment the index.
-     */
-    if ((false == dlist->is_iter_mgr) && (false == is_iter_list_empty(dlist)))
+/*!
+ * @brief Return the handle of the first node matching the data with the
+ * comparison function. The scan does not allocate.
+ * @param dlist
+ * @param data
+ * @return Handle of the node or NULL if not found
+ */
+dnode_t * dlist_find_node(dlist_t * dlist, void * data)
+{
+    assert(dlist);
+    assert(data);
+    return find_node(dlist, data);
+}
+
+/*!
+ * @brief Remove the node of the handle without searching for it.
+ *
+ * The removal is O(1) while the dlist has no iters. The iters keep an index,
+ * so while any iter exists the index of the node is found by walking back to
+ * the head, making the removal O(n). This is always the case for the dlist of
+ * a clist_t, which keeps an iter for its lifetime. Iters pointing at the node
+ * are moved off it like for any other removal.
+ * @param dlist
+ * @param node Handle from dlist_append_node, dlist_prepend_node or
+ * dlist_find_node of this dlist. It is invalid once removed.
+ * @return Pointer to the data of the node
+ */
+void * dlist_remove_node(dlist_t * dlist, dnode_t * node)
+{
+    assert(dlist);
+    assert(node);
+    return remove_node(dlist, node);
+}
+
+/*!
+ * @brief Call the function on the data of every node from head to tail.
+ *
+ * The walk is a loop over the nodes that starts loading the next node before
+ * the function runs, with no iter to allocate or update. The function must
+ * not change the dlist.
+ * @param dlist
+ * @param func Function called with the data and the context
+ * @param context Pointer passed to every call
+ */
+void dlist_for_each(dlist_t * dlist,
+                    void (* func)(void * data, void * context),
+                    void * context)
+{
+    assert(dlist);
+    assert(func);
+
+    dnode_t * node = dlist->head;
+    while (NULL != node)
     {
-        iter_search_t
-            * tail_node = iter_search_by_value_plus(dlist, dlist->tail->data);
-        iter_search_t
-            * head_node = iter_search_by_value_plus(dlist, dlist->head->data);
+        dnode_t * next = node->next;
+        PREFETCH(next);
+        func(node->data, context);
+        node = next;
+    }
+}
 
-        // If either the head or tail are the value being removed
-        if ((tail_node->found_index == search->found_index)
-            || (head_node->found_index == search->found_index))
-        {
-            // Create an iterable object containing all the iters created by user
-            dlist_iter_t * iter_list = get_iter_of_iter_list(dlist);
-            dlist_iter_t * iter_to_update = iter_get_value(iter_list);
+/*!
+ * @brief Remove every node whose data matches the predicate in a single
+ * pass, instead of one search per removal.
+ *
+ * The predicate must not change the dlist. Iters on removed nodes are
+ * updated as for any other removal.
+ * @param dlist
+ * @param predicate Returns true for the data to remove
+ * @param context Pointer passed to every call
+ * @param free_func Function freeing the data of the removed nodes or NULL to
+ * leave the data to the caller
+ * @return Number of removed nodes
+ */
+size_t dlist_remove_if(dlist_t * dlist,
+                       bool (* predicate)(void * data, void * context),
+                       void * context,
+                       void (* free_func)(void *))
+{
+    assert(dlist);
+    assert(predicate);
 
-            // while there is data in the iter->node member, keep iterating
-            while (NULL != iter_to_update)
+    // The index of a node is the number of nodes kept before it
+    size_t removed = 0;
+    int32_t index = 0;
+    dnode_t * node = dlist->head;
+    while (NULL != node)
+    {
+        dnode_t * next = node->next;
+        PREFETCH(next);
+        if (predicate(node->data, context))
+        {
+            void * data = unlink_node(dlist, node, index);
+            if (NULL != free_func)
             {
-                // If the iter node points at the value about to be removed
-                // continue to process that node in the iter
-                if (iter_get_index(iter_to_update) == search->found_index)
-                {
-                    // if the current iters node points at the head, move it
-                    // to the right and decrement the index since it gets auto
-                    // updated with the iterate function
-                    if (head_node->found_index == search->found_index)
-                    {
-                        dlist_get_iter_next(iter_to_update);
-                        iter_update_index(iter_to_update, -1);
-                    }
-                    // same as head but for tail
-                    if (tail_node->found_index == search->found_index)
-                    {
-                        dlist_get_iter_prev(iter_to_update);
-                        iter_update_index(iter_to_update, -1);
-                    }
-                }
-                iter_to_update = dlist_get_iter_next(iter_list);
+                free_func(data);
             }
-
-            // Destroy the iterlist after done being used
-            dlist_destroy_iter(iter_list);
+            removed++;
+        }
+        else
+        {
+            index++;
         }
+        node = next;
+    }
+    return removed;
+}
+
+/*!
+ * @brief Replace the data of every node with the result of the function.
+ * The nodes keep their place so iters and cursors stay valid.
+ * @param dlist
+ * @param func Function returning the new data for the data and the context,
+ * must not return NULL
+ * @param context Pointer passed to every call
+ */
+void dlist_map(dlist_t * dlist,
+               void * (* func)(void * data, void * context),
+               void * context)
+{
+    assert(dlist);
+    assert(func);
 
-        iter_destroy_search(tail_node);
-        iter_destroy_search(head_node);
+    dnode_t * node = dlist->head;
+    while (NULL != node)
+    {
+        dnode_t * next = node->next;
+        PREFETCH(next);
+        node->data = func(node->data, context);
+        assert(node->data);
+        node = next;
     }
 
-    // Extract the data and destroy the search
-    dnode_t * node = search->found_node;
-    iter_destroy_search(search);
+    // The nodes are filed under the hash of their old data
+    if (NULL != dlist->index)
+    {
+        rebuild_index(dlist);
+    }
+}
 
-    return remove_node(dlist, node);
+/*!
+ * @brief Move every node of other to the tail of the dlist in O(1), leaving
+ * other empty. See dlist_splice for the requirements.
+ * @param dlist
+ * @param other
+ * @return DLIST_SUCC or DLIST_FAIL if the nodes can not be moved
+ */
+dlist_result_t dlist_concat(dlist_t * dlist, dlist_t * other)
+{
+    assert(dlist);
+    assert(other);
+    return dlist_splice(dlist, (int32_t)dlist->length, other, 0,
+                        (int32_t)other->length);
+}
+
+/*!
+ * @brief Move count nodes of other, starting at index first, into the dlist
+ * so that the first of them ends up at index.
+ *
+ * The nodes are relinked rather than copied, so the cost is the index
+ * lookups at the ends of the range, O(1) for the heads and tails of the
+ * dlists. The iters of both dlists keep pointing at their nodes, the iters on
+ * moved nodes belong to the dlist afterwards. Cursors of both dlists are
+ * invalidated. Hash indexes are updated node by node.
+ *
+ * The nodes must be freed the same way by both dlists, so both have to be
+ * created with dlist_init or share a pool from dlist_pool_init.
+ * @param dlist
+ * @param index Index in the dlist from 0 to its length
+ * @param other Dlist the nodes are taken from
+ * @param first Index of the first node to move
+ * @param count Number of nodes to move
+ * @return DLIST_SUCC or DLIST_FAIL if a range is invalid or the nodes can
+ * not be moved
+ */
+dlist_result_t dlist_splice(dlist_t * dlist,
+                            int32_t index,
+                            dlist_t * other,
+                            int32_t first,
+                            int32_t count)
+{
+    assert(dlist);
+    assert(other);
+    if ((dlist == other)
+        || (!is_node_source_shared(dlist, other))
+        || (index < 0) || ((size_t)index > dlist->length)
+        || (first < 0) || (count < 0)
+        || ((size_t)first + (size_t)count > other->length))
+    {
+        return DLIST_FAIL;
+    }
+
+    if (0 != count)
+    {
+        move_nodes(dlist, index, other, first, count);
+    }
+    return DLIST_SUCC;
+}
+
+/*!
+ * @brief Split the dlist in two. The nodes from the index to the tail are
+ * moved to a new dlist with the same comparison function, pool and hash
+ * function.
+ *
+ * A dlist with a private pool shares the pool with the new dlist from then
+ * on, so destroying it frees its nodes one at a time.
+ * @param dlist
+ * @param index Index of the first node of the new dlist from 0 to the length
+ * @return New dlist or NULL if the index is invalid or allocation failed
+ */
+dlist_t * dlist_split_at(dlist_t * dlist, int32_t index)
+{
+    assert(dlist);
+    if ((index < 0) || ((size_t)index > dlist->length))
+    {
+        return NULL;
+    }
+
+    dlist_t * split = dlist_init(dlist->compare_func);
+    if (NULL == split)
+    {
+        return NULL;
+    }
+    if ((NULL != dlist->index)
+        && (DLIST_SUCC != dlist_set_hash_index(
+                split, index_get_hash_func(dlist->index))))
+    {
+        dlist_destroy(split);
+        return NULL;
+    }
+    if (NULL != dlist->pool)
+    {
+        pool_retain(dlist->pool);
+        split->pool = dlist->pool;
+        dlist->is_pool_private = false;
+    }
+
+    int32_t count = (int32_t)dlist->length - index;
+    if (0 != count)
+    {
+        move_nodes(split, 0, dlist, index, count);
+    }
+    return split;
 }
 
 /*!
@@ -362,11 +703,10 @@ valid_ptr_t verify_alloc(void * ptr)
 }
 
 /*!
- * @brief Perform a quick sort on the double linked list. The quick sort
- * relies on the comparison function passed. The sort does not create any new
- * data structures, the dnode_t data pointers are updated in place. The
- * algorithm sorts in O(n log(n)) in most cases unless the list is already
- * sorted in which case the algorithm will operate in O(n^2)
+ * @brief Sort the double linked list with dlist_merge_sort.
+ *
+ * The function is kept for the callers written against the quick sort it
+ * used to run, which went quadratic and deeply recursive on sorted input.
  *
  * @param dlist
  * @param direction
@@ -376,36 +716,77 @@ void dlist_quick_sort(dlist_t * dlist,
                       sort_direction_t direction,
                       dlist_compare_t (* compare_func)(void *, void *))
 {
+    dlist_merge_sort(dlist, direction, compare_func);
+}
+
+/*!
+ * @brief Perform a stable merge sort on the double linked list using the
+ * comparison function passed in.
+ *
+ * The sort is bottom-up and never recurses. The list is cut into the runs
+ * that are already in order, with runs in strictly the opposite order
+ * reversed, and the runs are merged as they are found while keeping the
+ * pending runs balanced. Sorted or reverse sorted input is sorted in O(n)
+ * and any input in O(n log(n)). Nodes are relinked rather than having their
+ * data swapped, so no memory is allocated. Iters keep their index and point
+ * to the node sorted into it.
+ *
+ * @param dlist
+ * @param direction
+ * @param compare_func
+ */
+void dlist_merge_sort(dlist_t * dlist,
+                      sort_direction_t direction,
+                      dlist_compare_t (* compare_func)(void *, void *))
+{
+    assert(dlist);
+    assert(compare_func);
+
     // Return if the is only one/none items in the linked list
     if (2 > dlist->length)
     {
         return;
     }
 
-    // Create the struct that will make it easier to manage the settings
-    quick_sort_t * sort = (quick_sort_t *)malloc(sizeof(quick_sort_t));
-    if (INVALID_PTR == verify_alloc(sort))
+    merge_sort_t sort = {
+        .compare_func   = compare_func,
+        .direction      = direction,
+        .run_count      = 0
+    };
+
+    dnode_t * node = dlist->head;
+    while (NULL != node)
     {
-        return;
+        assert(sort.run_count < MAX_SORT_RUNS);
+        node = take_run(&sort, node, &sort.runs[sort.run_count]);
+        sort.run_count++;
+        collapse_runs(&sort);
+    }
+    while (sort.run_count > 1)
+    {
+        merge_at(&sort, sort.run_count - 2);
     }
 
-    // Initialize the sort structure with the comparison function and direction!
-    * sort = (quick_sort_t) {
-        .compare_func = compare_func,
-        .direction    = direction
-    };
-    quick_sort(sort, dlist->head, dlist->tail);
-
-    // free the sort structure
-    free(sort);
+    // Restore the prev pointers of the merged chain
+    dnode_t * prev = NULL;
+    for (node = sort.runs[0].head; NULL != node; node = node->next)
+    {
+        node->prev = prev;
+        prev = node;
+    }
+    dlist->head = sort.runs[0].head;
+    dlist->tail = prev;
+    dlist->generation++;
+    dlist->finger = NULL;
+    update_sorted_iters(dlist);
 }
 
 /*********************************************************************************************
  *
  *                                Search Section
  *
- * Section uses the iter API to find the value but abstracts the creation of the
- * iter object
+ * Section finds values by walking the nodes, or through the hash index when the
+ * dlist has one
  *
  ********************************************************************************************/
 
@@ -441,7 +822,7 @@ void * dlist_get_by_value(dlist_t * dlist, void * data)
     assert(dlist);
     assert(data);
 
-    dnode_t * found_node = iter_search_by_value(dlist, data);
+    dnode_t * found_node = find_node(dlist, data);
 
     if (NULL == found_node)
     {
@@ -611,67 +992,254 @@ void * dlist_get_iter_next(dlist_iter_t * dlist_iter)
     return NULL;
 }
 
-static dnode_t * get_by_index(dlist_t * dlist, int32_t index)
+/*********************************************************************************************
+ *
+ *                                 Cursor Section
+ *
+ * Cursors walk the dlist like iters without being allocated or registered.
+ *
+ ********************************************************************************************/
+
+/*!
+ * @brief Return a cursor on the head or the tail of the dlist. The cursor
+ * stays valid until the dlist is changed.
+ *
+ * @param dlist
+ * @param pos ITER_HEAD or ITER_TAIL
+ * @return Cursor on the node, past the end if the dlist is empty
+ */
+dlist_cursor_t dlist_get_cursor(dlist_t * dlist, iter_start_t pos)
 {
-    // Assert values
     assert(dlist);
+    dlist_cursor_t cursor = {
+        .dlist      = dlist,
+        .node       = (ITER_HEAD == pos) ? dlist->head : dlist->tail,
+        .index      = (ITER_HEAD == pos || 0 == dlist->length)
+                      ? 0 : (int32_t)dlist->length - 1,
+        .generation = dlist->generation
+    };
+    return cursor;
+}
 
-    dnode_t * found_node = iter_search_by_index(dlist, index);
+/*!
+ * @brief Check that the dlist was not changed since the cursor was created
+ *
+ * @param cursor
+ * @return True if the cursor can still be used
+ */
+bool dlist_cursor_is_valid(dlist_cursor_t * cursor)
+{
+    assert(cursor);
+    assert(cursor->dlist);
+    return cursor->generation == cursor->dlist->generation;
+}
 
-    if (NULL == found_node)
+/*!
+ * @brief Return the value of the node under the cursor
+ *
+ * @param cursor
+ * @return Data of the node or NULL if the cursor went past the end or is no
+ * longer valid
+ */
+void * dlist_cursor_get_value(dlist_cursor_t * cursor)
+{
+    if ((!dlist_cursor_is_valid(cursor)) || (NULL == cursor->node))
     {
         return NULL;
     }
-
-    return found_node;
+    return cursor->node->data;
 }
 
-
-
 /*!
- * @brief Create the structure that is stored on each item in the linked list
- * @param data
- * @return
+ * @brief Move the cursor to the next node
+ *
+ * @param cursor
+ * @return Data of the next node or NULL if the cursor went past the tail or
+ * is no longer valid
  */
-static dnode_t * init_node(void * data)
+void * dlist_cursor_next(dlist_cursor_t * cursor)
 {
-    dnode_t * node = (dnode_t *)calloc(1, sizeof(dnode_t));
-    if (INVALID_PTR == verify_alloc(node))
+    if ((!dlist_cursor_is_valid(cursor)) || (NULL == cursor->node))
     {
         return NULL;
     }
-    node->data = data;
-    return node;
+    cursor->node = cursor->node->next;
+    cursor->index++;
+    return dlist_cursor_get_value(cursor);
 }
 
 /*!
- * @brief Private function handles the removal of the identified node
- * @param dlist
- * @param node
- * @return
+ * @brief Move the cursor to the previous node
+ *
+ * @param cursor
+ * @return Data of the previous node or NULL if the cursor went past the head
+ * or is no longer valid
  */
-static void * remove_node(dlist_t * dlist, dnode_t * node)
+void * dlist_cursor_prev(dlist_cursor_t * cursor)
 {
-    // preserve the node data before removing
-    void * node_data = node->data;
-    dlist->length--;
-
-    // check if node is the head, if so, update
-    if (dlist->head == node)
+    if ((!dlist_cursor_is_valid(cursor)) || (NULL == cursor->node))
     {
-        dlist->head = node->next;
-        if (NULL != dlist->head)
-        {
-            dlist->head->prev = NULL;
-        }
+        return NULL;
     }
+    cursor->node = cursor->node->prev;
+    cursor->index--;
+    return dlist_cursor_get_value(cursor);
+}
 
-    // Check if node is the tail, if so, update
-    if (dlist->tail == node)
-    {
-        dlist->tail = node->prev;
-        if (NULL != dlist->tail)
-        {
+/*!
+ * @brief Return the index of the node under the cursor
+ *
+ * @param cursor
+ * @return Index of the node
+ */
+int32_t dlist_cursor_get_index(dlist_cursor_t * cursor)
+{
+    assert(cursor);
+    return cursor->index;
+}
+
+/*!
+ * @brief Return the node at the index. Negative indexes count from the tail.
+ *
+ * The walk starts from whichever of the head, the tail and the finger is
+ * closest to the index, and the node found becomes the new finger. Walking
+ * the indexes in order, or inserting at increasing indexes, moves a single
+ * node each time.
+ * @param dlist
+ * @param index
+ * @return Node or NULL if the index is out of range
+ */
+static dnode_t * get_by_index(dlist_t * dlist, int32_t index)
+{
+    // Assert values
+    assert(dlist);
+
+    int32_t length = (int32_t)dlist->length;
+    if (index < 0)
+    {
+        index = index + length;
+    }
+    if ((index < 0) || (index >= length))
+    {
+        return NULL;
+    }
+
+    dnode_t * node = dlist->head;
+    int32_t node_index = 0;
+    if (length - 1 - index < index)
+    {
+        node = dlist->tail;
+        node_index = length - 1;
+    }
+    if ((NULL != dlist->finger)
+        && (abs(index - dlist->finger_index) < abs(index - node_index)))
+    {
+        node = dlist->finger;
+        node_index = dlist->finger_index;
+    }
+
+    while (node_index < index)
+    {
+        node = node->next;
+        node_index++;
+    }
+    while (node_index > index)
+    {
+        node = node->prev;
+        node_index--;
+    }
+
+    dlist->finger = node;
+    dlist->finger_index = index;
+    return node;
+}
+
+
+
+/*!
+ * @brief Create the structure that is stored on each item in the linked list.
+ * The node comes from the pool of the dlist if it has one
+ * @param dlist
+ * @param data
+ * @return
+ */
+static dnode_t * init_node(dlist_t * dlist, void * data)
+{
+    dnode_t * node = (NULL != dlist->pool)
+                     ? pool_acquire_node(dlist->pool)
+                     : (dnode_t *)calloc(1, sizeof(dnode_t));
+    if (INVALID_PTR == verify_alloc(node))
+    {
+        return NULL;
+    }
+    node->data = data;
+    return node;
+}
+
+/*!
+ * @brief Give the node back to the pool it came from or free it
+ * @param dlist
+ * @param node
+ */
+static void free_node(dlist_t * dlist, dnode_t * node)
+{
+    if (NULL != dlist->pool)
+    {
+        pool_release_node(dlist->pool, node);
+    }
+    else
+    {
+        free(node);
+    }
+}
+
+/*!
+ * @brief Private function handles the removal of the identified node
+ * @param dlist
+ * @param node
+ * @return
+ */
+static void * remove_node(dlist_t * dlist, dnode_t * node)
+{
+    return unlink_node(dlist, node, -1);
+}
+
+/*!
+ * @brief Unlink the node from the dlist and free it
+ * @param dlist
+ * @param node
+ * @param index Index of the node if the caller knows it or -1
+ * @return Data of the node
+ */
+static void * unlink_node(dlist_t * dlist, dnode_t * node, int32_t index)
+{
+    // preserve the node data before removing
+    void * node_data = node->data;
+    update_removed_iters(dlist, node, index);
+    update_removed_finger(dlist, node, index);
+    if (NULL != dlist->index)
+    {
+        index_remove(dlist->index, node);
+    }
+    dlist->length--;
+    dlist->generation++;
+
+    // check if node is the head, if so, update
+    if (dlist->head == node)
+    {
+        dlist->head = node->next;
+        if (NULL != dlist->head)
+        {
+            dlist->head->prev = NULL;
+        }
+    }
+
+    // Check if node is the tail, if so, update
+    if (dlist->tail == node)
+    {
+        dlist->tail = node->prev;
+        if (NULL != dlist->tail)
+        {
             dlist->tail->next = NULL;
         }
     }
@@ -687,10 +1255,340 @@ static void * remove_node(dlist_t * dlist, dnode_t * node)
     }
 
     // free the node and return the actual data
-    free(node);
+    free_node(dlist, node);
     return node_data;
 }
 
+/*!
+ * @brief Update the iters for a node about to be removed.
+ *
+ * The iters pointing at the node move on to the next node and keep their
+ * index. If the node is the tail they move back to the previous node
+ * instead, and if it is the only node they are left at the end of the dlist.
+ * The iters past the node move down an index. Finding the index of the node
+ * walks back to the head when the caller does not know it, which is only
+ * done while the dlist has iters and makes dlist_remove_node O(n) for them.
+ * @param dlist
+ * @param node Node about to be removed
+ * @param known_index Index of the node or -1 if unknown
+ */
+static void update_removed_iters(dlist_t * dlist, dnode_t * node, int32_t known_index)
+{
+    if ((NULL == dlist->iter_list) || (is_iter_list_empty(dlist)))
+    {
+        return;
+    }
+
+    int32_t removed_index = known_index;
+    if (removed_index < 0)
+    {
+        removed_index = 0;
+        for (dnode_t * prev = node->prev; NULL != prev; prev = prev->prev)
+        {
+            removed_index++;
+        }
+    }
+
+    for (dnode_t * iter_node = dlist->iter_list->head;
+         NULL != iter_node;
+         iter_node = iter_node->next)
+    {
+        dlist_iter_t * iter = (dlist_iter_t *)iter_node->data;
+        int32_t index = iter_get_index(iter);
+        if (node != iter_get_node(iter))
+        {
+            if (index > removed_index)
+            {
+                iter_update_index(iter, -1);
+            }
+        }
+        else if (NULL != node->next)
+        {
+            iter_set_node(iter, node->next, index);
+        }
+        else if (NULL != node->prev)
+        {
+            iter_set_node(iter, node->prev, index - 1);
+        }
+        else
+        {
+            iterate(iter, NEXT);
+            iter_update_index(iter, -1);
+        }
+    }
+}
+
+/*!
+ * @brief Keep the finger on the same node for a node about to be removed.
+ *
+ * A finger on the node moves to the next node, or to the previous one for
+ * the tail. The finger moves down an index for a node in front of it. If the
+ * index of the node is not known the finger is only kept for the head and
+ * the tail.
+ * @param dlist
+ * @param node Node about to be removed
+ * @param known_index Index of the node or -1 if unknown
+ */
+static void update_removed_finger(dlist_t * dlist, dnode_t * node, int32_t known_index)
+{
+    if (NULL == dlist->finger)
+    {
+        return;
+    }
+
+    if (node == dlist->finger)
+    {
+        if (NULL != node->next)
+        {
+            dlist->finger = node->next;
+        }
+        else
+        {
+            dlist->finger = node->prev;
+            dlist->finger_index--;
+        }
+        return;
+    }
+
+    if (known_index < 0)
+    {
+        if (NULL == node->next)
+        {
+            return;
+        }
+        if (NULL != node->prev)
+        {
+            dlist->finger = NULL;
+            return;
+        }
+        known_index = 0;
+    }
+    if (known_index < dlist->finger_index)
+    {
+        dlist->finger_index--;
+    }
+}
+
+/*!
+ * @brief Return the first node matching the data with the comparison
+ * function
+ * @param dlist
+ * @param data
+ * @return Node or NULL if not found
+ */
+static dnode_t * find_node(dlist_t * dlist, void * data)
+{
+    assert(dlist->compare_func);
+    if (NULL != dlist->index)
+    {
+        bool is_unique = true;
+        dnode_t * node = index_find(dlist->index, data, dlist->compare_func,
+                                    &is_unique);
+        if (is_unique)
+        {
+            return node;
+        }
+    }
+
+    for (dnode_t * node = dlist->head; NULL != node; node = node->next)
+    {
+        if (DLIST_MATCH == dlist->compare_func(node->data, data))
+        {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * @brief Add the node to the hash index of the dlist. An index that can not
+ * grow is dropped, the searches fall back to scanning the dlist.
+ * @param dlist
+ * @param node
+ */
+static void index_node(dlist_t * dlist, dnode_t * node)
+{
+    if ((NULL != dlist->index)
+        && (INVALID_PTR == index_add(dlist->index, node)))
+    {
+        index_destroy(dlist->index);
+        dlist->index = NULL;
+    }
+}
+
+/*!
+ * @brief Refill the hash index with every node of the dlist
+ * @param dlist
+ */
+static void rebuild_index(dlist_t * dlist)
+{
+    index_clear(dlist->index);
+    for (dnode_t * node = dlist->head;
+         (NULL != node) && (NULL != dlist->index);
+         node = node->next)
+    {
+        index_node(dlist, node);
+    }
+}
+
+/*!
+ * @brief Check if the nodes of one dlist can be freed by the other
+ * @param dlist
+ * @param other
+ * @return True if both use malloc or the same shared pool
+ */
+static bool is_node_source_shared(dlist_t * dlist, dlist_t * other)
+{
+    return (dlist->pool == other->pool)
+           && (!dlist->is_pool_private)
+           && (!other->is_pool_private);
+}
+
+/*!
+ * @brief Relink a range of nodes of other into the dlist. The ranges are
+ * checked by the caller.
+ * @param dlist
+ * @param index Index in the dlist of the first moved node
+ * @param other
+ * @param first Index of the first node to move
+ * @param count Number of nodes to move, at least one
+ */
+static void move_nodes(dlist_t * dlist,
+                       int32_t index,
+                       dlist_t * other,
+                       int32_t first,
+                       int32_t count)
+{
+    dnode_t * first_node = get_by_index(other, first);
+    dnode_t * last_node = get_by_index(other, first + count - 1);
+    dnode_t * position = ((size_t)index == dlist->length)
+                         ? NULL
+                         : get_by_index(dlist, index);
+
+    // Cut the range out of other
+    if (NULL == first_node->prev)
+    {
+        other->head = last_node->next;
+    }
+    else
+    {
+        first_node->prev->next = last_node->next;
+    }
+    if (NULL == last_node->next)
+    {
+        other->tail = first_node->prev;
+    }
+    else
+    {
+        last_node->next->prev = first_node->prev;
+    }
+
+    // Link it in front of the position, or at the tail without one
+    dnode_t * parent_node = (NULL == position) ? dlist->tail : position->prev;
+    first_node->prev = parent_node;
+    last_node->next = position;
+    if (NULL == parent_node)
+    {
+        dlist->head = first_node;
+    }
+    else
+    {
+        parent_node->next = first_node;
+    }
+    if (NULL == position)
+    {
+        dlist->tail = last_node;
+    }
+    else
+    {
+        position->prev = last_node;
+    }
+
+    if ((NULL != other->index) || (NULL != dlist->index))
+    {
+        for (dnode_t * node = first_node; position != node; node = node->next)
+        {
+            if (NULL != other->index)
+            {
+                index_remove(other->index, node);
+            }
+            index_node(dlist, node);
+        }
+    }
+
+    update_spliced_iters(dlist, index, other, first, count);
+    dlist->length += (size_t)count;
+    other->length -= (size_t)count;
+    dlist->generation++;
+    other->generation++;
+    if ((NULL != dlist->finger) && (dlist->finger_index >= index))
+    {
+        dlist->finger_index += count;
+    }
+    other->finger = NULL;
+}
+
+/*!
+ * @brief Update the iters of both dlists once a range of nodes was moved.
+ *
+ * The iters of the dlist past the index move up by count, or are set to the
+ * head if the dlist was empty. The iters of other on the moved nodes are
+ * handed over to the dlist and the ones past the range move down by count.
+ * The lengths are not updated yet.
+ * @param dlist
+ * @param index Index in the dlist of the first moved node
+ * @param other
+ * @param first Index in other of the first moved node
+ * @param count Number of moved nodes
+ */
+static void update_spliced_iters(dlist_t * dlist,
+                                 int32_t index,
+                                 dlist_t * other,
+                                 int32_t first,
+                                 int32_t count)
+{
+    for (dnode_t * iter_node = dlist->iter_list->head;
+         NULL != iter_node;
+         iter_node = iter_node->next)
+    {
+        dlist_iter_t * iter = (dlist_iter_t *)iter_node->data;
+        if (0 == dlist->length)
+        {
+            dlist_set_iter_head(iter);
+        }
+        else if ((NULL != iter_get_node(iter))
+                 && (iter_get_index(iter) >= index))
+        {
+            iter_update_index(iter, count);
+        }
+    }
+
+    dnode_t * iter_node = other->iter_list->head;
+    while (NULL != iter_node)
+    {
+        dnode_t * next = iter_node->next;
+        dlist_iter_t * iter = (dlist_iter_t *)iter_node->data;
+        int32_t iter_index = iter_get_index(iter);
+        if ((NULL == iter_get_node(iter)) || (iter_index < first))
+        {
+            iter_node = next;
+            continue;
+        }
+
+        if (iter_index >= first + count)
+        {
+            iter_update_index(iter, -count);
+        }
+        else
+        {
+            remove_node(other->iter_list, iter_node);
+            add_node(dlist->iter_list, iter, APPEND, 0);
+            iter_set_dlist(iter, dlist, index + iter_index - first);
+        }
+        iter_node = next;
+    }
+}
+
 /*!
  * @brief Private function that handles the appending or prepending of nodes
  * to the linked list.
@@ -698,17 +1596,19 @@ static void * remove_node(dlist_t * dlist, dnode_t * node)
  * @param dlist
  * @param data
  * @param add_mode
+ * @param at_index
+ * @return The new node or NULL if the index is out of range
  */
-static dlist_result_t add_node(dlist_t * dlist,
-                               void * data,
-                               dlist_settings_t add_mode,
-                               int32_t at_index)
+static dnode_t * add_node(dlist_t * dlist,
+                          void * data,
+                          dlist_settings_t add_mode,
+                          int32_t at_index)
 {
     // make sure that the pointers are valid
     assert(dlist);
     assert(data);
 
-    dnode_t * node = init_node(data);
+    dnode_t * node = init_node(dlist, data);
     if (NULL == node)
     {
         // if we get here, then something terrible has happened to memory
@@ -729,18 +1629,11 @@ static dlist_result_t add_node(dlist_t * dlist,
         // dlist_iter_t are updated to have their nodes point to the new node
         if (NULL != dlist->iter_list)
         {
-            if (!is_iter_list_empty(dlist))
+            for (dnode_t * iter_node = dlist->iter_list->head;
+                 NULL != iter_node;
+                 iter_node = iter_node->next)
             {
-                dlist_iter_t * iter_list = get_iter_of_iter_list(dlist);
-                dlist_iter_t * iter = iter_get_value(iter_list);
-
-                // iterate over each dlist_iter_t and set the node to head
-                while (NULL != iter)
-                {
-                    dlist_set_iter_head(iter);
-                    iter = dlist_get_iter_next(iter_list);
-                }
-                iter_destroy_iterable(iter_list);
+                dlist_set_iter_head((dlist_iter_t *)iter_node->data);
             }
         }
     }
@@ -750,20 +1643,36 @@ static dlist_result_t add_node(dlist_t * dlist,
         node->next = dlist->head;
         node->next->prev = node;
         dlist->head = node;
+        if (NULL != dlist->finger)
+        {
+            dlist->finger_index++;
+        }
     }
     else if (INSERT_AT == add_mode)
     {
         dnode_t * child_node = get_by_index(dlist, at_index);
         if (NULL == child_node)
         {
-            return DLIST_FAIL;
+            free_node(dlist, node);
+            return NULL;
         }
 
         dnode_t * parent_node = child_node->prev;
         child_node->prev = node;
         node->prev = parent_node;
         node->next = child_node;
-        parent_node->next = node;
+        if (NULL == parent_node)
+        {
+            dlist->head = node;
+        }
+        else
+        {
+            parent_node->next = node;
+        }
+
+        // The lookup left the finger on the child, the new node takes its
+        // index so the next insert at the following index is one step away
+        dlist->finger = node;
     }
     else
     {
@@ -772,7 +1681,9 @@ static dlist_result_t add_node(dlist_t * dlist,
         dlist->tail = node;
     }
     dlist->length++;
-    return DLIST_SUCC;
+    dlist->generation++;
+    index_node(dlist, node);
+    return node;
 }
 
 
@@ -781,96 +1692,197 @@ static dlist_result_t add_node(dlist_t * dlist,
  * Sort functions
  */
 /*!
- * @brief Perform a comparison between the two nodes using the function
- * pointer passed in by the caller. Using the result, and the sort direction,
- * return a bool indicating if the values should be swapped by the sort
- * function.
- *
- * When DESCENDING we only want to return true when the comparison is LT
- * (left is LT right) or EQ.
- *
- * When ASCENDING we only want to return true when the comparison is GT (left
- * is GT right) or EQ.
+ * @brief Check if the right node has to be placed before the left node for
+ * the sort direction. Equal nodes are in order, which keeps the sort stable.
  *
  * @param sort
  * @param left
  * @param right
- * @return Bool indicating if the values should be swapped based on the
- * comparison pointer passed in
+ * @return True if right goes before left
  */
-static bool do_swap(quick_sort_t * sort, dnode_t * left, dnode_t * right)
+static bool is_out_of_order(merge_sort_t * sort, dnode_t * left, dnode_t * right)
 {
     // perform a comparison using the function passed in
     dlist_compare_t compare = sort->compare_func(left->data, right->data);
-
-    // When descending, we only want to swap when the compare is LT
     if (DESCENDING == sort->direction)
     {
-        return (DLIST_LT == compare) ? false : true;
+        return DLIST_LT == compare;
+    }
+    return DLIST_GT == compare;
+}
+
+/*!
+ * @brief Cut the run that is already in order off the front of the chain. A
+ * run in strictly the opposite order is reversed, being strict it holds no
+ * equal nodes whose order would be swapped.
+ *
+ * @param sort
+ * @param head First node of the run
+ * @param run Set to the run
+ * @return First node after the run or NULL
+ */
+static dnode_t * take_run(merge_sort_t * sort, dnode_t * head, sort_run_t * run)
+{
+    dnode_t * next = head->next;
+    size_t length = 1;
+    if ((NULL != next) && (is_out_of_order(sort, head, next)))
+    {
+        // The first pair is already known to be out of order
+        dnode_t * prev = head;
+        head->next = NULL;
+        do
+        {
+            dnode_t * after = next->next;
+            next->next = prev;
+            prev = next;
+            next = after;
+            length++;
+        } while ((NULL != next) && (is_out_of_order(sort, prev, next)));
+        head = prev;
     }
     else
     {
-        return (DLIST_GT == compare) ? false : true;
+        // The first pair is already known to be in order
+        dnode_t * tail = head;
+        while (NULL != next)
+        {
+            tail = next;
+            next = next->next;
+            length++;
+            if ((NULL != next) && (is_out_of_order(sort, tail, next)))
+            {
+                break;
+            }
+        }
+        tail->next = NULL;
     }
+
+    * run = (sort_run_t) {
+        .head   = head,
+        .length = length
+    };
+    return next;
 }
+
 /*!
- * @brief Perform the partition algorithm by iterating from the left node up
- * to the pivot (right) and swap data pointers based on the sort->direction.
+ * @brief Merge two sorted chains. On equal nodes the left chain goes first.
  *
  * @param sort
- * @param left
+ * @param left Chain of the run that came first in the list
  * @param right
- * @return Return the partition pointer which is guaranteed to be sorted.
+ * @return Head of the merged chain
  */
-static dnode_t * partition(quick_sort_t * sort, dnode_t * left, dnode_t * right)
+static dnode_t * merge_runs(merge_sort_t * sort, dnode_t * left, dnode_t * right)
 {
-    dnode_t * pivot = right;
-    dnode_t * partition_node = left->prev;
-
-    // Index is the value that is iterating over the list upto the pivot
-    for (dnode_t * index = left; index != pivot; index = index->next)
+    dnode_t merged = {
+        .data   = NULL,
+        .next   = NULL,
+        .prev   = NULL
+    };
+    dnode_t * tail = &merged;
+    while ((NULL != left) && (NULL != right))
     {
-        // check if the values should be swapped based on ascending order
-        if (do_swap(sort, index, pivot))
+        if (is_out_of_order(sort, left, right))
+        {
+            tail->next = right;
+            right = right->next;
+        }
+        else
         {
-            // If a swap is to be called, increment the partition_node by one
-            partition_node = (NULL == partition_node) ? left : partition_node->next;
-            swap_dnodes(partition_node, index);
+            tail->next = left;
+            left = left->next;
         }
+        tail = tail->next;
     }
-    // Finally perform a final swap after the completed iteration
-    partition_node = (NULL == partition_node) ? left : partition_node->next;
-    swap_dnodes(partition_node, right);
-    return partition_node;
+    tail->next = (NULL != left) ? left : right;
+    return merged.next;
 }
 
 /*!
- * @brief Swap two dnode_t data pointers
- * @param left
- * @param right
+ * @brief Merge the pending run at the index with the one after it
+ *
+ * @param sort
+ * @param index
  */
-static void swap_dnodes(dnode_t * left, dnode_t * right)
+static void merge_at(merge_sort_t * sort, size_t index)
 {
-    void * left_data = left->data;
-    left->data = right->data;
-    right->data = left_data;
-}
+    sort_run_t * left = &sort->runs[index];
+    sort_run_t * right = &sort->runs[index + 1];
+    left->head = merge_runs(sort, left->head, right->head);
+    left->length = left->length + right->length;
 
+    // Move the run after the merged pair down
+    if (index + 2 < sort->run_count)
+    {
+        sort->runs[index + 1] = sort->runs[index + 2];
+    }
+    sort->run_count--;
+}
 
 /*!
- * @brief Recursive algorithm to sort the linked list.
+ * @brief Merge the pending runs until each run is longer than the next one
+ * and longer than the next two together. Merging runs of similar lengths
+ * keeps the sort O(n log(n)) and the pending runs few.
+ *
  * @param sort
- * @param left
- * @param right
  */
-static void quick_sort(quick_sort_t * sort, dnode_t * left, dnode_t * right)
+static void collapse_runs(merge_sort_t * sort)
 {
-    if (right != NULL && left != right && left != right->next)
+    sort_run_t * runs = sort->runs;
+    while (sort->run_count > 1)
     {
-        dnode_t * partition_node = partition(sort, left, right);
+        size_t index = sort->run_count - 2;
+        if (((index > 0)
+             && (runs[index - 1].length <= runs[index].length + runs[index + 1].length))
+            || ((index > 1)
+                && (runs[index - 2].length <= runs[index - 1].length + runs[index].length)))
+        {
+            if (runs[index - 1].length < runs[index + 1].length)
+            {
+                index--;
+            }
+        }
+        else if (runs[index].length > runs[index + 1].length)
+        {
+            break;
+        }
+        merge_at(sort, index);
+    }
+}
 
-        quick_sort(sort, left, partition_node->prev);
-        quick_sort(sort, partition_node->next, right);
+/*!
+ * @brief Point every iter of the dlist back to the node at its index after
+ * the nodes were relinked by a sort
+ *
+ * @param dlist
+ */
+static void update_sorted_iters(dlist_t * dlist)
+{
+    if (NULL == dlist->iter_list)
+    {
+        return;
+    }
+
+    for (dnode_t * iter_node = dlist->iter_list->head;
+         NULL != iter_node;
+         iter_node = iter_node->next)
+    {
+        dlist_iter_t * iter = (dlist_iter_t *)iter_node->data;
+        if (NULL == iter_get_node(iter))
+        {
+            continue;
+        }
+
+        int32_t index = iter_get_index(iter);
+        dnode_t * node = dlist->head;
+        for (int32_t i = 0; (i < index) && (NULL != node); i++)
+        {
+            node = node->next;
+        }
+        if (NULL != node)
+        {
+            iter_set_node(iter, node, index);
+        }
     }
 }
 
@@ -883,7 +1895,14 @@ static void quick_sort(quick_sort_t * sort, dnode_t * left, dnode_t * right)
  */
 static void dlist_destroy_(dlist_t * dlist, dlist_settings_t delete, void (*free_func)(void *))
 {
+    // The nodes of a private pool are released with the pool, so they only
+    // have to be visited to free their data
     dnode_t * node = dlist->head;
+    if ((dlist->is_pool_private) && (NO_FREE_NODES == delete))
+    {
+        node = NULL;
+    }
+
     dnode_t * next_node;
     while (NULL != node)
     {
@@ -892,10 +1911,19 @@ static void dlist_destroy_(dlist_t * dlist, dlist_settings_t delete, void (*free
         {
             free_func(node->data);
         }
-        free(node);
+        if (!(dlist->is_pool_private))
+        {
+            free_node(dlist, node);
+        }
         node = next_node;
     }
 
+    if (NULL != dlist->pool)
+    {
+        pool_release(dlist->pool);
+    }
+    index_destroy(dlist->index);
+
     if (false == dlist->is_iter_mgr)
     {
         dlist_destroy(dlist->iter_list);
@@ -936,16 +1964,6 @@ static dlist_t * get_iters_list(dlist_iter_t * iter)
     return iters_dlist;
 }
 
-/*!
- * @brief Function is only used for readability
- * @param dlist
- * @return
- */
-static dlist_iter_t * get_iter_of_iter_list(dlist_t * dlist)
-{
-    return dlist_get_iterable(dlist->iter_list, ITER_HEAD);
-}
-
 static bool is_iter_list_empty(dlist_t * dlist)
 {
     if (0 == dlist_get_length(dlist->iter_list))
@@ -0,0 +1,167 @@
+#include <dl_pool.h>
+#include <stdlib.h>
+#include <assert.h>
+
+typedef enum
+{
+    POOL_BASE_NODES = 16,
+    POOL_MAX_NODES = 1024,
+} dlist_pool_default_t;
+
+// Slabs are the blocks of nodes allocated by the pool
+typedef struct dlist_slab_t
+{
+    struct dlist_slab_t * next;
+    dnode_t nodes[];
+} dlist_slab_t;
+
+typedef struct dlist_pool_t
+{
+    dlist_slab_t * slabs;           // Every slab allocated by the pool
+    dnode_t * free_nodes;           // Nodes ready to be handed out
+    size_t slab_nodes;              // Number of nodes in the next slab
+    size_t ref_count;               // The creator and every list using it
+} dlist_pool_t;
+
+static valid_ptr_t grow_pool(dlist_pool_t * pool);
+
+
+
+/*!
+ * @brief Create a pool of nodes that can be shared by several dlists.
+ *
+ * The pool allocates the nodes in slabs and keeps the nodes given back to it
+ * on a free list, so once the lists reached their working size appending and
+ * popping never call malloc or free. The pool is not thread safe, every list
+ * sharing a pool must be used from the same thread.
+ *
+ * @return Pointer to the pool or NULL
+ */
+dlist_pool_t * dlist_pool_init(void)
+{
+    dlist_pool_t * pool = (dlist_pool_t *)malloc(sizeof(dlist_pool_t));
+    if (INVALID_PTR == verify_alloc(pool))
+    {
+        return NULL;
+    }
+
+    * pool = (dlist_pool_t) {
+        .slabs          = NULL,
+        .free_nodes     = NULL,
+        .slab_nodes     = POOL_BASE_NODES,
+        .ref_count      = 1
+    };
+    return pool;
+}
+
+/*!
+ * @brief Give up the reference of the creator to the pool. The memory of the
+ * pool is released once every list using it was destroyed as well.
+ * @param pool
+ */
+void dlist_pool_destroy(dlist_pool_t * pool)
+{
+    assert(pool);
+    pool_release(pool);
+}
+
+/*!
+ * @brief Take a node from the pool. A new slab is allocated if the pool ran
+ * out of free nodes.
+ * @param pool
+ * @return Zeroed node or NULL if the allocation failed
+ */
+dnode_t * pool_acquire_node(dlist_pool_t * pool)
+{
+    assert(pool);
+    if ((NULL == pool->free_nodes) && (INVALID_PTR == grow_pool(pool)))
+    {
+        return NULL;
+    }
+
+    dnode_t * node = pool->free_nodes;
+    pool->free_nodes = node->next;
+    * node = (dnode_t) {
+        .data   = NULL,
+        .next   = NULL,
+        .prev   = NULL
+    };
+    return node;
+}
+
+/*!
+ * @brief Give the node back to the pool
+ * @param pool
+ * @param node
+ */
+void pool_release_node(dlist_pool_t * pool, dnode_t * node)
+{
+    assert(pool);
+    assert(node);
+    node->next = pool->free_nodes;
+    pool->free_nodes = node;
+}
+
+/*!
+ * @brief Add a reference to the pool for a list that uses it
+ * @param pool
+ */
+void pool_retain(dlist_pool_t * pool)
+{
+    assert(pool);
+    pool->ref_count++;
+}
+
+/*!
+ * @brief Drop a reference to the pool. The last reference frees every slab,
+ * which releases all the nodes in O(slabs).
+ * @param pool
+ */
+void pool_release(dlist_pool_t * pool)
+{
+    assert(pool);
+    pool->ref_count--;
+    if (0 != pool->ref_count)
+    {
+        return;
+    }
+
+    dlist_slab_t * slab = pool->slabs;
+    while (NULL != slab)
+    {
+        dlist_slab_t * next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    free(pool);
+}
+
+/*!
+ * @brief Allocate a new slab and chain its nodes into the free nodes. Each
+ * slab is twice the size of the previous one up to POOL_MAX_NODES.
+ * @param pool
+ * @return VALID_PTR or INVALID_PTR if the allocation failed
+ */
+static valid_ptr_t grow_pool(dlist_pool_t * pool)
+{
+    dlist_slab_t * slab = (dlist_slab_t *)malloc(
+        sizeof(dlist_slab_t) + (pool->slab_nodes * sizeof(dnode_t)));
+    if (INVALID_PTR == verify_alloc(slab))
+    {
+        return INVALID_PTR;
+    }
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+
+    // Chain the nodes in reverse so they are handed out in address order
+    for (size_t i = pool->slab_nodes; i > 0; i--)
+    {
+        pool_release_node(pool, &slab->nodes[i - 1]);
+    }
+
+    if (pool->slab_nodes < POOL_MAX_NODES)
+    {
+        pool->slab_nodes = pool->slab_nodes * 2;
+    }
+    return VALID_PTR;
+}
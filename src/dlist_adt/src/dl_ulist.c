@@ -0,0 +1,697 @@
+#include <dl_ulist.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+typedef enum
+{
+    CHUNK_ITEMS = 32,               // Data pointers held by each chunk
+    MERGE_ITEMS = CHUNK_ITEMS / 2,  // Neighbours this small are merged
+} ulist_default_t;
+
+// The items of a chunk are the slots from start to start + count. Keeping a
+// gap at both ends lets the head and the tail grow without moving items.
+typedef struct ulist_chunk_t
+{
+    struct ulist_chunk_t * next;
+    struct ulist_chunk_t * prev;
+    size_t start;
+    size_t count;
+    void * items[CHUNK_ITEMS];
+} ulist_chunk_t;
+
+typedef struct ulist_t
+{
+    ulist_chunk_t * head;
+    ulist_chunk_t * tail;
+    ulist_chunk_t * spare;  // Last emptied chunk, kept for the next one needed
+    size_t length;
+    dlist_match_t (* compare_func)(void *, void *);
+} ulist_t;
+
+static ulist_chunk_t * add_chunk(ulist_t * ulist,
+                                 ulist_chunk_t * prev,
+                                 size_t start);
+static void remove_chunk(ulist_t * ulist, ulist_chunk_t * chunk);
+static void merge_chunks(ulist_t * ulist,
+                         ulist_chunk_t * left,
+                         ulist_chunk_t * right);
+static void insert_item(ulist_t * ulist,
+                        ulist_chunk_t * chunk,
+                        size_t offset,
+                        void * data);
+static void * remove_item(ulist_t * ulist, ulist_chunk_t * chunk, size_t offset);
+static void ulist_destroy_(ulist_t * ulist, void (* free_func)(void *));
+
+static bool get_position(ulist_t * ulist, int32_t index, size_t * position);
+static ulist_chunk_t * get_chunk(ulist_t * ulist, size_t position, size_t * offset);
+static ulist_chunk_t * find_item(ulist_t * ulist, void * data, size_t * offset);
+
+
+
+/*!
+ * @brief Initialize the unrolled list with a function to perform the
+ * comparisons. The function is used by the search functions and must use
+ * the dlist_match_t return types.
+ *
+ * Each chunk holds CHUNK_ITEMS data pointers next to each other, so walking
+ * the list touches one chunk per CHUNK_ITEMS items instead of one node per
+ * item. Head and tail operations stay O(1), index lookups walk the chunks
+ * from the nearer end.
+ * @param compare_func
+ * @return NULL if the allocation failed or the ulist_t pointer
+ */
+ulist_t * ulist_init(dlist_match_t (* compare_func)(void *, void *))
+{
+    ulist_t * ulist = (ulist_t *)calloc(1, sizeof(ulist_t));
+    if (INVALID_PTR == verify_alloc(ulist))
+    {
+        return NULL;
+    }
+
+    * ulist = (ulist_t) {
+        .head           = NULL,
+        .tail           = NULL,
+        .spare          = NULL,
+        .length         = 0,
+        .compare_func   = compare_func
+    };
+    return ulist;
+}
+
+/*!
+ * @brief Free the unrolled list without freeing the satellite data
+ * @param ulist
+ */
+void ulist_destroy(ulist_t * ulist)
+{
+    assert(ulist);
+    ulist_destroy_(ulist, NULL);
+}
+
+/*!
+ * @brief Free the unrolled list while also freeing the data with the
+ * function passed in
+ * @param ulist
+ * @param free_func
+ */
+void ulist_destroy_free(ulist_t * ulist, void (* free_func)(void *))
+{
+    assert(ulist);
+    if (NULL == free_func)
+    {
+        fprintf(stderr, "[!] Invalid free function pointer passed\n");
+        return;
+    }
+    ulist_destroy_(ulist, free_func);
+}
+
+/*!
+ * @brief Insert the data at the tail of the list
+ * @param ulist
+ * @param data
+ */
+void ulist_append(ulist_t * ulist, void * data)
+{
+    assert(ulist);
+    assert(data);
+
+    ulist_chunk_t * chunk = ulist->tail;
+    if ((NULL == chunk) || (CHUNK_ITEMS == chunk->start + chunk->count))
+    {
+        chunk = add_chunk(ulist, ulist->tail, 0);
+    }
+    chunk->items[chunk->start + chunk->count] = data;
+    chunk->count++;
+    ulist->length++;
+}
+
+/*!
+ * @brief Insert the data at the head of the list
+ * @param ulist
+ * @param data
+ */
+void ulist_prepend(ulist_t * ulist, void * data)
+{
+    assert(ulist);
+    assert(data);
+
+    ulist_chunk_t * chunk = ulist->head;
+    if ((NULL == chunk) || (0 == chunk->start))
+    {
+        chunk = add_chunk(ulist, NULL, CHUNK_ITEMS);
+    }
+    chunk->start--;
+    chunk->items[chunk->start] = data;
+    chunk->count++;
+    ulist->length++;
+}
+
+/*!
+ * @brief Insert the data at the given index. The new item takes the index
+ * and the items from the index onwards move right. A negative index counts
+ * back from the tail with -1 being the tail.
+ * @param ulist
+ * @param data
+ * @param index
+ * @return DLIST_SUCC if successful or DLIST_FAIL if the index is out of range
+ */
+dlist_result_t ulist_insert(ulist_t * ulist, void * data, int32_t index)
+{
+    assert(ulist);
+    assert(data);
+
+    if (0 == ulist->length)
+    {
+        ulist_append(ulist, data);
+        return DLIST_SUCC;
+    }
+
+    size_t position = 0;
+    if (!(get_position(ulist, index, &position)))
+    {
+        return DLIST_FAIL;
+    }
+    size_t offset = 0;
+    ulist_chunk_t * chunk = get_chunk(ulist, position, &offset);
+    insert_item(ulist, chunk, offset, data);
+    return DLIST_SUCC;
+}
+
+/*!
+ * @brief Remove the tail of the list
+ * @param ulist
+ * @return Data of the tail or NULL if the list is empty
+ */
+void * ulist_pop_tail(ulist_t * ulist)
+{
+    assert(ulist);
+    if (0 == ulist->length)
+    {
+        return NULL;
+    }
+
+    ulist_chunk_t * chunk = ulist->tail;
+    chunk->count--;
+    ulist->length--;
+    void * data = chunk->items[chunk->start + chunk->count];
+    if (0 == chunk->count)
+    {
+        remove_chunk(ulist, chunk);
+    }
+    return data;
+}
+
+/*!
+ * @brief Remove the head of the list
+ * @param ulist
+ * @return Data of the head or NULL if the list is empty
+ */
+void * ulist_pop_head(ulist_t * ulist)
+{
+    assert(ulist);
+    if (0 == ulist->length)
+    {
+        return NULL;
+    }
+
+    ulist_chunk_t * chunk = ulist->head;
+    void * data = chunk->items[chunk->start];
+    chunk->start++;
+    chunk->count--;
+    ulist->length--;
+    if (0 == chunk->count)
+    {
+        remove_chunk(ulist, chunk);
+    }
+    return data;
+}
+
+/*!
+ * @brief Return the first item matching the data with the comparison
+ * function
+ * @param ulist
+ * @param data
+ * @return Data of the item or NULL if not found
+ */
+void * ulist_get_by_value(ulist_t * ulist, void * data)
+{
+    assert(ulist);
+    size_t offset = 0;
+    ulist_chunk_t * chunk = find_item(ulist, data, &offset);
+    return (NULL == chunk) ? NULL : chunk->items[chunk->start + offset];
+}
+
+/*!
+ * @brief Return the item at the index. A negative index counts back from the
+ * tail with -1 being the tail.
+ * @param ulist
+ * @param index
+ * @return Data of the item or NULL if the index is out of range
+ */
+void * ulist_get_by_index(ulist_t * ulist, int32_t index)
+{
+    assert(ulist);
+    size_t position = 0;
+    if (!(get_position(ulist, index, &position)))
+    {
+        return NULL;
+    }
+    size_t offset = 0;
+    ulist_chunk_t * chunk = get_chunk(ulist, position, &offset);
+    return chunk->items[chunk->start + offset];
+}
+
+/*!
+ * @brief Remove the first item matching the data with the comparison
+ * function
+ * @param ulist
+ * @param data
+ * @return Data of the removed item or NULL if not found
+ */
+void * ulist_remove_value(ulist_t * ulist, void * data)
+{
+    assert(ulist);
+    size_t offset = 0;
+    ulist_chunk_t * chunk = find_item(ulist, data, &offset);
+    if (NULL == chunk)
+    {
+        return NULL;
+    }
+    return remove_item(ulist, chunk, offset);
+}
+
+/*!
+ * @brief Public function to check if the list is empty
+ * @param ulist
+ * @return True if empty
+ */
+bool ulist_is_empty(ulist_t * ulist)
+{
+    assert(ulist);
+    return 0 == ulist->length;
+}
+
+/*!
+ * @brief Return the number of items in the list
+ * @param ulist
+ * @return Number of items
+ */
+size_t ulist_get_length(ulist_t * ulist)
+{
+    assert(ulist);
+    return ulist->length;
+}
+
+/*!
+ * @brief Check if an item matches the data with the comparison function
+ * @param ulist
+ * @param data
+ * @return True if found
+ */
+bool ulist_value_in_ulist(ulist_t * ulist, void * data)
+{
+    return NULL != ulist_get_by_value(ulist, data);
+}
+
+/*!
+ * @brief Place the iterator on the head or the tail of the list
+ * @param ulist
+ * @param iter Iterator owned by the caller
+ * @param pos ITER_HEAD or ITER_TAIL
+ */
+void ulist_iter_init(ulist_t * ulist, ulist_iter_t * iter, iter_start_t pos)
+{
+    assert(ulist);
+    assert(iter);
+    ulist_chunk_t * chunk = (ITER_HEAD == pos) ? ulist->head : ulist->tail;
+    * iter = (ulist_iter_t) {
+        .chunk  = chunk,
+        .slot   = 0
+    };
+    if (NULL != chunk)
+    {
+        iter->slot = (ITER_HEAD == pos) ? chunk->start
+                                        : chunk->start + chunk->count - 1;
+    }
+}
+
+/*!
+ * @brief Return the item under the iterator and move it towards the tail
+ * @param iter
+ * @return Data of the item or NULL once the iterator went past the tail
+ */
+void * ulist_iter_next(ulist_iter_t * iter)
+{
+    assert(iter);
+    ulist_chunk_t * chunk = iter->chunk;
+    if (NULL == chunk)
+    {
+        return NULL;
+    }
+
+    void * data = chunk->items[iter->slot];
+    iter->slot++;
+    if (iter->slot == chunk->start + chunk->count)
+    {
+        iter->chunk = chunk->next;
+        iter->slot = (NULL == chunk->next) ? 0 : chunk->next->start;
+    }
+    return data;
+}
+
+/*!
+ * @brief Return the item under the iterator and move it towards the head
+ * @param iter
+ * @return Data of the item or NULL once the iterator went past the head
+ */
+void * ulist_iter_prev(ulist_iter_t * iter)
+{
+    assert(iter);
+    ulist_chunk_t * chunk = iter->chunk;
+    if (NULL == chunk)
+    {
+        return NULL;
+    }
+
+    void * data = chunk->items[iter->slot];
+    if (iter->slot == chunk->start)
+    {
+        iter->chunk = chunk->prev;
+        iter->slot = (NULL == chunk->prev)
+                     ? 0 : chunk->prev->start + chunk->prev->count - 1;
+    }
+    else
+    {
+        iter->slot--;
+    }
+    return data;
+}
+
+/*!
+ * @brief Link an empty chunk after prev, or at the head if prev is NULL. The
+ * spare chunk is used before allocating. Like the dlist, running out of
+ * memory aborts.
+ * @param ulist
+ * @param prev Chunk to link after or NULL
+ * @param start First slot the items go in, CHUNK_ITEMS for a chunk that
+ * grows towards the front
+ * @return New chunk
+ */
+static ulist_chunk_t * add_chunk(ulist_t * ulist,
+                                 ulist_chunk_t * prev,
+                                 size_t start)
+{
+    ulist_chunk_t * chunk = ulist->spare;
+    ulist->spare = NULL;
+    if (NULL == chunk)
+    {
+        chunk = (ulist_chunk_t *)malloc(sizeof(ulist_chunk_t));
+        if (INVALID_PTR == verify_alloc(chunk))
+        {
+            ulist_destroy(ulist);
+            abort();
+        }
+    }
+
+    chunk->start = start;
+    chunk->count = 0;
+    chunk->prev = prev;
+    chunk->next = (NULL == prev) ? ulist->head : prev->next;
+    if (NULL != chunk->next)
+    {
+        chunk->next->prev = chunk;
+    }
+    else
+    {
+        ulist->tail = chunk;
+    }
+    if (NULL != prev)
+    {
+        prev->next = chunk;
+    }
+    else
+    {
+        ulist->head = chunk;
+    }
+    return chunk;
+}
+
+/*!
+ * @brief Unlink the chunk and keep it as the spare chunk or free it
+ * @param ulist
+ * @param chunk
+ */
+static void remove_chunk(ulist_t * ulist, ulist_chunk_t * chunk)
+{
+    if (NULL != chunk->prev)
+    {
+        chunk->prev->next = chunk->next;
+    }
+    else
+    {
+        ulist->head = chunk->next;
+    }
+    if (NULL != chunk->next)
+    {
+        chunk->next->prev = chunk->prev;
+    }
+    else
+    {
+        ulist->tail = chunk->prev;
+    }
+
+    if (NULL == ulist->spare)
+    {
+        ulist->spare = chunk;
+    }
+    else
+    {
+        free(chunk);
+    }
+}
+
+/*!
+ * @brief Move the items of the right chunk into the left chunk if both are
+ * small enough, which keeps the chunks from thinning out after removals
+ * @param ulist
+ * @param left
+ * @param right Chunk following left
+ */
+static void merge_chunks(ulist_t * ulist,
+                         ulist_chunk_t * left,
+                         ulist_chunk_t * right)
+{
+    if ((NULL == left) || (NULL == right)
+        || (left->count + right->count > MERGE_ITEMS))
+    {
+        return;
+    }
+
+    memmove(&left->items[0],
+            &left->items[left->start],
+            left->count * sizeof(void *));
+    memcpy(&left->items[left->count],
+           &right->items[right->start],
+           right->count * sizeof(void *));
+    left->start = 0;
+    left->count = left->count + right->count;
+    remove_chunk(ulist, right);
+}
+
+/*!
+ * @brief Insert the data in front of the item at the offset of the chunk. A
+ * full chunk is split in two first. The items on the side with room are
+ * moved by one slot.
+ * @param ulist
+ * @param chunk
+ * @param offset Offset from the start of the chunk
+ * @param data
+ */
+static void insert_item(ulist_t * ulist,
+                        ulist_chunk_t * chunk,
+                        size_t offset,
+                        void * data)
+{
+    if (CHUNK_ITEMS == chunk->count)
+    {
+        size_t half = CHUNK_ITEMS / 2;
+        ulist_chunk_t * upper = add_chunk(ulist, chunk, 0);
+        memcpy(&upper->items[0],
+               &chunk->items[chunk->start + half],
+               (CHUNK_ITEMS - half) * sizeof(void *));
+        upper->count = CHUNK_ITEMS - half;
+        chunk->count = half;
+        if (offset > half)
+        {
+            chunk = upper;
+            offset = offset - half;
+        }
+    }
+
+    bool has_back_room = chunk->start + chunk->count < CHUNK_ITEMS;
+    if ((0 != chunk->start) && ((!has_back_room) || (offset < chunk->count / 2)))
+    {
+        memmove(&chunk->items[chunk->start - 1],
+                &chunk->items[chunk->start],
+                offset * sizeof(void *));
+        chunk->start--;
+    }
+    else
+    {
+        memmove(&chunk->items[chunk->start + offset + 1],
+                &chunk->items[chunk->start + offset],
+                (chunk->count - offset) * sizeof(void *));
+    }
+    chunk->items[chunk->start + offset] = data;
+    chunk->count++;
+    ulist->length++;
+}
+
+/*!
+ * @brief Remove the item at the offset of the chunk by moving the shorter
+ * side of the chunk over it
+ * @param ulist
+ * @param chunk
+ * @param offset Offset from the start of the chunk
+ * @return Data of the item
+ */
+static void * remove_item(ulist_t * ulist, ulist_chunk_t * chunk, size_t offset)
+{
+    void * data = chunk->items[chunk->start + offset];
+    if (offset < chunk->count / 2)
+    {
+        memmove(&chunk->items[chunk->start + 1],
+                &chunk->items[chunk->start],
+                offset * sizeof(void *));
+        chunk->start++;
+    }
+    else
+    {
+        memmove(&chunk->items[chunk->start + offset],
+                &chunk->items[chunk->start + offset + 1],
+                (chunk->count - offset - 1) * sizeof(void *));
+    }
+    chunk->count--;
+    ulist->length--;
+
+    if (0 == chunk->count)
+    {
+        remove_chunk(ulist, chunk);
+        return data;
+    }
+    ulist_chunk_t * prev = chunk->prev;
+    merge_chunks(ulist, chunk, chunk->next);
+    merge_chunks(ulist, prev, chunk);
+    return data;
+}
+
+/*!
+ * @brief Free every chunk, passing the items to the free function if any
+ * @param ulist
+ * @param free_func Function freeing the data or NULL
+ */
+static void ulist_destroy_(ulist_t * ulist, void (* free_func)(void *))
+{
+    ulist_chunk_t * chunk = ulist->head;
+    while (NULL != chunk)
+    {
+        ulist_chunk_t * next = chunk->next;
+        for (size_t i = 0; (NULL != free_func) && (i < chunk->count); i++)
+        {
+            free_func(chunk->items[chunk->start + i]);
+        }
+        free(chunk);
+        chunk = next;
+    }
+    free(ulist->spare);
+    free(ulist);
+}
+
+/*!
+ * @brief Turn the index into a position from the head
+ * @param ulist
+ * @param index Index where a negative index counts back from the tail
+ * @param position Set to the position
+ * @return False if the index is out of range
+ */
+static bool get_position(ulist_t * ulist, int32_t index, size_t * position)
+{
+    if (index < 0)
+    {
+        size_t back = (size_t)(-(int64_t)index);
+        if (back > ulist->length)
+        {
+            return false;
+        }
+        * position = ulist->length - back;
+        return true;
+    }
+    if ((size_t)index >= ulist->length)
+    {
+        return false;
+    }
+    * position = (size_t)index;
+    return true;
+}
+
+/*!
+ * @brief Find the chunk holding the position by walking the chunks from the
+ * nearer end
+ * @param ulist
+ * @param position Position from the head, lower than the length
+ * @param offset Set to the offset of the item in the chunk
+ * @return Chunk holding the item
+ */
+static ulist_chunk_t * get_chunk(ulist_t * ulist, size_t position, size_t * offset)
+{
+    ulist_chunk_t * chunk = NULL;
+    if (position < ulist->length / 2)
+    {
+        chunk = ulist->head;
+        while (position >= chunk->count)
+        {
+            position = position - chunk->count;
+            chunk = chunk->next;
+        }
+    }
+    else
+    {
+        size_t remaining = ulist->length - position;
+        chunk = ulist->tail;
+        while (remaining > chunk->count)
+        {
+            remaining = remaining - chunk->count;
+            chunk = chunk->prev;
+        }
+        position = chunk->count - remaining;
+    }
+    * offset = position;
+    return chunk;
+}
+
+/*!
+ * @brief Find the first item matching the data with the comparison function
+ * @param ulist
+ * @param data
+ * @param offset Set to the offset of the item in its chunk
+ * @return Chunk holding the item or NULL if not found
+ */
+static ulist_chunk_t * find_item(ulist_t * ulist, void * data, size_t * offset)
+{
+    assert(ulist->compare_func);
+    for (ulist_chunk_t * chunk = ulist->head; NULL != chunk; chunk = chunk->next)
+    {
+        void ** items = &chunk->items[chunk->start];
+        for (size_t i = 0; i < chunk->count; i++)
+        {
+            if (DLIST_MATCH == ulist->compare_func(items[i], data))
+            {
+                * offset = i;
+                return chunk;
+            }
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <dl_ilist.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+/*
+ * Structure with an embedded link, the link is not the first member so the
+ * offset is exercised
+ */
+typedef struct
+{
+    int value;
+    int order;
+    ilist_link_t link;
+} record_t;
+
+dlist_compare_t compare_records(void * data1, void * data2)
+{
+    int left = ((record_t *)data1)->value;
+    int right = ((record_t *)data2)->value;
+    if (left > right)
+    {
+        return DLIST_GT;
+    }
+    else if (left < right)
+    {
+        return DLIST_LT;
+    }
+    return DLIST_EQ;
+}
+
+static std::vector<int> get_values(ilist_t * list)
+{
+    std::vector<int> values;
+    for (ilist_link_t * link = ilist_get_head(list); nullptr != link;
+         link = ilist_get_next(list, link))
+    {
+        values.push_back(ilist_entry(link, record_t, link)->value);
+    }
+    return values;
+}
+
+TEST(IListTest, PushPopAndRemove)
+{
+    ilist_t list;
+    ilist_init(&list);
+    EXPECT_TRUE(ilist_is_empty(&list));
+    EXPECT_EQ(ilist_pop_head(&list), nullptr);
+    EXPECT_EQ(ilist_get_tail(&list), nullptr);
+
+    record_t records[6];
+    for (int i = 0; i < 6; i++)
+    {
+        records[i].value = i;
+        ilist_link_init(&records[i].link);
+        EXPECT_FALSE(ilist_is_linked(&records[i].link));
+    }
+    ilist_push_tail(&list, &records[2].link);
+    ilist_push_head(&list, &records[0].link);
+    ilist_insert_after(&list, &records[0].link, &records[1].link);
+    ilist_push_tail(&list, &records[5].link);
+    ilist_insert_before(&list, &records[5].link, &records[4].link);
+    ilist_insert_before(&list, &records[4].link, &records[3].link);
+    EXPECT_EQ(get_values(&list), std::vector<int>({0, 1, 2, 3, 4, 5}));
+    EXPECT_EQ(ilist_get_length(&list), 6);
+    EXPECT_TRUE(ilist_is_linked(&records[3].link));
+
+    // Removing by element needs no search
+    ilist_remove(&list, &records[3].link);
+    EXPECT_FALSE(ilist_is_linked(&records[3].link));
+    EXPECT_EQ(ilist_get_prev(&list, &records[4].link), &records[2].link);
+    EXPECT_EQ(ilist_get_prev(&list, &records[0].link), nullptr);
+    EXPECT_EQ(ilist_get_next(&list, &records[5].link), nullptr);
+
+    EXPECT_EQ(ilist_entry(ilist_pop_tail(&list), record_t, link), &records[5]);
+    EXPECT_EQ(ilist_entry(ilist_pop_head(&list), record_t, link), &records[0]);
+    EXPECT_EQ(get_values(&list), std::vector<int>({1, 2, 4}));
+}
+
+TEST(IListTest, SortIsStable)
+{
+    std::mt19937 engine(4);
+    std::vector<record_t> records(1000);
+    ilist_t list;
+    ilist_init(&list);
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        records[i].value = (int)(engine() % 50);
+        records[i].order = (int)i;
+        ilist_push_tail(&list, &records[i].link);
+    }
+
+    ilist_sort(&list, offsetof(record_t, link), ASCENDING, compare_records);
+    EXPECT_EQ(ilist_get_length(&list), records.size());
+    record_t * previous = nullptr;
+    for (ilist_link_t * link = ilist_get_head(&list); nullptr != link;
+         link = ilist_get_next(&list, link))
+    {
+        record_t * record = ilist_entry(link, record_t, link);
+        if (nullptr != previous)
+        {
+            ASSERT_LE(previous->value, record->value);
+            if (previous->value == record->value)
+            {
+                ASSERT_LT(previous->order, record->order);
+            }
+            ASSERT_EQ(ilist_get_prev(&list, link), &previous->link);
+        }
+        previous = record;
+    }
+    EXPECT_EQ(ilist_get_tail(&list), &previous->link);
+
+    ilist_sort(&list, offsetof(record_t, link), DESCENDING, compare_records);
+    std::vector<int> values = get_values(&list);
+    EXPECT_TRUE(std::is_sorted(values.rbegin(), values.rend()));
+}
@@ -1,11 +1,9 @@
 #include <gtest/gtest.h>
 #include <dl_list.h>
 #include <cstring>
-
-extern "C"
-{
-    extern int32_t get_inverse(int32_t value);
-}
+#include <algorithm>
+#include <random>
+#include <vector>
 
 /*
  * Helper Functions for testing
@@ -345,17 +343,6 @@ TEST_F(DListTestFixture, TestForwardReverse)
     EXPECT_EQ(count, 10);
 }
 
-// Test ability to inverse the length for iterating in reverse
-TEST_F(DListTestFixture, TesteInverseFunc)
-{
-    // get the inverse in cpp
-    int target_value = this->length;
-    target_value *= -1;
-
-    EXPECT_EQ(target_value, get_inverse(this->length));
-}
-
-
 // Test ability to fetch a value by its index even if it is negative
 TEST_F(DListTestFixture, TestFetchByIndex)
 {
@@ -459,3 +446,628 @@ TEST_F(DListTestFixture, TestNumberOfIters)
     dlist_destroy_iter(iter_loca);
     EXPECT_EQ(dlist_get_active_iters(dlist), 1);
 }
+
+// Nodes popped from a pooled dlist are handed out again by the next appends
+TEST(dlist_pool_test, PrivatePoolReusesNodes)
+{
+    dlist_t * dlist = dlist_init_pooled(compare_payloads, nullptr);
+    ASSERT_NE(dlist, nullptr);
+    for (int i = 0; i < 100; i++)
+    {
+        dlist_append(dlist, get_payload(i));
+    }
+    for (int round = 0; round < 10; round++)
+    {
+        for (int i = 0; i < 50; i++)
+        {
+            free_payload(dlist_pop_head(dlist));
+        }
+        for (int i = 0; i < 50; i++)
+        {
+            dlist_append(dlist, get_payload(i));
+        }
+    }
+    EXPECT_EQ(dlist_get_length(dlist), 100);
+
+    char * value = (char *)dlist_pop_head(dlist);
+    EXPECT_STREQ(value, "Hello world: 0\n");
+    free_payload(value);
+    dlist_destroy_free(dlist, free_payload);
+}
+
+// A shared pool outlives the handle of its creator until every list is gone
+TEST(dlist_pool_test, SharedPool)
+{
+    dlist_pool_t * pool = dlist_pool_init();
+    ASSERT_NE(pool, nullptr);
+    dlist_t * first = dlist_init_pooled(compare_payloads, pool);
+    dlist_t * second = dlist_init_pooled(compare_payloads, pool);
+    dlist_pool_destroy(pool);
+
+    for (int i = 0; i < 200; i++)
+    {
+        dlist_append(first, get_payload(i));
+        dlist_prepend(second, get_payload(i));
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        dlist_append(second, dlist_pop_tail(first));
+    }
+    EXPECT_EQ(dlist_get_length(first), 100);
+    EXPECT_EQ(dlist_get_length(second), 300);
+
+    dlist_destroy_free(first, free_payload);
+    char * value = (char *)dlist_pop_head(second);
+    EXPECT_STREQ(value, "Hello world: 199\n");
+    free_payload(value);
+    dlist_destroy_free(second, free_payload);
+}
+
+// Destroying a pooled dlist without freeing the data skips the nodes
+TEST(dlist_pool_test, DestroyWithoutFree)
+{
+    int values[64];
+    dlist_t * dlist = dlist_init_pooled(nullptr, nullptr);
+    for (int & value : values)
+    {
+        dlist_append(dlist, &value);
+    }
+    EXPECT_EQ(dlist_pop_tail(dlist), &values[63]);
+    dlist_destroy(dlist);
+}
+
+// Handles returned on insert and find remove their node without a search
+TEST(dlist_handle_test, RemoveByHandle)
+{
+    dlist_t * dlist = dlist_init(compare_payloads);
+    std::vector<dnode_t *> handles;
+    for (int i = 0; i < 10; i++)
+    {
+        handles.push_back(dlist_append_node(dlist, get_payload(i)));
+    }
+    dnode_t * head = dlist_prepend_node(dlist, get_payload(-1));
+    EXPECT_EQ(dlist_get_length(dlist), 11);
+
+    char * value = (char *)dlist_remove_node(dlist, handles[4]);
+    EXPECT_STREQ(value, "Hello world: 4\n");
+    free_payload(value);
+    value = (char *)dlist_remove_node(dlist, head);
+    EXPECT_STREQ(value, "Hello world: -1\n");
+    free_payload(value);
+    value = (char *)dlist_remove_node(dlist, handles[9]);
+    EXPECT_STREQ(value, "Hello world: 9\n");
+    free_payload(value);
+
+    char * target = get_payload(7);
+    EXPECT_EQ(dlist_find_node(dlist, target), handles[7]);
+    free_payload(dlist_remove_node(dlist, dlist_find_node(dlist, target)));
+    EXPECT_EQ(dlist_find_node(dlist, target), nullptr);
+    free_payload(target);
+
+    EXPECT_EQ(dlist_get_length(dlist), 7);
+    EXPECT_STREQ((char *)dlist_get_by_index(dlist, 0), "Hello world: 0\n");
+    EXPECT_STREQ((char *)dlist_get_by_index(dlist, -1), "Hello world: 8\n");
+    dlist_destroy_free(dlist, free_payload);
+}
+
+// Iters on a removed node move on to the next node or back from the tail
+TEST(dlist_handle_test, ItersLeaveRemovedNodes)
+{
+    dlist_t * dlist = dlist_init(compare_payloads);
+    std::vector<dnode_t *> handles;
+    for (int i = 0; i < 5; i++)
+    {
+        handles.push_back(dlist_append_node(dlist, get_payload(i)));
+    }
+    dlist_iter_t * middle = dlist_get_iterable(dlist, ITER_HEAD);
+    dlist_get_iter_next(middle);
+    dlist_get_iter_next(middle);
+    dlist_iter_t * tail = dlist_get_iterable(dlist, ITER_TAIL);
+
+    free_payload(dlist_remove_node(dlist, handles[2]));
+    EXPECT_STREQ((char *)iter_get_value(middle), "Hello world: 3\n");
+    EXPECT_EQ(dlist_get_iter_index(middle), 2);
+
+    free_payload(dlist_pop_tail(dlist));
+    EXPECT_STREQ((char *)iter_get_value(tail), "Hello world: 3\n");
+    EXPECT_EQ(dlist_get_iter_index(tail), 2);
+
+    // Single pass removal by value updates the iters the same way
+    char * target = get_payload(3);
+    free_payload(dlist_remove_value(dlist, target));
+    free_payload(target);
+    EXPECT_STREQ((char *)iter_get_value(middle), "Hello world: 1\n");
+    EXPECT_STREQ((char *)iter_get_value(tail), "Hello world: 1\n");
+
+    dlist_destroy_iter(middle);
+    dlist_destroy_iter(tail);
+    EXPECT_EQ(dlist_get_active_iters(dlist), 0);
+    dlist_destroy_free(dlist, free_payload);
+}
+
+// Cursors walk the dlist without registering with it
+TEST(dlist_cursor_test, WalkAndInvalidate)
+{
+    dlist_t * dlist = dlist_init(compare_payloads);
+    dlist_cursor_t cursor = dlist_get_cursor(dlist, ITER_HEAD);
+    EXPECT_EQ(dlist_cursor_get_value(&cursor), nullptr);
+
+    for (int i = 0; i < 5; i++)
+    {
+        dlist_append(dlist, get_payload(i));
+    }
+    EXPECT_FALSE(dlist_cursor_is_valid(&cursor));
+    EXPECT_EQ(dlist_cursor_next(&cursor), nullptr);
+
+    cursor = dlist_get_cursor(dlist, ITER_HEAD);
+    EXPECT_EQ(dlist_get_active_iters(dlist), 0);
+    EXPECT_STREQ((char *)dlist_cursor_get_value(&cursor), "Hello world: 0\n");
+    EXPECT_STREQ((char *)dlist_cursor_next(&cursor), "Hello world: 1\n");
+    EXPECT_EQ(dlist_cursor_get_index(&cursor), 1);
+
+    dlist_cursor_t tail = dlist_get_cursor(dlist, ITER_TAIL);
+    EXPECT_EQ(dlist_cursor_get_index(&tail), 4);
+    EXPECT_STREQ((char *)dlist_cursor_prev(&tail), "Hello world: 3\n");
+
+    // Lookups do not invalidate cursors, changes do
+    EXPECT_STREQ((char *)dlist_get_by_index(dlist, 3), "Hello world: 3\n");
+    EXPECT_TRUE(dlist_cursor_is_valid(&cursor));
+    free_payload(dlist_pop_head(dlist));
+    EXPECT_FALSE(dlist_cursor_is_valid(&cursor));
+    EXPECT_EQ(dlist_cursor_get_value(&tail), nullptr);
+
+    // Walk to the end
+    cursor = dlist_get_cursor(dlist, ITER_HEAD);
+    int count = 1;
+    while (nullptr != dlist_cursor_next(&cursor))
+    {
+        count++;
+    }
+    EXPECT_EQ(count, 4);
+    EXPECT_EQ(dlist_cursor_next(&cursor), nullptr);
+    dlist_destroy_free(dlist, free_payload);
+}
+
+static void sum_values(void * data, void * context)
+{
+    * (int *)context += * (int *)data;
+}
+
+static bool is_multiple(void * data, void * context)
+{
+    return 0 == (* (int *)data % * (int *)context);
+}
+
+static void * double_value(void * data, void * context)
+{
+    (void)context;
+    * (int *)data *= 2;
+    return data;
+}
+
+TEST(dlist_bulk_test, ForEachRemoveIfAndMap)
+{
+    dlist_t * dlist = dlist_init(nullptr);
+    for (int i = 0; i < 1000; i++)
+    {
+        int * value = (int *)malloc(sizeof(int));
+        * value = i;
+        dlist_append(dlist, value);
+    }
+
+    int sum = 0;
+    dlist_for_each(dlist, sum_values, &sum);
+    EXPECT_EQ(sum, 999 * 1000 / 2);
+
+    // An iter past the removed nodes keeps pointing at its value
+    dlist_iter_t * iter = dlist_get_iterable(dlist, ITER_TAIL);
+    dlist_get_iter_prev(iter);
+    int divisor = 3;
+    EXPECT_EQ(dlist_remove_if(dlist, is_multiple, &divisor, free), 334);
+    EXPECT_EQ(dlist_get_length(dlist), 666);
+    EXPECT_EQ(* (int *)iter_get_value(iter), 998);
+    EXPECT_EQ(dlist_get_iter_index(iter), 665);
+    EXPECT_EQ(* (int *)dlist_get_by_index(dlist, 665), 998);
+    dlist_destroy_iter(iter);
+
+    dlist_map(dlist, double_value, nullptr);
+    sum = 0;
+    dlist_for_each(dlist, sum_values, &sum);
+    EXPECT_EQ(sum, 2 * (999 * 1000 / 2 - 3 * (333 * 334 / 2)));
+    int * head = (int *)dlist_pop_head(dlist);
+    EXPECT_EQ(* head, 2);
+    free(head);
+
+    divisor = 1;
+    EXPECT_EQ(dlist_remove_if(dlist, is_multiple, &divisor, free), 665);
+    EXPECT_TRUE(dlist_is_empty(dlist));
+    dlist_destroy(dlist);
+}
+
+static dlist_match_t compare_ints(void * data1, void * data2)
+{
+    return (* (int *)data1 == * (int *)data2) ? DLIST_MATCH : DLIST_MISS_MATCH;
+}
+
+// Few distinct hashes so that the probes run into other values
+static size_t hash_int(void * data)
+{
+    return (size_t)(* (int *)data % 8);
+}
+
+TEST(dlist_hash_index_test, LookupsFollowTheDlist)
+{
+    dlist_t * dlist = dlist_init(compare_ints);
+    std::vector<int> values(500);
+    for (int i = 0; i < 500; i++)
+    {
+        values[i] = i;
+        dlist_append(dlist, &values[i]);
+    }
+    EXPECT_EQ(dlist_set_hash_index(dlist, hash_int), DLIST_SUCC);
+
+    int target = 321;
+    EXPECT_EQ(dlist_get_by_value(dlist, &target), &values[321]);
+    EXPECT_TRUE(dlist_value_in_dlist(dlist, &target));
+    EXPECT_EQ(dlist_remove_value(dlist, &target), &values[321]);
+    EXPECT_FALSE(dlist_value_in_dlist(dlist, &target));
+    EXPECT_EQ(dlist_get_length(dlist), 499);
+
+    // Duplicates still return the first one in the dlist
+    int first = 42;
+    int second = 42;
+    dlist_prepend(dlist, &first);
+    dlist_insert(dlist, &second, 10);
+    target = 42;
+    EXPECT_EQ(dlist_get_by_value(dlist, &target), &first);
+    EXPECT_EQ(dlist_remove_value(dlist, &target), &first);
+    EXPECT_EQ(dlist_remove_value(dlist, &target), &second);
+    EXPECT_EQ(dlist_remove_value(dlist, &target), &values[42]);
+    EXPECT_EQ(dlist_remove_value(dlist, &target), nullptr);
+
+    // Popping and adding more values keeps the index in sync
+    for (int i = 0; i < 100; i++)
+    {
+        dlist_pop_head(dlist);
+    }
+    target = 50;
+    EXPECT_EQ(dlist_get_by_value(dlist, &target), nullptr);
+    target = 150;
+    EXPECT_EQ(dlist_find_node(dlist, &target)->data, &values[150]);
+
+    std::vector<int> more(1000);
+    for (int i = 0; i < 1000; i++)
+    {
+        more[i] = 1000 + i;
+        dlist_append(dlist, &more[i]);
+    }
+    target = 1999;
+    EXPECT_EQ(dlist_get_by_value(dlist, &target), &more[999]);
+
+    // Without the index the dlist is scanned
+    EXPECT_EQ(dlist_set_hash_index(dlist, nullptr), DLIST_SUCC);
+    EXPECT_EQ(dlist_get_by_value(dlist, &target), &more[999]);
+    dlist_destroy(dlist);
+}
+
+static bool is_even(void * data, void * context)
+{
+    (void)context;
+    return 0 == (* (int *)data % 2);
+}
+
+static void * next_value(void * data, void * context)
+{
+    return (int *)data + * (ptrdiff_t *)context;
+}
+
+TEST(dlist_hash_index_test, BulkMethodsKeepTheIndex)
+{
+    dlist_t * dlist = dlist_init(compare_ints);
+    EXPECT_EQ(dlist_set_hash_index(dlist, hash_int), DLIST_SUCC);
+    std::vector<int> values(201);
+    for (int i = 0; i < 200; i++)
+    {
+        values[i] = i;
+        dlist_append(dlist, &values[i]);
+    }
+
+    EXPECT_EQ(dlist_remove_if(dlist, is_even, nullptr, nullptr), 100);
+    int target = 10;
+    EXPECT_FALSE(dlist_value_in_dlist(dlist, &target));
+    target = 11;
+    EXPECT_TRUE(dlist_value_in_dlist(dlist, &target));
+
+    // Every node now holds the even value after its odd one
+    ptrdiff_t step = 1;
+    dlist_map(dlist, next_value, &step);
+    EXPECT_FALSE(dlist_value_in_dlist(dlist, &target));
+    target = 12;
+    EXPECT_EQ(dlist_get_by_value(dlist, &target), &values[12]);
+    dlist_destroy(dlist);
+}
+
+// Compare every index of the dlist, in a shuffled order so the lookups come
+// from the head, the tail and the last looked up node
+static void expect_same_order(dlist_t * dlist, std::vector<int *> & expected,
+                              std::mt19937 & engine)
+{
+    ASSERT_EQ(dlist_get_length(dlist), expected.size());
+    std::vector<int32_t> indexes(expected.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        indexes[i] = (int32_t)i;
+    }
+    std::shuffle(indexes.begin(), indexes.end(), engine);
+    for (int32_t index : indexes)
+    {
+        ASSERT_EQ(dlist_get_by_index(dlist, index), expected[(size_t)index]);
+        ASSERT_EQ(dlist_get_by_index(dlist, index - (int32_t)expected.size()),
+                  expected[(size_t)index]);
+    }
+}
+
+TEST(dlist_index_access_test, FingerFollowsChanges)
+{
+    std::mt19937 engine(11);
+    dlist_t * dlist = dlist_init(compare_ints);
+    std::vector<int> values(2000);
+    std::vector<int *> expected;
+    for (int i = 0; i < 2000; i++)
+    {
+        values[(size_t)i] = i;
+    }
+
+    for (int round = 0; round < 2000; round++)
+    {
+        int * value = &values[(size_t)round];
+        int32_t length = (int32_t)expected.size();
+        switch (engine() % 8)
+        {
+            case 0:
+                dlist_append(dlist, value);
+                expected.push_back(value);
+                break;
+            case 1:
+                dlist_prepend(dlist, value);
+                expected.insert(expected.begin(), value);
+                break;
+            case 2:
+                if (0 != length)
+                {
+                    int32_t index = (int32_t)(engine() % (uint32_t)length);
+                    EXPECT_EQ(dlist_insert(dlist, value, index - length),
+                              DLIST_SUCC);
+                    expected.insert(expected.begin() + index, value);
+                }
+                break;
+            case 3:
+                if (0 != length)
+                {
+                    EXPECT_EQ(dlist_pop_head(dlist), expected.front());
+                    expected.erase(expected.begin());
+                }
+                break;
+            case 4:
+                if (0 != length)
+                {
+                    EXPECT_EQ(dlist_pop_tail(dlist), expected.back());
+                    expected.pop_back();
+                }
+                break;
+            case 5:
+                if (0 != length)
+                {
+                    size_t index = engine() % (size_t)length;
+                    int * removed = expected[index];
+                    EXPECT_EQ(dlist_remove_value(dlist, removed), removed);
+                    expected.erase(expected.begin() + (ptrdiff_t)index);
+                }
+                break;
+            default:
+                if (0 != length)
+                {
+                    int32_t index = (int32_t)(engine() % (uint32_t)length);
+                    EXPECT_EQ(dlist_get_by_index(dlist, index),
+                              expected[(size_t)index]);
+                    EXPECT_EQ(dlist_insert(dlist, value, index), DLIST_SUCC);
+                    expected.insert(expected.begin() + index, value);
+                }
+                break;
+        }
+        if (0 == round % 250)
+        {
+            expect_same_order(dlist, expected, engine);
+        }
+    }
+    expect_same_order(dlist, expected, engine);
+
+    // Out of range indexes
+    int32_t length = (int32_t)expected.size();
+    EXPECT_EQ(dlist_get_by_index(dlist, length), nullptr);
+    EXPECT_EQ(dlist_get_by_index(dlist, -length - 1), nullptr);
+    EXPECT_EQ(dlist_get_by_index(dlist, INT32_MIN), nullptr);
+    dlist_destroy(dlist);
+}
+
+TEST(dlist_index_access_test, InsertAtIncreasingIndexes)
+{
+    dlist_t * dlist = dlist_init(nullptr);
+    std::vector<int> values(1000);
+    for (int i = 0; i < 1000; i++)
+    {
+        values[(size_t)i] = i;
+    }
+    dlist_append(dlist, &values[0]);
+    dlist_append(dlist, &values[999]);
+    for (int32_t i = 1; i < 999; i++)
+    {
+        EXPECT_EQ(dlist_insert(dlist, &values[(size_t)i], i), DLIST_SUCC);
+    }
+    for (int32_t i = 0; i < 1000; i++)
+    {
+        EXPECT_EQ(* (int *)dlist_get_by_index(dlist, i), i);
+    }
+    dlist_destroy(dlist);
+}
+
+// Check the dlist holds the values in order by walking both directions
+static void expect_values(dlist_t * dlist, const std::vector<int> & expected)
+{
+    ASSERT_EQ(dlist_get_length(dlist), expected.size());
+    dlist_cursor_t cursor = dlist_get_cursor(dlist, ITER_HEAD);
+    for (int value : expected)
+    {
+        ASSERT_EQ(* (int *)dlist_cursor_get_value(&cursor), value);
+        dlist_cursor_next(&cursor);
+    }
+    EXPECT_EQ(dlist_cursor_get_value(&cursor), nullptr);
+
+    cursor = dlist_get_cursor(dlist, ITER_TAIL);
+    for (auto value = expected.rbegin(); value != expected.rend(); value++)
+    {
+        ASSERT_EQ(* (int *)dlist_cursor_get_value(&cursor), * value);
+        dlist_cursor_prev(&cursor);
+    }
+    EXPECT_EQ(dlist_cursor_get_value(&cursor), nullptr);
+}
+
+static dlist_t * init_range(dlist_pool_t * pool, std::vector<int> & values,
+                            int start, int count)
+{
+    dlist_t * dlist = (nullptr == pool) ? dlist_init(compare_ints)
+                                        : dlist_init_pooled(compare_ints, pool);
+    for (int i = start; i < start + count; i++)
+    {
+        dlist_append(dlist, &values[(size_t)i]);
+    }
+    return dlist;
+}
+
+TEST(dlist_splice_test, ConcatMovesNodesAndIters)
+{
+    std::vector<int> values(20);
+    for (int i = 0; i < 20; i++)
+    {
+        values[(size_t)i] = i;
+    }
+    dlist_t * dlist = init_range(nullptr, values, 0, 10);
+    dlist_t * other = init_range(nullptr, values, 10, 10);
+
+    dlist_iter_t * iter = dlist_get_iterable(other, ITER_HEAD);
+    dlist_get_iter_next(iter);
+    dlist_cursor_t cursor = dlist_get_cursor(dlist, ITER_HEAD);
+
+    EXPECT_EQ(dlist_concat(dlist, other), DLIST_SUCC);
+    expect_values(dlist, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                          10, 11, 12, 13, 14, 15, 16, 17, 18, 19});
+    EXPECT_TRUE(dlist_is_empty(other));
+    EXPECT_FALSE(dlist_cursor_is_valid(&cursor));
+
+    // The iter now walks the dlist it was moved to
+    EXPECT_EQ(dlist_get_active_iters(other), 0);
+    EXPECT_EQ(dlist_get_active_iters(dlist), 1);
+    EXPECT_EQ(* (int *)iter_get_value(iter), 11);
+    EXPECT_EQ(dlist_get_iter_index(iter), 11);
+    EXPECT_EQ(* (int *)dlist_get_iter_prev(iter), 10);
+    dlist_destroy_iter(iter);
+
+    // The emptied dlist is still usable
+    dlist_append(other, &values[0]);
+    EXPECT_EQ(dlist_concat(other, dlist), DLIST_SUCC);
+    EXPECT_EQ(dlist_get_length(other), 21);
+    EXPECT_EQ(dlist_get_by_index(other, 20), &values[19]);
+    dlist_destroy(dlist);
+    dlist_destroy(other);
+}
+
+TEST(dlist_splice_test, SpliceRangeKeepsItersAndIndex)
+{
+    std::vector<int> values(20);
+    for (int i = 0; i < 20; i++)
+    {
+        values[(size_t)i] = i;
+    }
+    dlist_pool_t * pool = dlist_pool_init();
+    dlist_t * dlist = init_range(pool, values, 0, 10);
+    dlist_t * other = init_range(pool, values, 10, 10);
+    EXPECT_EQ(dlist_set_hash_index(dlist, hash_int), DLIST_SUCC);
+    EXPECT_EQ(dlist_set_hash_index(other, hash_int), DLIST_SUCC);
+
+    dlist_iter_t * tail_iter = dlist_get_iterable(dlist, ITER_TAIL);
+    dlist_iter_t * moved_iter = dlist_get_iterable(other, ITER_HEAD);
+    dlist_iter_t * kept_iter = dlist_get_iterable(other, ITER_TAIL);
+    for (int i = 0; i < 3; i++)
+    {
+        dlist_get_iter_next(moved_iter);
+    }
+
+    // Move 12, 13 and 14 in front of 5
+    EXPECT_EQ(dlist_splice(dlist, 5, other, 2, 3), DLIST_SUCC);
+    expect_values(dlist, {0, 1, 2, 3, 4, 12, 13, 14, 5, 6, 7, 8, 9});
+    expect_values(other, {10, 11, 15, 16, 17, 18, 19});
+
+    EXPECT_EQ(dlist_get_iter_index(tail_iter), 12);
+    EXPECT_EQ(* (int *)iter_get_value(moved_iter), 13);
+    EXPECT_EQ(dlist_get_iter_index(moved_iter), 6);
+    EXPECT_EQ(* (int *)dlist_get_iter_next(moved_iter), 14);
+    EXPECT_EQ(dlist_get_iter_index(kept_iter), 6);
+    EXPECT_EQ(* (int *)iter_get_value(kept_iter), 19);
+
+    int target = 13;
+    EXPECT_TRUE(dlist_value_in_dlist(dlist, &target));
+    EXPECT_FALSE(dlist_value_in_dlist(other, &target));
+    target = 16;
+    EXPECT_FALSE(dlist_value_in_dlist(dlist, &target));
+    EXPECT_TRUE(dlist_value_in_dlist(other, &target));
+
+    // Invalid ranges leave both dlists alone
+    EXPECT_EQ(dlist_splice(dlist, 14, other, 0, 1), DLIST_FAIL);
+    EXPECT_EQ(dlist_splice(dlist, 0, other, 5, 3), DLIST_FAIL);
+    EXPECT_EQ(dlist_splice(dlist, 0, other, -1, 1), DLIST_FAIL);
+    EXPECT_EQ(dlist_splice(dlist, 0, dlist, 0, 1), DLIST_FAIL);
+    EXPECT_EQ(dlist_get_length(dlist), 13);
+    EXPECT_EQ(dlist_get_length(other), 7);
+
+    dlist_destroy_iter(tail_iter);
+    dlist_destroy_iter(moved_iter);
+    dlist_destroy_iter(kept_iter);
+    dlist_destroy(dlist);
+    dlist_destroy(other);
+    dlist_pool_destroy(pool);
+}
+
+TEST(dlist_splice_test, SplitAtSharesThePool)
+{
+    std::vector<int> values(10);
+    for (int i = 0; i < 10; i++)
+    {
+        values[(size_t)i] = i;
+    }
+    dlist_t * dlist = dlist_init_pooled(compare_ints, nullptr);
+    for (int & value : values)
+    {
+        dlist_append(dlist, &value);
+    }
+    EXPECT_EQ(dlist_set_hash_index(dlist, hash_int), DLIST_SUCC);
+
+    // Nodes of a private pool can not be moved to another dlist
+    dlist_t * other = init_range(nullptr, values, 0, 2);
+    EXPECT_EQ(dlist_concat(other, dlist), DLIST_FAIL);
+    EXPECT_EQ(dlist_split_at(dlist, 11), nullptr);
+
+    dlist_t * split = dlist_split_at(dlist, 6);
+    ASSERT_NE(split, nullptr);
+    expect_values(dlist, {0, 1, 2, 3, 4, 5});
+    expect_values(split, {6, 7, 8, 9});
+    int target = 8;
+    EXPECT_EQ(dlist_get_by_value(split, &target), &values[8]);
+    EXPECT_EQ(dlist_get_by_value(dlist, &target), nullptr);
+
+    // Both halves share the pool, so they can be joined back
+    EXPECT_EQ(dlist_concat(dlist, split), DLIST_SUCC);
+    expect_values(dlist, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+    dlist_destroy(split);
+    dlist_destroy(other);
+    dlist_destroy(dlist);
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include <dl_list.h>
+#include <algorithm>
+#include <random>
+#include <vector>
 
 dlist_match_t match_int_payloads(void * left, void * right)
 {
@@ -159,3 +162,138 @@ TEST_F(DListTestSortFixture, SortDescendingAdv)
 
     dlist_destroy_iter(iter);
 }
+
+/*
+ * Items with a key and their insertion order to check the sort is stable
+ */
+typedef struct
+{
+    int key;
+    int order;
+} keyed_item_t;
+
+dlist_compare_t compare_keyed_items(void * left, void * right)
+{
+    return compare_int_payloads(&((keyed_item_t *)left)->key,
+                                &((keyed_item_t *)right)->key);
+}
+
+// Count the comparisons to check that ordered input is sorted in one pass
+static size_t compare_count = 0;
+
+dlist_compare_t counting_compare(void * left, void * right)
+{
+    compare_count++;
+    return compare_int_payloads(left, right);
+}
+
+static std::vector<int> get_dlist_values(dlist_t * dlist)
+{
+    std::vector<int> values;
+    for (int32_t i = 0; i < (int32_t)dlist_get_length(dlist); i++)
+    {
+        values.push_back(* (int *)dlist_get_by_index(dlist, i));
+    }
+    return values;
+}
+
+// Sorted and reverse sorted lists are single runs and take n - 1 comparisons
+TEST(DListMergeSort, OrderedInputIsLinear)
+{
+    const int length = 100000;
+    std::vector<int> values(length);
+    dlist_t * ascending = dlist_init(match_int_payloads);
+    dlist_t * descending = dlist_init(match_int_payloads);
+    for (int i = 0; i < length; i++)
+    {
+        values[(size_t)i] = i;
+        dlist_append(ascending, &values[(size_t)i]);
+        dlist_prepend(descending, &values[(size_t)i]);
+    }
+
+    compare_count = 0;
+    dlist_merge_sort(ascending, ASCENDING, counting_compare);
+    EXPECT_EQ(compare_count, (size_t)length - 1);
+    compare_count = 0;
+    dlist_merge_sort(descending, ASCENDING, counting_compare);
+    EXPECT_EQ(compare_count, (size_t)length - 1);
+
+    for (int32_t i : {0, 1, length / 2, length - 1})
+    {
+        EXPECT_EQ(* (int *)dlist_get_by_index(ascending, i), i);
+        EXPECT_EQ(* (int *)dlist_get_by_index(descending, i), i);
+    }
+    EXPECT_EQ(* (int *)dlist_pop_tail(descending), length - 1);
+    EXPECT_EQ(* (int *)dlist_pop_head(descending), 0);
+    dlist_destroy(ascending);
+    dlist_destroy(descending);
+}
+
+TEST(DListMergeSort, RandomInputIsStable)
+{
+    std::mt19937 engine(6);
+    std::vector<keyed_item_t> items(5000);
+    dlist_t * dlist = dlist_init(nullptr);
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        items[i] = {(int)(engine() % 100), (int)i};
+        dlist_append(dlist, &items[i]);
+    }
+
+    for (sort_direction_t direction : {ASCENDING, DESCENDING})
+    {
+        // The orders come out increasing as the dlist starts in that order
+        std::stable_sort(items.begin(), items.end(),
+                         [direction](const keyed_item_t & l,
+                                     const keyed_item_t & r) {
+                             return (ASCENDING == direction) ? l.key < r.key
+                                                             : l.key > r.key;
+                         });
+        dlist_merge_sort(dlist, direction, compare_keyed_items);
+
+        dlist_iter_t * iter = dlist_get_iterable(dlist, ITER_HEAD);
+        for (keyed_item_t & item : items)
+        {
+            keyed_item_t * value = (keyed_item_t *)iter_get_value(iter);
+            ASSERT_EQ(value->key, item.key);
+            ASSERT_EQ(value->order, item.order);
+            dlist_get_iter_next(iter);
+        }
+        EXPECT_EQ(iter_get_value(iter), nullptr);
+        dlist_destroy_iter(iter);
+
+        // Walking back from the tail checks the prev links
+        iter = dlist_get_iterable(dlist, ITER_TAIL);
+        for (auto it = items.rbegin(); it != items.rend(); ++it)
+        {
+            ASSERT_EQ(((keyed_item_t *)iter_get_value(iter))->order, it->order);
+            dlist_get_iter_prev(iter);
+        }
+        dlist_destroy_iter(iter);
+
+        // Renumber so the next sort is checked for stability as well
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            items[i].order = (int)i;
+        }
+    }
+    dlist_destroy(dlist);
+}
+
+// Iters keep their index and see the value sorted into it
+TEST_F(DListTestSortFixture, ItersKeepTheirIndex)
+{
+    dlist_iter_t * head = dlist_get_iterable(dlist2, ITER_HEAD);
+    dlist_iter_t * third = dlist_get_iterable(dlist2, ITER_HEAD);
+    dlist_get_iter_next(third);
+    dlist_get_iter_next(third);
+
+    dlist_merge_sort(dlist2, ASCENDING, compare_int_payloads);
+    std::sort(this->test_array2.begin(), this->test_array2.end());
+    EXPECT_EQ(get_dlist_values(dlist2), this->test_array2);
+    EXPECT_EQ(* (int *)iter_get_value(head), this->test_array2[0]);
+    EXPECT_EQ(* (int *)iter_get_value(third), this->test_array2[2]);
+    EXPECT_EQ(* (int *)dlist_get_iter_next(third), this->test_array2[3]);
+    dlist_destroy_iter(head);
+    dlist_destroy_iter(third);
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <dl_ulist.h>
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+dlist_match_t match_ints(void * data1, void * data2)
+{
+    if (* (int *)data1 == * (int *)data2)
+    {
+        return DLIST_MATCH;
+    }
+    return DLIST_MISS_MATCH;
+}
+
+static std::vector<int> get_ulist_values(ulist_t * ulist)
+{
+    std::vector<int> values;
+    ulist_iter_t iter;
+    ulist_iter_init(ulist, &iter, ITER_HEAD);
+    for (int * value = (int *)ulist_iter_next(&iter); nullptr != value;
+         value = (int *)ulist_iter_next(&iter))
+    {
+        values.push_back(* value);
+    }
+    return values;
+}
+
+TEST(UListTest, HeadAndTailOperations)
+{
+    ulist_t * ulist = ulist_init(match_ints);
+    ASSERT_NE(ulist, nullptr);
+    EXPECT_TRUE(ulist_is_empty(ulist));
+    EXPECT_EQ(ulist_pop_head(ulist), nullptr);
+    EXPECT_EQ(ulist_pop_tail(ulist), nullptr);
+
+    std::vector<int> values(200);
+    std::deque<int> expected;
+    for (int i = 0; i < 100; i++)
+    {
+        values[(size_t)i] = i;
+        values[(size_t)i + 100] = i + 100;
+        ulist_append(ulist, &values[(size_t)i + 100]);
+        ulist_prepend(ulist, &values[(size_t)i]);
+        expected.push_back(i + 100);
+        expected.push_front(i);
+    }
+    EXPECT_EQ(ulist_get_length(ulist), 200);
+    EXPECT_EQ(get_ulist_values(ulist),
+              std::vector<int>(expected.begin(), expected.end()));
+
+    // Walk back from the tail
+    ulist_iter_t iter;
+    ulist_iter_init(ulist, &iter, ITER_TAIL);
+    for (auto it = expected.rbegin(); it != expected.rend(); ++it)
+    {
+        ASSERT_EQ(* (int *)ulist_iter_prev(&iter), * it);
+    }
+    EXPECT_EQ(ulist_iter_prev(&iter), nullptr);
+
+    EXPECT_EQ(* (int *)ulist_pop_head(ulist), 99);
+    EXPECT_EQ(* (int *)ulist_pop_tail(ulist), 199);
+    EXPECT_EQ(* (int *)ulist_get_by_index(ulist, 0), 98);
+    EXPECT_EQ(* (int *)ulist_get_by_index(ulist, -1), 198);
+    EXPECT_EQ(ulist_get_by_index(ulist, 198), nullptr);
+    EXPECT_EQ(ulist_get_by_index(ulist, -199), nullptr);
+    ulist_destroy(ulist);
+}
+
+TEST(UListTest, RandomOperationsMatchDeque)
+{
+    std::mt19937 engine(5);
+    std::vector<int> values(4096);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        values[i] = (int)i;
+    }
+
+    ulist_t * ulist = ulist_init(match_ints);
+    std::deque<int> expected;
+    for (int step = 0; step < 20000; step++)
+    {
+        int * value = &values[engine() % values.size()];
+        int32_t length = (int32_t)expected.size();
+        switch (engine() % 7)
+        {
+            case 0:
+                ulist_append(ulist, value);
+                expected.push_back(* value);
+                break;
+            case 1:
+                ulist_prepend(ulist, value);
+                expected.push_front(* value);
+                break;
+            case 2:
+            case 3:
+            {
+                int32_t index = (0 == length) ? 0 : (int32_t)(engine() % (uint32_t)length);
+                ASSERT_EQ(ulist_insert(ulist, value, index), DLIST_SUCC);
+                expected.insert(expected.begin() + index, * value);
+                break;
+            }
+            case 4:
+            {
+                int * removed = (int *)ulist_remove_value(ulist, value);
+                auto it = std::find(expected.begin(), expected.end(), * value);
+                if (it == expected.end())
+                {
+                    ASSERT_EQ(removed, nullptr);
+                }
+                else
+                {
+                    ASSERT_EQ(* removed, * value);
+                    expected.erase(it);
+                }
+                break;
+            }
+            case 5:
+                if (!expected.empty())
+                {
+                    ASSERT_EQ(* (int *)ulist_pop_head(ulist), expected.front());
+                    expected.pop_front();
+                }
+                break;
+            default:
+                if (!expected.empty())
+                {
+                    ASSERT_EQ(* (int *)ulist_pop_tail(ulist), expected.back());
+                    expected.pop_back();
+                }
+                break;
+        }
+
+        ASSERT_EQ(ulist_get_length(ulist), expected.size());
+        if (!expected.empty())
+        {
+            size_t index = engine() % expected.size();
+            ASSERT_EQ(* (int *)ulist_get_by_index(ulist, (int32_t)index),
+                      expected[index]);
+        }
+    }
+    EXPECT_EQ(get_ulist_values(ulist),
+              std::vector<int>(expected.begin(), expected.end()));
+    EXPECT_EQ(ulist_insert(ulist, &values[0], (int32_t)expected.size() + 1),
+              DLIST_FAIL);
+    ulist_destroy(ulist);
+}
+
+TEST(UListTest, SearchAndDestroyFree)
+{
+    ulist_t * ulist = ulist_init(match_ints);
+    for (int i = 0; i < 1000; i++)
+    {
+        int * value = (int *)malloc(sizeof(int));
+        * value = i;
+        ulist_append(ulist, value);
+    }
+
+    int target = 700;
+    EXPECT_TRUE(ulist_value_in_ulist(ulist, &target));
+    EXPECT_EQ(* (int *)ulist_get_by_value(ulist, &target), 700);
+    free(ulist_remove_value(ulist, &target));
+    EXPECT_FALSE(ulist_value_in_ulist(ulist, &target));
+    EXPECT_EQ(* (int *)ulist_get_by_index(ulist, 700), 701);
+    ulist_destroy_free(ulist, free);
+}
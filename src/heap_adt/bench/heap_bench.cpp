@@ -0,0 +1,265 @@
+/*
+ * Compares the generic heap_t against the heaps specialized at compile time
+ * with HEAP_DECLARE and heap_adt::heap. Each workload pushes N random keys and
+ * then pops all of them, followed by a mixed workload that keeps the heap at
+ * N items while alternating a pop and a push.
+ *
+ * The pointer workloads store one cache line sized record per key and
+ * compare HEAP_PTR, which reads the key through every pointer, against a
+ * keyed heap that caches the key next to the pointer.
+ *
+ * Usage: heap_bench [item_count]
+ */
+#include <heap.h>
+#include <heap_typed.h>
+#include <heap.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <vector>
+
+#define U32_LESS(left, right) ((left) < (right))
+
+HEAP_DECLARE(u32_heap, uint32_t, U32_LESS)
+
+/*
+ * Sum of the popped keys, printed so the compiler can not drop the work
+ */
+static uint64_t checksum = 0;
+
+static heap_compare_t u32_compare(void * payload, void * payload2)
+{
+    uint32_t left = * (uint32_t *)payload;
+    uint32_t right = * (uint32_t *)payload2;
+    if (left > right)
+    {
+        return HEAP_GT;
+    }
+    else if (left < right)
+    {
+        return HEAP_LT;
+    }
+    return HEAP_EQ;
+}
+
+/*
+ * Record stored by pointer, padded so every record sits on its own line
+ */
+typedef struct
+{
+    uint32_t key;
+    uint8_t padding[60];
+} record_t;
+
+static heap_compare_t record_compare(void * payload, void * payload2)
+{
+    return u32_compare(&((record_t *)payload)->key,
+                       &((record_t *)payload2)->key);
+}
+
+static heap_key_t record_key(void * payload)
+{
+    heap_key_t key;
+    key.u64 = ((record_t *)payload)->key;
+    return key;
+}
+
+template <typename Func>
+static double time_ns(Func func)
+{
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+static void report(const char * name, double push_pop_ns, double mixed_ns,
+                   size_t count)
+{
+    double operations = (double)count * 2;
+    printf("%-24s push+pop %8.2f ns/op    mixed %8.2f ns/op\n",
+           name, push_pop_ns / operations, mixed_ns / operations);
+}
+
+static void bench_generic(const std::vector<uint32_t> & keys,
+                          heap_arity_t arity, const char * name)
+{
+    size_t count = keys.size();
+    heap_t * heap = heap_init(MIN_HEAP, HEAP_MEM, sizeof(uint32_t), NULL,
+                              u32_compare, arity);
+    uint32_t value = 0;
+
+    double push_pop = time_ns([&]() {
+        for (uint32_t key : keys)
+        {
+            heap_insert(heap, (void *)&key);
+        }
+        while (HEAP_SUCCESS == heap_pop_into(heap, &value))
+        {
+            checksum += value;
+        }
+    });
+
+    for (uint32_t key : keys)
+    {
+        heap_insert(heap, (void *)&key);
+    }
+    double mixed = time_ns([&]() {
+        for (uint32_t key : keys)
+        {
+            heap_pop_into(heap, &value);
+            checksum += value;
+            uint32_t next = value + key;
+            heap_insert(heap, (void *)&next);
+        }
+    });
+    heap_destroy(heap);
+    report(name, push_pop, mixed, count);
+}
+
+static void bench_pointer(const std::vector<uint32_t> & keys, bool is_keyed,
+                          const char * name)
+{
+    size_t count = keys.size();
+    std::vector<record_t> records(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        records[i].key = keys[i];
+    }
+    heap_t * heap = is_keyed
+                    ? heap_init_keyed(MIN_HEAP, HEAP_KEY_U64, record_key, NULL,
+                                      NULL, HEAP_4_ARY)
+                    : heap_init(MIN_HEAP, HEAP_PTR, 0, NULL, record_compare,
+                                HEAP_4_ARY);
+    record_t * record = NULL;
+
+    double push_pop = time_ns([&]() {
+        for (record_t & item : records)
+        {
+            heap_insert(heap, &item);
+        }
+        while (HEAP_SUCCESS == heap_pop_into(heap, &record))
+        {
+            checksum += record->key;
+        }
+    });
+
+    for (record_t & item : records)
+    {
+        heap_insert(heap, &item);
+    }
+    double mixed = time_ns([&]() {
+        for (uint32_t key : keys)
+        {
+            heap_pop_into(heap, &record);
+            checksum += record->key;
+            record->key += key;
+            heap_insert(heap, record);
+        }
+    });
+    heap_destroy(heap);
+    report(name, push_pop, mixed, count);
+}
+
+static void bench_declare(const std::vector<uint32_t> & keys)
+{
+    size_t count = keys.size();
+    u32_heap_t heap;
+    u32_heap_init(&heap);
+    uint32_t value = 0;
+
+    double push_pop = time_ns([&]() {
+        for (uint32_t key : keys)
+        {
+            u32_heap_insert(&heap, key);
+        }
+        while (u32_heap_pop(&heap, &value))
+        {
+            checksum += value;
+        }
+    });
+
+    for (uint32_t key : keys)
+    {
+        u32_heap_insert(&heap, key);
+    }
+    double mixed = time_ns([&]() {
+        for (uint32_t key : keys)
+        {
+            u32_heap_pop(&heap, &value);
+            checksum += value;
+            u32_heap_insert(&heap, value + key);
+        }
+    });
+    u32_heap_destroy(&heap);
+    report("HEAP_DECLARE", push_pop, mixed, count);
+}
+
+template <typename Heap>
+static void bench_template(const std::vector<uint32_t> & keys,
+                           const char * name)
+{
+    size_t count = keys.size();
+    Heap heap;
+
+    double push_pop = time_ns([&]() {
+        for (uint32_t key : keys)
+        {
+            heap.push(key);
+        }
+        while (!heap.empty())
+        {
+            checksum += heap.top();
+            heap.pop();
+        }
+    });
+
+    for (uint32_t key : keys)
+    {
+        heap.push(key);
+    }
+    double mixed = time_ns([&]() {
+        for (uint32_t key : keys)
+        {
+            uint32_t value = heap.top();
+            heap.pop();
+            checksum += value;
+            heap.push(value + key);
+        }
+    });
+    report(name, push_pop, mixed, count);
+}
+
+int main(int argc, char ** argv)
+{
+    size_t count = 1000000;
+    if (argc > 1)
+    {
+        count = strtoul(argv[1], NULL, 10);
+    }
+
+    std::mt19937 engine(1234);
+    std::vector<uint32_t> keys(count);
+    for (uint32_t & key : keys)
+    {
+        key = engine() >> 8;
+    }
+
+    printf("%zu uint32_t keys, min heap\n", count);
+    bench_generic(keys, HEAP_BINARY, "heap_t binary");
+    bench_generic(keys, HEAP_4_ARY, "heap_t 4-ary");
+    bench_declare(keys);
+    bench_template<heap_adt::heap<uint32_t>>(keys, "heap_adt::heap");
+    bench_template<std::priority_queue<uint32_t, std::vector<uint32_t>,
+                                       std::greater<uint32_t>>>(
+        keys, "std::priority_queue");
+
+    printf("%zu record_t pointers, min heap\n", count);
+    bench_pointer(keys, false, "heap_t 4-ary HEAP_PTR");
+    bench_pointer(keys, true, "heap_t 4-ary keyed");
+    printf("checksum %llu\n", (unsigned long long)checksum);
+    return 0;
+}
@@ -7,6 +7,7 @@ extern "C" {
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // Compare functions must implement the following return types
 typedef enum
@@ -30,20 +31,125 @@ typedef enum
     HEAP_MEM
 } heap_data_mode_t;
 
+// Number of children of each node in the heap
+typedef enum
+{
+    HEAP_BINARY = 2,
+    HEAP_4_ARY = 4,
+    HEAP_8_ARY = 8
+} heap_arity_t;
+
+// Controls if an array passed to the heap is copied or owned by the heap
+typedef enum
+{
+    HEAP_COPY,
+    HEAP_ADOPT
+} heap_ownership_t;
+
+// Controls if the array of a heap shrinks as items are removed
+typedef enum
+{
+    HEAP_SHRINK_HYSTERESIS,
+    HEAP_SHRINK_NEVER
+} heap_shrink_policy_t;
+
+// Result of the operations that copy data out of the heap
+typedef enum
+{
+    HEAP_SUCCESS,
+    HEAP_FAILURE
+} heap_result_t;
+
+// Type of the key cached next to each pointer of a keyed heap
+typedef enum
+{
+    HEAP_KEY_NONE,
+    HEAP_KEY_U64,
+    HEAP_KEY_DOUBLE
+} heap_key_type_t;
+
+// Key extracted from a payload once when it is inserted into a keyed heap
+typedef union
+{
+    uint64_t u64;
+    double f64;
+} heap_key_t;
+
+// Operation counters of a heap, see heap_get_stats
+typedef struct
+{
+    uint64_t compares;              // Calls to the compare callback or keys
+    uint64_t swaps;                 // Nodes swapped while sifting
+    uint64_t resizes;               // Reallocations of the array
+    size_t peak_length;             // Most items held at once
+} heap_stats_t;
+
+// Stable reference to an item of an indexed heap. The lower 32 bits are the
+// slot of the handle and the upper 32 bits its generation, so a handle kept
+// after its item left the heap never matches the item that reuses the slot.
+typedef uint64_t heap_handle_t;
+#define HEAP_INVALID_HANDLE UINT64_MAX
+
 // Mapping to internal structure that manages the heap_adt
 typedef struct heap_t heap_t;
 
+// Bounded accumulator keeping the best k items pushed into it
+typedef struct heap_top_k_t heap_top_k_t;
+
 void heap_print(heap_t * heap, void (* print_test)(void * payload));
 
 heap_t * heap_init(heap_type_t type,
                    heap_data_mode_t data_mode,
                    size_t payload_size,
                    void (* destroy)(void *),
-                   heap_compare_t (* compare)(void *, void *));
+                   heap_compare_t (* compare)(void *, void *),
+                   heap_arity_t arity);
+
+heap_t * heap_init_from_array(heap_type_t type,
+                              heap_data_mode_t data_mode,
+                              size_t payload_size,
+                              void (* destroy)(void *),
+                              heap_compare_t (* compare)(void *, void *),
+                              void * array,
+                              size_t item_count,
+                              heap_ownership_t ownership,
+                              heap_arity_t arity);
+
+heap_t * heap_init_indexed(heap_type_t type,
+                           heap_data_mode_t data_mode,
+                           size_t payload_size,
+                           void (* destroy)(void *),
+                           heap_compare_t (* compare)(void *, void *),
+                           heap_arity_t arity);
+
+heap_t * heap_init_keyed(heap_type_t type,
+                         heap_key_type_t key_type,
+                         heap_key_t (* key)(void *),
+                         void (* destroy)(void *),
+                         heap_compare_t (* compare)(void *, void *),
+                         heap_arity_t arity);
 
 void heap_destroy(heap_t * heap);
-void heap_insert(heap_t * heap, void * payload);
+heap_result_t heap_reserve(heap_t * heap, size_t capacity);
+heap_result_t heap_shrink_to_fit(heap_t * heap);
+void heap_set_growth_policy(heap_t * heap,
+                            double growth_factor,
+                            heap_shrink_policy_t shrink_policy);
+size_t heap_capacity(heap_t * heap);
+heap_result_t heap_get_stats(heap_t * heap, heap_stats_t * stats);
+void heap_reset_stats(heap_t * heap);
+heap_result_t heap_insert(heap_t * heap, void * payload);
+heap_handle_t heap_insert_handle(heap_t * heap, void * payload);
+bool heap_contains(heap_t * heap, heap_handle_t handle);
+void * heap_handle_ref(heap_t * heap, heap_handle_t handle);
+heap_result_t heap_update_priority(heap_t * heap,
+                                   heap_handle_t handle,
+                                   void * payload);
+heap_result_t heap_remove(heap_t * heap, heap_handle_t handle, void * out);
 void * heap_pop(heap_t * heap);
+heap_result_t heap_pop_into(heap_t * heap, void * out);
+void * heap_peek_ref(heap_t * heap);
+heap_result_t heap_replace_root(heap_t * heap, void * payload, void * out);
 
 void heap_sort(void * array,
                size_t item_count,
@@ -51,6 +157,13 @@ void heap_sort(void * array,
                heap_data_mode_t data_mode,
                heap_type_t type,
                heap_compare_t (* compare)(void *, void *));
+heap_result_t heap_sort_parallel(void * array,
+                                 size_t item_count,
+                                 size_t item_size,
+                                 heap_data_mode_t data_mode,
+                                 heap_type_t type,
+                                 heap_compare_t (* compare)(void *, void *),
+                                 size_t thread_count);
 
 bool heap_in_heap(heap_t * heap, void * data);
 
@@ -67,6 +180,36 @@ void * heap_find_nth_item(void * array,
                           heap_type_t type,
                           heap_compare_t (* compare)(void *, void *));
 
+heap_result_t heap_select_nth(void * array,
+                              size_t item_count,
+                              size_t item_size,
+                              size_t nth_item,
+                              heap_data_mode_t data_mode,
+                              heap_type_t type,
+                              heap_compare_t (* compare)(void *, void *),
+                              void * out);
+
+size_t heap_top_k(void * array,
+                  size_t item_count,
+                  size_t item_size,
+                  size_t k,
+                  heap_data_mode_t data_mode,
+                  heap_type_t type,
+                  heap_compare_t (* compare)(void *, void *),
+                  void * out_array);
+
+heap_top_k_t * heap_top_k_init(size_t k,
+                               heap_type_t type,
+                               heap_data_mode_t data_mode,
+                               size_t payload_size,
+                               void (* destroy)(void *),
+                               heap_compare_t (* compare)(void *, void *));
+void heap_top_k_destroy(heap_top_k_t * top_k);
+void heap_top_k_push(heap_top_k_t * top_k, void * payload);
+size_t heap_top_k_length(heap_top_k_t * top_k);
+void * heap_top_k_peek_ref(heap_top_k_t * top_k);
+size_t heap_top_k_drain(heap_top_k_t * top_k, void * out_array);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -0,0 +1,155 @@
+#ifndef HEAP_HPP
+#define HEAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace heap_adt
+{
+
+/*!
+ * @brief Binary heap specialized for T at compile time.
+ *
+ * The C++ counterpart of HEAP_DECLARE. Compare(a, b) returns true if a belongs
+ * closer to the root, so the default std::less<T> creates a min heap and
+ * std::greater<T> creates a max heap. Note that this is the opposite of
+ * std::priority_queue, which keeps the largest item on top for std::less.
+ */
+template <typename T, typename Compare = std::less<T>>
+class heap
+{
+public:
+    heap() = default;
+
+    explicit heap(Compare compare) : compare_(std::move(compare))
+    {
+    }
+
+    /*!
+     * @brief Build the heap from the items in O(n)
+     */
+    explicit heap(std::vector<T> items, Compare compare = Compare())
+        : items_(std::move(items)), compare_(std::move(compare))
+    {
+        for (std::size_t index = items_.size() / 2; index-- > 0;)
+        {
+            sift_down(index);
+        }
+    }
+
+    bool empty() const
+    {
+        return items_.empty();
+    }
+
+    std::size_t size() const
+    {
+        return items_.size();
+    }
+
+    void reserve(std::size_t count)
+    {
+        items_.reserve(count);
+    }
+
+    /*!
+     * @brief Return a reference to the root. The heap must not be empty.
+     */
+    const T & top() const
+    {
+        return items_.front();
+    }
+
+    void push(T item)
+    {
+        std::size_t index = items_.size();
+        items_.push_back(std::move(item));
+        sift_up(index);
+    }
+
+    template <typename... Args>
+    void emplace(Args &&... args)
+    {
+        std::size_t index = items_.size();
+        items_.emplace_back(std::forward<Args>(args)...);
+        sift_up(index);
+    }
+
+    /*!
+     * @brief Remove the root and return it, or std::nullopt if empty
+     */
+    std::optional<T> pop()
+    {
+        if (items_.empty())
+        {
+            return std::nullopt;
+        }
+
+        T result = std::move(items_.front());
+        T last = std::move(items_.back());
+        items_.pop_back();
+        if (!items_.empty())
+        {
+            items_.front() = std::move(last);
+            sift_down(0);
+        }
+        return result;
+    }
+
+    void clear()
+    {
+        items_.clear();
+    }
+
+private:
+    // Move the parents down into the hole instead of swapping
+    void sift_up(std::size_t index)
+    {
+        T item = std::move(items_[index]);
+        while (index > 0)
+        {
+            std::size_t parent_index = (index - 1) / 2;
+            if (!compare_(item, items_[parent_index]))
+            {
+                break;
+            }
+            items_[index] = std::move(items_[parent_index]);
+            index = parent_index;
+        }
+        items_[index] = std::move(item);
+    }
+
+    // Move the best child up into the hole until the item fits
+    void sift_down(std::size_t index)
+    {
+        std::size_t length = items_.size();
+        T item = std::move(items_[index]);
+        std::size_t child_index = (index * 2) + 1;
+        while (child_index < length)
+        {
+            if ((child_index + 1 < length)
+                && compare_(items_[child_index + 1], items_[child_index]))
+            {
+                child_index++;
+            }
+            if (!compare_(items_[child_index], item))
+            {
+                break;
+            }
+            items_[index] = std::move(items_[child_index]);
+            index = child_index;
+            child_index = (index * 2) + 1;
+        }
+        items_[index] = std::move(item);
+    }
+
+    std::vector<T> items_;
+    Compare compare_;
+};
+
+} // namespace heap_adt
+
+#endif //HEAP_HPP
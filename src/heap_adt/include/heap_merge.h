@@ -0,0 +1,42 @@
+#ifndef HEAP_MERGE_H
+#define HEAP_MERGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <heap.h>
+#include <stddef.h>
+
+/*
+ * Streaming k-way merge of sorted runs. The merge only holds one cursor per
+ * run, so the memory used is O(k) no matter how many items the runs hold.
+ */
+typedef struct heap_merge_t heap_merge_t;
+
+/*
+ * Producer of the items of a run. The function writes the next item of the
+ * run into out, the item itself in HEAP_MEM mode or the pointer in HEAP_PTR
+ * mode, and returns HEAP_SUCCESS. It returns HEAP_FAILURE once the run has
+ * no items left.
+ */
+typedef heap_result_t (* heap_run_next_t)(void * context, void * out);
+
+heap_merge_t * heap_merge_init(heap_type_t type,
+                               heap_data_mode_t data_mode,
+                               size_t payload_size,
+                               heap_compare_t (* compare)(void *, void *));
+void heap_merge_destroy(heap_merge_t * merge);
+heap_result_t heap_merge_add_array(heap_merge_t * merge,
+                                   void * array,
+                                   size_t item_count);
+heap_result_t heap_merge_add_source(heap_merge_t * merge,
+                                    heap_run_next_t next,
+                                    void * context);
+heap_result_t heap_merge_next(heap_merge_t * merge, void * out);
+bool heap_merge_is_empty(heap_merge_t * merge);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+#endif //HEAP_MERGE_H
@@ -0,0 +1,152 @@
+#ifndef HEAP_TYPED_H
+#define HEAP_TYPED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/*
+ * HEAP_DECLARE generates a binary heap specialized for a single item type.
+ *
+ * The generic heap_t calls the compare function through a pointer and moves
+ * the nodes with memcpy of a runtime size. The generated heap stores the items
+ * in a plain array of the type and compares them with the "before" expression,
+ * so the compiler can inline the comparison and move the items with fixed
+ * size assignments.
+ *
+ * "before" is a function or function like macro taking two items by value and
+ * returning true if the first item belongs closer to the root. A "less than"
+ * creates a min heap and a "greater than" creates a max heap.
+ *
+ *      #define INT_LESS(left, right) ((left) < (right))
+ *      HEAP_DECLARE(int_heap, int, INT_LESS)
+ *
+ *      int_heap_t heap;
+ *      int_heap_init(&heap);
+ *      int_heap_insert(&heap, 5);
+ *      int value;
+ *      while (int_heap_pop(&heap, &value)) { ... }
+ *      int_heap_destroy(&heap);
+ *
+ * The generated functions are static inline so the macro can be used in a
+ * header or in the translation unit that needs the heap.
+ */
+#define HEAP_TYPED_BASE_SIZE 8
+
+#define HEAP_DECLARE(name, type, before)                                       \
+                                                                               \
+typedef struct                                                                 \
+{                                                                              \
+    type * items;                                                              \
+    size_t length;                                                             \
+    size_t size;                                                               \
+} name##_t;                                                                    \
+                                                                               \
+static inline bool name##_init(name##_t * heap)                                \
+{                                                                              \
+    heap->length = 0;                                                          \
+    heap->size = HEAP_TYPED_BASE_SIZE;                                         \
+    heap->items = (type *)malloc(sizeof(type) * heap->size);                   \
+    return NULL != heap->items;                                                \
+}                                                                              \
+                                                                               \
+static inline void name##_destroy(name##_t * heap)                             \
+{                                                                              \
+    free(heap->items);                                                         \
+    heap->items = NULL;                                                        \
+    heap->length = 0;                                                          \
+    heap->size = 0;                                                            \
+}                                                                              \
+                                                                               \
+static inline size_t name##_length(const name##_t * heap)                      \
+{                                                                              \
+    return heap->length;                                                       \
+}                                                                              \
+                                                                               \
+static inline bool name##_is_empty(const name##_t * heap)                      \
+{                                                                              \
+    return 0 == heap->length;                                                  \
+}                                                                              \
+                                                                               \
+static inline type * name##_peek(name##_t * heap)                              \
+{                                                                              \
+    return (0 == heap->length) ? NULL : &heap->items[0];                       \
+}                                                                              \
+                                                                               \
+static inline bool name##_insert(name##_t * heap, type item)                   \
+{                                                                              \
+    if (heap->length == heap->size)                                            \
+    {                                                                          \
+        type * re_alloc = (type *)realloc(heap->items,                         \
+                                          sizeof(type) * heap->size * 2);      \
+        if (NULL == re_alloc)                                                  \
+        {                                                                      \
+            return false;                                                      \
+        }                                                                      \
+        heap->items = re_alloc;                                                \
+        heap->size = heap->size * 2;                                           \
+    }                                                                          \
+                                                                               \
+    /* Move the parents down into the hole instead of swapping */             \
+    size_t index = heap->length;                                               \
+    heap->length++;                                                            \
+    while (index > 0)                                                          \
+    {                                                                          \
+        size_t parent_index = (index - 1) / 2;                                 \
+        if (!(before(item, heap->items[parent_index])))                        \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+        heap->items[index] = heap->items[parent_index];                        \
+        index = parent_index;                                                  \
+    }                                                                          \
+    heap->items[index] = item;                                                 \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline bool name##_pop(name##_t * heap, type * out)                     \
+{                                                                              \
+    if (0 == heap->length)                                                     \
+    {                                                                          \
+        return false;                                                          \
+    }                                                                          \
+                                                                               \
+    * out = heap->items[0];                                                    \
+    heap->length--;                                                            \
+    if (0 == heap->length)                                                     \
+    {                                                                          \
+        return true;                                                           \
+    }                                                                          \
+                                                                               \
+    /* Move the best child up into the hole until the last item fits */       \
+    type item = heap->items[heap->length];                                     \
+    size_t index = 0;                                                          \
+    size_t child_index = 1;                                                    \
+    while (child_index < heap->length)                                         \
+    {                                                                          \
+        if ((child_index + 1 < heap->length)                                   \
+            && (before(heap->items[child_index + 1],                           \
+                       heap->items[child_index])))                             \
+        {                                                                      \
+            child_index++;                                                     \
+        }                                                                      \
+        if (!(before(heap->items[child_index], item)))                         \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+        heap->items[index] = heap->items[child_index];                         \
+        index = child_index;                                                   \
+        child_index = (index * 2) + 1;                                         \
+    }                                                                          \
+    heap->items[index] = item;                                                 \
+    return true;                                                               \
+}
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+#endif //HEAP_TYPED_H
@@ -7,9 +7,30 @@
 
 typedef enum
 {
-    BASE_SIZE = 5,
+    BASE_SIZE = 8,
+    SWAP_CHUNK = 64,
+    SELECT_HEAP_MAX = 1024,
+    SELECT_SMALL_RANGE = 16,
 } heap_default_t;
 
+#define DEFAULT_GROWTH_FACTOR 2.0
+
+// The counters are compiled in with HEAP_STATS, otherwise they cost nothing
+#ifdef HEAP_STATS
+#define STATS_ADD(heap, counter) ((heap)->stats.counter++)
+#define STATS_PEAK(heap)                                                     \
+    do                                                                       \
+    {                                                                        \
+        if ((heap)->array_length > (heap)->stats.peak_length)                \
+        {                                                                    \
+            (heap)->stats.peak_length = (heap)->array_length;                \
+        }                                                                    \
+    } while (0)
+#else
+#define STATS_ADD(heap, counter) ((void)0)
+#define STATS_PEAK(heap) ((void)0)
+#endif // HEAP_STATS
+
 // Enum for determining if malloc calls were valid
 typedef enum
 {
@@ -22,39 +43,99 @@ typedef struct heap_t
     size_t array_length;            // Number of active nodes in the array
     size_t array_size;              // Physical size of the array
     size_t node_size;               // Size of each node in the array
+    size_t arity;                   // Number of children of each node
+    size_t min_size;                // Size the array never shrinks below
+    double growth_factor;           // Multiplier applied to a full array
+    heap_shrink_policy_t shrink_policy;
     heap_data_mode_t data_mode;     // Mode being pointer mode or data mode
 
     heap_compare_t heap_type;
     void ** heap_array;
     heap_compare_t (* compare)(void * payload, void * payload2);
     void (* destroy)(void * payload);
+
+    // Only allocated for indexed heaps. The two arrays map back and forth
+    // between the handle slots and the index of their node in the heap_array.
+    size_t * slot_handles;          // Index in heap_array to its handle slot
+    size_t * handle_positions;      // Handle slot to index in heap_array
+    uint32_t * handle_generations;  // Bumped every time a slot is released
+    size_t handle_count;            // Number of slots ever handed out
+    size_t handle_size;             // Physical size of the slot arrays
+    size_t free_handle;             // Head of the released slots or SIZE_MAX
+
+    // Only set for keyed heaps. Each cell is a heap_key_slot_t holding the
+    // key of the payload next to its pointer.
+    heap_key_type_t key_type;
+    heap_key_t (* key)(void * payload);
+
+#ifdef HEAP_STATS
+    heap_stats_t stats;
+#endif // HEAP_STATS
 } heap_t;
 
-static void ensure_space(heap_t * heap);
-static void ensure_downgrade_size(heap_t * heap);
-static void resize_heap(heap_t * heap);
+// Cell of a keyed heap
+typedef struct heap_key_slot_t
+{
+    heap_key_t key;
+    void * payload;
+} heap_key_slot_t;
+
+// Bounded heap that only keeps the best k items that were pushed into it
+typedef struct heap_top_k_t
+{
+    heap_t * heap;                  // Heap of the opposite type of the request
+    size_t k;                       // Max number of items kept
+} heap_top_k_t;
 
-static void bubble_up(heap_t * heap);
-static void bubble_down(heap_t * heap);
+static void ensure_downgrade_size(heap_t * heap);
+static void resize_heap(heap_t * heap, size_t array_size);
+static heap_result_t set_capacity(heap_t * heap, size_t array_size);
+static size_t get_grown_size(heap_t * heap);
+
+static void bubble_up(heap_t * heap, size_t index);
+static void bubble_down(heap_t * heap, size_t parent_index);
+static void restore_order(heap_t * heap, size_t index);
+static heap_result_t insert_node(heap_t * heap,
+                                 void * payload,
+                                 heap_handle_t * handle);
+static void remove_at(heap_t * heap, size_t index);
+static void heapify(heap_t * heap);
+static void sort_heap(heap_t * heap);
+static bool is_kept(heap_t * heap, void * payload);
+static void replace_root(heap_t * heap, void * payload);
+static void copy_out(heap_t * heap, size_t index, void * out);
+static void write_node(heap_t * heap, size_t index, void * payload);
+static void introselect(heap_t * heap, size_t target_index, heap_type_t type);
+static size_t get_median_of_three(heap_t * heap, size_t low, size_t high);
+static heap_compare_t get_inverse_type(heap_type_t type);
 static void swap(heap_t * heap, size_t child_index, size_t parent_index);
 
-static size_t get_parent_index(size_t index);
-static size_t get_left_child_index(size_t index);
-static size_t get_right_child_index(size_t index);
+static size_t get_parent_index(heap_t * heap, size_t index);
+static size_t get_first_child_index(heap_t * heap, size_t index);
 static size_t get_target_index(heap_t * heap, size_t parent_index);
 static size_t get_index(size_t index, size_t node_size);
-
-static bool is_valid_parent(heap_t * heap, size_t parent_index);
-static bool has_left_child(heap_t * heap, size_t index);
-static bool has_right_child(heap_t * heap, size_t index);
+static size_t get_slot_size(heap_t * heap);
 
 static uint8_t * get_slice(heap_t * heap, size_t index);
+static void * get_value(heap_t * heap, size_t index);
+static void * get_cell(heap_t * heap, size_t index);
 static heap_compare_t get_comparison(heap_t * heap,
                                      size_t left_index,
                                      size_t right_index);
+static heap_compare_t compare_keys(heap_t * heap,
+                                   heap_key_slot_t * left,
+                                   heap_key_slot_t * right);
 
 static heap_pointer_t verify_alloc(void * ptr);
 
+static heap_result_t reserve_handle(heap_t * heap);
+static heap_handle_t acquire_handle(heap_t * heap, size_t index);
+static void release_handle(heap_t * heap, size_t slot);
+static size_t get_handle_slot(heap_handle_t handle);
+static bool is_indexed(heap_t * heap);
+static bool is_keyed(heap_t * heap);
+static bool is_pointer_array(heap_t * heap);
+
 
 
 /*!
@@ -67,32 +148,43 @@ void heap_print(heap_t * heap, void (* print_test)(void * payload))
     assert(heap);
     for (size_t i = 0; i < heap->array_length; i++)
     {
-        print_test(heap->heap_array[i]);
+        print_test(get_value(heap, i));
     }
 }
 
 /*!
  * @brief Create the initial data structure for the heap_adt.
  *
- * The heap_adt data structure is an array that follows the rules of a binary tree.
- * But the data itself is stored in a array. The array can either be an array
- * of void pointers or an array of data.
+ * The heap_adt data structure is an array that follows the rules of a d-ary
+ * tree. But the data itself is stored in a array. The array can either be an
+ * array of void pointers or an array of data.
  *
  * The mode is selected by the data_mode parameter. HEAP_PTR creates an array
  * of void pointers while HEAP_MEM creates an array of the memory blocks
+ *
+ * The arity is the number of children of each node. A 4-ary or 8-ary heap is
+ * shallower than a binary heap and the children of a node are next to each
+ * other in the array, so a large heap of small items touches fewer cache
+ * lines when bubbling down at the cost of more comparisons per level.
  * @param type Heap type, max heap_adt or min heap_adt
  * @param data_mode Data storage strategy
  * @param payload_size The size of the payload. This can be 0 if using HEAP_PTR
  * @param destroy Pointer to function that frees the block of memory
  * @param compare Pointer to function that compares the nodes
+ * @param arity Number of children of each node
  * @return Pointer to heap_adt or NULL
  */
 heap_t * heap_init(heap_type_t type,
                    heap_data_mode_t data_mode,
                    size_t payload_size,
                    void (* destroy)(void *),
-                   heap_compare_t (* compare)(void *, void *))
+                   heap_compare_t (* compare)(void *, void *),
+                   heap_arity_t arity)
 {
+    assert((HEAP_BINARY == arity)
+           || (HEAP_4_ARY == arity)
+           || (HEAP_8_ARY == arity));
+
     // Allocate the space needed for creating the base structure
     heap_t * heap = (heap_t *)malloc(sizeof(heap_t));
     if (INVALID_PTR == verify_alloc((void *)heap))
@@ -105,6 +197,12 @@ heap_t * heap_init(heap_type_t type,
         .array_length       = 0,
         .array_size         = BASE_SIZE,
         .node_size          = payload_size,
+        .arity              = arity,
+        .min_size           = BASE_SIZE,
+
+        // Set the capacity policy
+        .growth_factor      = DEFAULT_GROWTH_FACTOR,
+        .shrink_policy      = HEAP_SHRINK_HYSTERESIS,
 
         // Set heap_adt type
         .heap_type          = type ? HEAP_LT : HEAP_GT,
@@ -138,6 +236,295 @@ heap_t * heap_init(heap_type_t type,
     return heap;
 }
 
+/*!
+ * @brief Create a heap from an existing array of items.
+ *
+ * The items are arranged into a heap using the bottom up construction which
+ * runs in O(n). With HEAP_COPY the items are copied into a new array owned by
+ * the heap. With HEAP_ADOPT the heap takes ownership of the array itself
+ * without copying it. An adopted array must have been allocated with malloc
+ * since the heap will realloc and free it.
+ *
+ * @param type Heap type, max heap_adt or min heap_adt
+ * @param data_mode Data storage strategy of the array
+ * @param payload_size The size of each item. This can be 0 if using HEAP_PTR
+ * @param destroy Pointer to function that frees the block of memory
+ * @param compare Pointer to function that compares the nodes
+ * @param array Array of pointers (HEAP_PTR) or array of items (HEAP_MEM)
+ * @param item_count Number of items in the array
+ * @param ownership HEAP_COPY or HEAP_ADOPT
+ * @param arity Number of children of each node
+ * @return Pointer to heap_adt or NULL
+ */
+heap_t * heap_init_from_array(heap_type_t type,
+                              heap_data_mode_t data_mode,
+                              size_t payload_size,
+                              void (* destroy)(void *),
+                              heap_compare_t (* compare)(void *, void *),
+                              void * array,
+                              size_t item_count,
+                              heap_ownership_t ownership,
+                              heap_arity_t arity)
+{
+    assert(array);
+
+    heap_t * heap = heap_init(type, data_mode, payload_size, destroy, compare,
+                              arity);
+    if (NULL == heap)
+    {
+        return NULL;
+    }
+
+    size_t slot_size = get_slot_size(heap);
+    if (HEAP_ADOPT == ownership)
+    {
+        free(heap->heap_array);
+        heap->heap_array = array;
+        heap->array_size = item_count;
+    }
+    else
+    {
+        // Only grow the array, the base size is kept for small arrays
+        if (item_count > heap->array_size)
+        {
+            void * re_alloc = realloc(heap->heap_array, slot_size * item_count);
+            if (INVALID_PTR == verify_alloc(re_alloc))
+            {
+                heap_destroy(heap);
+                return NULL;
+            }
+            heap->heap_array = re_alloc;
+            heap->array_size = item_count;
+        }
+        memcpy(heap->heap_array, array, slot_size * item_count);
+    }
+    heap->array_length = item_count;
+    STATS_PEAK(heap);
+
+    // An adopted array smaller than the base size is grown so that doubling
+    // the size on insert always makes room
+    if (heap->array_size < BASE_SIZE)
+    {
+        resize_heap(heap, BASE_SIZE);
+    }
+
+    heapify(heap);
+    return heap;
+}
+
+/*!
+ * @brief Create an indexed heap.
+ *
+ * An indexed heap works like any other heap but every inserted item gets a
+ * handle that stays valid until the item leaves the heap. The handle can be
+ * used to check if the item is still in the heap, change its priority or
+ * remove it, all without searching the heap. Handles of removed items are
+ * reused by later inserts.
+ *
+ * @param type Heap type, max heap_adt or min heap_adt
+ * @param data_mode Data storage strategy
+ * @param payload_size The size of the payload. This can be 0 if using HEAP_PTR
+ * @param destroy Pointer to function that frees the block of memory
+ * @param compare Pointer to function that compares the nodes
+ * @param arity Number of children of each node
+ * @return Pointer to heap_adt or NULL
+ */
+heap_t * heap_init_indexed(heap_type_t type,
+                           heap_data_mode_t data_mode,
+                           size_t payload_size,
+                           void (* destroy)(void *),
+                           heap_compare_t (* compare)(void *, void *),
+                           heap_arity_t arity)
+{
+    heap_t * heap = heap_init(type, data_mode, payload_size, destroy, compare,
+                              arity);
+    if (NULL == heap)
+    {
+        return NULL;
+    }
+
+    heap->slot_handles = calloc(heap->array_size, sizeof(size_t));
+    heap->handle_positions = calloc(heap->array_size, sizeof(size_t));
+    heap->handle_generations = calloc(heap->array_size, sizeof(uint32_t));
+    if ((INVALID_PTR == verify_alloc(heap->slot_handles))
+        || (INVALID_PTR == verify_alloc(heap->handle_positions))
+        || (INVALID_PTR == verify_alloc(heap->handle_generations)))
+    {
+        heap_destroy(heap);
+        return NULL;
+    }
+
+    heap->handle_size = heap->array_size;
+    heap->free_handle = SIZE_MAX;
+    return heap;
+}
+
+/*!
+ * @brief Create a keyed heap of pointers.
+ *
+ * A keyed heap stores a key next to each pointer, extracted from the payload
+ * by the key callback when the payload is inserted. Comparisons use the
+ * cached keys so ordering the heap does not dereference the payloads, which
+ * are often scattered over the memory. The compare callback is only called
+ * to break ties between equal keys and can be NULL.
+ *
+ * The heap otherwise behaves like a HEAP_PTR heap. A payload must not change
+ * its key while it is in the heap.
+ *
+ * @param type Heap type, max heap_adt or min heap_adt
+ * @param key_type HEAP_KEY_U64 or HEAP_KEY_DOUBLE
+ * @param key Pointer to function that returns the key of a payload
+ * @param destroy Pointer to function that frees the block of memory
+ * @param compare Pointer to function that breaks ties or NULL
+ * @param arity Number of children of each node
+ * @return Pointer to heap_adt or NULL
+ */
+heap_t * heap_init_keyed(heap_type_t type,
+                         heap_key_type_t key_type,
+                         heap_key_t (* key)(void *),
+                         void (* destroy)(void *),
+                         heap_compare_t (* compare)(void *, void *),
+                         heap_arity_t arity)
+{
+    assert(key);
+    assert(HEAP_KEY_NONE != key_type);
+
+    heap_t * heap = heap_init(type, HEAP_PTR, 0, destroy, compare, arity);
+    if (NULL == heap)
+    {
+        return NULL;
+    }
+
+    // The cells grow from a pointer to a key and a pointer
+    void * re_alloc = realloc(heap->heap_array,
+                              sizeof(heap_key_slot_t) * heap->array_size);
+    if (INVALID_PTR == verify_alloc(re_alloc))
+    {
+        heap_destroy(heap);
+        return NULL;
+    }
+    heap->heap_array = re_alloc;
+    heap->node_size = sizeof(heap_key_slot_t);
+    heap->key_type = key_type;
+    heap->key = key;
+    return heap;
+}
+
+/*!
+ * @brief Make room for at least capacity items so that inserting up to that
+ * many items never reallocates. The array does not shrink below the reserved
+ * capacity until heap_shrink_to_fit is called.
+ * @param heap
+ * @param capacity Number of items to make room for
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the memory could not be allocated
+ */
+heap_result_t heap_reserve(heap_t * heap, size_t capacity)
+{
+    assert(heap);
+    if ((capacity > heap->array_size)
+        && (HEAP_SUCCESS != set_capacity(heap, capacity)))
+    {
+        return HEAP_FAILURE;
+    }
+
+    if (capacity > heap->min_size)
+    {
+        heap->min_size = capacity;
+    }
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Release the memory that is not used by the items in the heap and
+ * drop the capacity reserved with heap_reserve. The array is kept at the base
+ * size at least.
+ * @param heap
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the memory could not be reallocated
+ */
+heap_result_t heap_shrink_to_fit(heap_t * heap)
+{
+    assert(heap);
+    size_t array_size = (heap->array_length > BASE_SIZE) ? heap->array_length
+                                                         : BASE_SIZE;
+    heap->min_size = BASE_SIZE;
+    if (array_size >= heap->array_size)
+    {
+        return HEAP_SUCCESS;
+    }
+    return set_capacity(heap, array_size);
+}
+
+/*!
+ * @brief Set how the array grows and shrinks.
+ *
+ * A full array is multiplied by the growth factor. With HEAP_SHRINK_HYSTERESIS
+ * the array is divided by the growth factor once the items fit in half of the
+ * smaller array, so a heap that stays around the same size stops reallocating
+ * after it warmed up. HEAP_SHRINK_NEVER keeps the array at the largest size it
+ * reached until heap_shrink_to_fit is called.
+ * @param heap
+ * @param growth_factor Multiplier for a full array, greater than 1
+ * @param shrink_policy HEAP_SHRINK_HYSTERESIS or HEAP_SHRINK_NEVER
+ */
+void heap_set_growth_policy(heap_t * heap,
+                            double growth_factor,
+                            heap_shrink_policy_t shrink_policy)
+{
+    assert(heap);
+    assert(growth_factor > 1.0);
+    heap->growth_factor = growth_factor;
+    heap->shrink_policy = shrink_policy;
+}
+
+/*!
+ * @brief Copy the operation counters of the heap into stats.
+ *
+ * The counters are only kept when the library is built with HEAP_STATS
+ * defined, which the HEAP_STATS CMake option does. Without it the counters
+ * are not compiled in and stats is zeroed.
+ * @param heap
+ * @param stats Caller owned storage for the counters
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the counters are not compiled in
+ */
+heap_result_t heap_get_stats(heap_t * heap, heap_stats_t * stats)
+{
+    assert(heap);
+    assert(stats);
+#ifdef HEAP_STATS
+    * stats = heap->stats;
+    return HEAP_SUCCESS;
+#else
+    * stats = (heap_stats_t){0};
+    return HEAP_FAILURE;
+#endif // HEAP_STATS
+}
+
+/*!
+ * @brief Zero the operation counters. The peak length starts again from the
+ * current length.
+ * @param heap
+ */
+void heap_reset_stats(heap_t * heap)
+{
+    assert(heap);
+#ifdef HEAP_STATS
+    heap->stats = (heap_stats_t){
+        .peak_length    = heap->array_length
+    };
+#endif // HEAP_STATS
+}
+
+/*!
+ * @brief Return the number of items the heap can hold before it reallocates
+ * @param heap
+ * @return Physical size of the array
+ */
+size_t heap_capacity(heap_t * heap)
+{
+    assert(heap);
+    return heap->array_size;
+}
+
 /*!
  * @brief Destroy the data structure. If in PTR mode then
  * free the pointers as well
@@ -156,11 +543,14 @@ void heap_destroy(heap_t * heap)
         {
             if (NULL != heap->destroy)
             {
-                heap->destroy(heap->heap_array[i]);
+                heap->destroy(get_value(heap, i));
             }
         }
     }
 
+    free(heap->slot_handles);
+    free(heap->handle_positions);
+    free(heap->handle_generations);
     free(heap->heap_array);
     free(heap);
 }
@@ -170,31 +560,150 @@ void heap_destroy(heap_t * heap)
  *
  * @param heap heap_adt data structure
  * @param payload Pointer to the payload passed in
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the heap could not grow, in which
+ * case the heap is left as it was
  */
-void heap_insert(heap_t * heap, void * payload)
+heap_result_t heap_insert(heap_t * heap, void * payload)
 {
     // ensure heap_adt is a valid pointer
     assert(heap);
 
-    // checks to make sure we have enough space
-    ensure_space(heap);
+    heap_handle_t handle = HEAP_INVALID_HANDLE;
+    return insert_node(heap, payload, &handle);
+}
 
-    if (heap->data_mode == HEAP_PTR)
+/*!
+ * @brief Insert payload into an indexed heap and return its handle
+ *
+ * @param heap Indexed heap created with heap_init_indexed
+ * @param payload Pointer to the payload passed in
+ * @return Handle of the inserted item or HEAP_INVALID_HANDLE if the heap
+ * could not grow
+ */
+heap_handle_t heap_insert_handle(heap_t * heap, void * payload)
+{
+    assert(heap);
+    assert(is_indexed(heap));
+
+    heap_handle_t handle = HEAP_INVALID_HANDLE;
+    insert_node(heap, payload, &handle);
+    return handle;
+}
+
+/*!
+ * @brief Check if the item of the handle is still in the heap. This is O(1)
+ *
+ * @param heap Indexed heap created with heap_init_indexed
+ * @param handle Handle returned by heap_insert_handle
+ * @return True if the item is in the heap
+ */
+bool heap_contains(heap_t * heap, heap_handle_t handle)
+{
+    assert(heap);
+    assert(is_indexed(heap));
+
+    // A released slot has a new generation, and only a live slot is pointed
+    // back at by the node at its position
+    size_t slot = get_handle_slot(handle);
+    if ((slot >= heap->handle_count)
+        || (heap->handle_generations[slot] != (uint32_t)(handle >> 32)))
     {
-        // adds the payload to the array
-        heap->heap_array[heap->array_length] = payload;
+        return false;
     }
-    else
+    size_t index = heap->handle_positions[slot];
+    return (index < heap->array_length) && (heap->slot_handles[index] == slot);
+}
+
+/*!
+ * @brief Return a borrowed reference to the item of the handle. In HEAP_MEM
+ * mode the reference points into the heaps own storage and is only valid
+ * until the next call that modifies the heap.
+ *
+ * @param heap Indexed heap created with heap_init_indexed
+ * @param handle Handle returned by heap_insert_handle
+ * @return Pointer to the item or NULL if the handle is not in the heap
+ */
+void * heap_handle_ref(heap_t * heap, heap_handle_t handle)
+{
+    if (!(heap_contains(heap, handle)))
     {
-        uint8_t * slice = get_slice(heap, heap->array_length);
-        memcpy(slice, payload, heap->node_size);
+        return NULL;
     }
+    return get_value(heap, heap->handle_positions[get_handle_slot(handle)]);
+}
 
-    // increment the array_length of the array
-    heap->array_length++;
+/*!
+ * @brief Change the priority of the item of the handle and move it to its new
+ * place in the heap. The handle stays the same.
+ *
+ * If payload is not NULL it replaces the item (the pointer in HEAP_PTR mode
+ * or a copy of the data in HEAP_MEM mode). If payload is NULL the item is
+ * assumed to have been changed in place by the caller.
+ *
+ * @param heap Indexed heap created with heap_init_indexed
+ * @param handle Handle returned by heap_insert_handle
+ * @param payload New payload or NULL
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the handle is not in the heap
+ */
+heap_result_t heap_update_priority(heap_t * heap,
+                                   heap_handle_t handle,
+                                   void * payload)
+{
+    if (!(heap_contains(heap, handle)))
+    {
+        return HEAP_FAILURE;
+    }
 
-    // perform bubble up
-    bubble_up(heap);
+    size_t index = heap->handle_positions[get_handle_slot(handle)];
+    if (NULL != payload)
+    {
+        write_node(heap, index, payload);
+    }
+    else if (is_keyed(heap))
+    {
+        // The payload changed in place so its cached key is stale
+        write_node(heap, index, get_value(heap, index));
+    }
+
+    restore_order(heap, index);
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Remove the item of the handle from anywhere in the heap.
+ *
+ * In HEAP_MEM mode the item is copied into out. In HEAP_PTR mode out is
+ * treated as a "void **" and the stored pointer is written to it. If out is
+ * NULL the item is discarded, which in HEAP_PTR mode passes it to destroy if
+ * one was provided.
+ *
+ * @param heap Indexed heap created with heap_init_indexed
+ * @param handle Handle returned by heap_insert_handle
+ * @param out Caller owned storage for the removed item or NULL
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the handle is not in the heap
+ */
+heap_result_t heap_remove(heap_t * heap, heap_handle_t handle, void * out)
+{
+    if (!(heap_contains(heap, handle)))
+    {
+        return HEAP_FAILURE;
+    }
+
+    size_t index = heap->handle_positions[get_handle_slot(handle)];
+    if (NULL == out)
+    {
+        if ((HEAP_PTR == heap->data_mode) && (NULL != heap->destroy))
+        {
+            heap->destroy(get_value(heap, index));
+        }
+    }
+    else
+    {
+        copy_out(heap, index, out);
+    }
+
+    remove_at(heap, index);
+    return HEAP_SUCCESS;
 }
 
 /*!
@@ -203,7 +712,12 @@ void heap_insert(heap_t * heap, void * payload)
  * Heap sort function is used to sort the array passed in. The array can be
  * an array of pointers using the HEAP_PTR mode or an array of contiguous
  * data blocks in HEAP_MEM mode. Either way, the array passed in will be
- * sorted in place using the provided compare function
+ * sorted in place using the provided compare function. A MIN_HEAP sorts the
+ * array in ascending order and a MAX_HEAP sorts it in descending order.
+ *
+ * The array itself is used as the heap so no memory is allocated. The array
+ * is arranged into a heap of the opposite type and the root is repeatedly
+ * swapped to the end of the shrinking heap.
  * @param array
  * @param item_count
  * @param item_size
@@ -220,50 +734,39 @@ void heap_sort(void * array,
 {
     assert(array);
 
-    heap_t * heap = heap_init(type, data_mode, item_size, NULL, compare);
-    if (NULL == heap)
-    {
-        return;
-    }
+    // The heap lives on the stack and only borrows the callers array. It
+    // must never be resized or destroyed.
+    heap_t heap = {
+        .array_length       = item_count,
+        .array_size         = item_count,
+        .node_size          = item_size,
+        .arity              = HEAP_BINARY,
 
-    // Create the heap_adt structure if in data mode
-    if (HEAP_PTR == heap->data_mode)
-    {
-        for (size_t item = 0; item < item_count; item++)
-        {
-            heap_insert(heap, * ((void **)array + item));
-        }
-        for (size_t item = 0; item < item_count; item++)
-        {
-            * ((void **)array + item) = heap_pop(heap);
-        }
-    }
-    else
-    {
-        // Insert each item into the heap_adt then pop
-        for (size_t item = 0; item < item_count; item++)
-        {
-            heap_insert(heap, (uint8_t *)array + get_index(item, item_size));
-        }
+        // Opposite type, the root is placed at the end of the array
+        .heap_type          = get_inverse_type(type),
+        .data_mode          = data_mode,
+        .heap_array         = array,
 
-        uint8_t * index_ptr = NULL;
-        void * pop_item = NULL;
-        for (size_t item = 0; item < item_count; item++)
-        {
-            index_ptr = (uint8_t *)array + get_index(item, item_size);
-            pop_item = heap_pop(heap);
-            memcpy(index_ptr, pop_item, item_size);
-            free(pop_item);
-        }
-    }
+        .compare            = compare,
+        .destroy            = NULL
+    };
 
-    // set the mode to mem so that we do not free the pointers incase we are
-    // in pointer mode or else the user will not have their data
-    heap->data_mode = HEAP_MEM;
-    heap_destroy(heap);
+    heapify(&heap);
+    sort_heap(&heap);
 }
 
 
+/*!
+ * @brief Find the nth highest (MAX_HEAP) or nth lowest (MIN_HEAP) item of
+ * the array.
+ *
+ * Kept for compatibility, use heap_select_nth which does not allocate. The
+ * array may be reordered by the search.
+ *
+ * @return The pointer stored in the array in HEAP_PTR mode. In HEAP_MEM mode
+ * a copy of the item that must be freed. NULL if nth_item is out of range
+ * or the search could not allocate.
+ */
 void * heap_find_nth_item(void * array,
                           size_t item_count,
                           size_t item_size,
@@ -274,79 +777,370 @@ void * heap_find_nth_item(void * array,
 {
     assert(array);
 
-    heap_t * heap = heap_init(type, data_mode, item_size, NULL, compare);
-    if (NULL == heap)
+    if ((nth_item < 1) || (nth_item > item_count))
     {
         return NULL;
     }
 
     void * target_item = NULL;
-
-    // Create the heap_adt structure if in data mode
-    if (HEAP_PTR == heap->data_mode)
+    if (HEAP_PTR == data_mode)
     {
-        for (size_t item = 0; item < item_count; item++)
-        {
-            heap_insert(heap, * ((void **)array + item));
-        }
-
-        if ((nth_item < 1) || (nth_item > heap->array_length))
+        if (HEAP_SUCCESS != heap_select_nth(array, item_count, item_size,
+                                            nth_item, data_mode, type,
+                                            compare, &target_item))
         {
-            heap_destroy(heap);
             return NULL;
         }
+        return target_item;
+    }
 
-        for (size_t item = 0; item < nth_item; item++)
-        {
-            target_item = heap_pop(heap);
-        }
+    // Only the returned item needs its own block since it is handed to the
+    // caller to free
+    target_item = malloc(item_size);
+    if (INVALID_PTR == verify_alloc(target_item))
+    {
+        return NULL;
     }
-    else
+    if (HEAP_SUCCESS != heap_select_nth(array, item_count, item_size,
+                                        nth_item, data_mode, type, compare,
+                                        target_item))
     {
-        // Insert each item into the heap_adt then pop
-        for (size_t item = 0; item < item_count; item++)
-        {
-            heap_insert(heap, (uint8_t *)array + get_index(item, item_size));
-        }
-
-        if ((nth_item < 1) || (nth_item > heap->array_length))
-        {
-            heap_destroy(heap);
-            return NULL;
-        }
-
-        uint8_t * index_ptr = NULL;
-        void * pop_item = NULL;
-        for (size_t item = 0; item < nth_item - 1; item++)
-        {
-            index_ptr = (uint8_t *)array + get_index(item, item_size);
-            pop_item = heap_pop(heap);
-            memcpy(index_ptr, pop_item, item_size);
-            free(pop_item);
-        }
-        target_item = heap_pop(heap);
+        free(target_item);
+        return NULL;
     }
-
-    heap_destroy(heap);
     return target_item;
 }
 
 /*!
- * @brief Check to see if the data provided is already in the heap_adt
- * @param heap
+ * @brief Copy the nth highest (MAX_HEAP) or nth lowest (MIN_HEAP) item of the
+ * array into out.
+ *
+ * When the nth item is close to either end of the ranking only a bounded heap
+ * of that many items is kept while streaming over the array, which is
+ * O(n log k) and leaves the array untouched. Otherwise the item is found with
+ * an introselect over the array itself which is O(n) and reorders the array.
+ * The introselect falls back to sorting the remaining range if the
+ * partitioning degrades.
+ *
+ * In HEAP_MEM mode out must hold item_size bytes. In HEAP_PTR mode out is
+ * treated as a "void **" and the matching pointer is written to it.
+ *
+ * @param array Array of pointers (HEAP_PTR) or array of items (HEAP_MEM)
+ * @param item_count Number of items in the array
+ * @param item_size Size of each item. This can be 0 if using HEAP_PTR
+ * @param nth_item Rank of the item starting at 1
+ * @param data_mode Data storage strategy of the array
+ * @param type MAX_HEAP for the nth highest or MIN_HEAP for the nth lowest
+ * @param compare Pointer to function that compares the items
+ * @param out Caller owned storage for the item
+ * @return HEAP_SUCCESS or HEAP_FAILURE if nth_item is out of range
+ */
+heap_result_t heap_select_nth(void * array,
+                              size_t item_count,
+                              size_t item_size,
+                              size_t nth_item,
+                              heap_data_mode_t data_mode,
+                              heap_type_t type,
+                              heap_compare_t (* compare)(void *, void *),
+                              void * out)
+{
+    assert(array);
+    assert(out);
+
+    if ((nth_item < 1) || (nth_item > item_count))
+    {
+        return HEAP_FAILURE;
+    }
+
+    // The array is only wrapped so that the heap helpers can be used on it
+    heap_t view = {
+        .array_length       = item_count,
+        .array_size         = item_count,
+        .node_size          = item_size,
+        .arity              = HEAP_BINARY,
+        .heap_type          = get_inverse_type(type),
+        .data_mode          = data_mode,
+        .heap_array         = array,
+        .compare            = compare,
+        .destroy            = NULL
+    };
+
+    // The nth best is also the (count - nth + 1)th worst, keep the smaller
+    // of the two sets. Keeping the worst items needs a heap of the same type.
+    size_t bound = nth_item;
+    heap_compare_t bounded_type = get_inverse_type(type);
+    if ((item_count - nth_item + 1) < bound)
+    {
+        bound = item_count - nth_item + 1;
+        bounded_type = (HEAP_GT == bounded_type) ? HEAP_LT : HEAP_GT;
+    }
+
+    if (bound > SELECT_HEAP_MAX)
+    {
+        introselect(&view, nth_item - 1, type);
+        copy_out(&view, nth_item - 1, out);
+        return HEAP_SUCCESS;
+    }
+
+    // A single scratch array of the bound size holds the bounded heap
+    size_t slot_size = get_slot_size(&view);
+    heap_t bounded = view;
+    bounded.heap_type = bounded_type;
+    bounded.array_length = 0;
+    bounded.array_size = bound;
+    bounded.heap_array = malloc(slot_size * bound);
+    if (INVALID_PTR == verify_alloc(bounded.heap_array))
+    {
+        return HEAP_FAILURE;
+    }
+
+    for (size_t item = 0; item < item_count; item++)
+    {
+        void * payload = get_value(&view, item);
+        if (bounded.array_length < bound)
+        {
+            heap_insert(&bounded, payload);
+        }
+        else if (is_kept(&bounded, payload))
+        {
+            replace_root(&bounded, payload);
+        }
+    }
+
+    // The root is the item at the edge of the kept set
+    copy_out(&bounded, 0, out);
+    free(bounded.heap_array);
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Copy the k highest (MAX_HEAP) or k lowest (MIN_HEAP) items of the
+ * array into out_array, best item first.
+ *
+ * out_array is used as the storage of a bounded heap of k items while
+ * streaming over the array, so no memory is allocated and the array is left
+ * untouched. out_array must have room for k items.
+ *
+ * @param array Array of pointers (HEAP_PTR) or array of items (HEAP_MEM)
+ * @param item_count Number of items in the array
+ * @param item_size Size of each item. This can be 0 if using HEAP_PTR
+ * @param k Number of items to keep
+ * @param data_mode Data storage strategy of the arrays
+ * @param type MAX_HEAP for the highest items or MIN_HEAP for the lowest
+ * @param compare Pointer to function that compares the items
+ * @param out_array Caller owned array with room for k items
+ * @return Number of items written, which is less than k if the array is
+ * smaller than k
+ */
+size_t heap_top_k(void * array,
+                  size_t item_count,
+                  size_t item_size,
+                  size_t k,
+                  heap_data_mode_t data_mode,
+                  heap_type_t type,
+                  heap_compare_t (* compare)(void *, void *),
+                  void * out_array)
+{
+    assert(array);
+    assert(out_array);
+
+    heap_t view = {
+        .array_length       = item_count,
+        .array_size         = item_count,
+        .node_size          = item_size,
+        .arity              = HEAP_BINARY,
+        .heap_type          = get_inverse_type(type),
+        .data_mode          = data_mode,
+        .heap_array         = array,
+        .compare            = compare,
+        .destroy            = NULL
+    };
+
+    heap_t bounded = view;
+    bounded.array_length = 0;
+    bounded.array_size = k;
+    bounded.heap_array = out_array;
+
+    for (size_t item = 0; item < item_count; item++)
+    {
+        void * payload = get_value(&view, item);
+        if (bounded.array_length < k)
+        {
+            heap_insert(&bounded, payload);
+        }
+        else if ((k > 0) && (is_kept(&bounded, payload)))
+        {
+            replace_root(&bounded, payload);
+        }
+    }
+
+    // Sorting the inverse heap in place leaves the best item first
+    size_t kept = bounded.array_length;
+    sort_heap(&bounded);
+    return kept;
+}
+
+/*!
+ * @brief Create a bounded accumulator that keeps the k highest (MAX_HEAP) or
+ * k lowest (MIN_HEAP) items pushed into it.
+ *
+ * Memory stays O(k) no matter how many items are pushed. In HEAP_PTR mode
+ * the payloads that do not make the cut, or that are pushed out by a better
+ * payload, are passed to destroy if it is provided.
+ *
+ * @param k Number of items to keep
+ * @param type MAX_HEAP for the highest items or MIN_HEAP for the lowest
+ * @param data_mode Data storage strategy
+ * @param payload_size The size of the payload. This can be 0 if using HEAP_PTR
+ * @param destroy Pointer to function that frees the block of memory
+ * @param compare Pointer to function that compares the nodes
+ * @return Pointer to the accumulator or NULL
+ */
+heap_top_k_t * heap_top_k_init(size_t k,
+                               heap_type_t type,
+                               heap_data_mode_t data_mode,
+                               size_t payload_size,
+                               void (* destroy)(void *),
+                               heap_compare_t (* compare)(void *, void *))
+{
+    heap_top_k_t * top_k = (heap_top_k_t *)malloc(sizeof(heap_top_k_t));
+    if (INVALID_PTR == verify_alloc(top_k))
+    {
+        return NULL;
+    }
+
+    // The kept items are stored in a heap of the opposite type so that the
+    // worst of the kept items is always at the root
+    heap_t * heap = heap_init(type ? MAX_HEAP : MIN_HEAP,
+                              data_mode,
+                              payload_size,
+                              destroy,
+                              compare,
+                              HEAP_BINARY);
+    if (NULL == heap)
+    {
+        free(top_k);
+        return NULL;
+    }
+
+    // The heap never holds more than k items so it is sized once
+    heap_reserve(heap, k);
+    heap_set_growth_policy(heap, DEFAULT_GROWTH_FACTOR, HEAP_SHRINK_NEVER);
+
+    * top_k = (heap_top_k_t){
+        .heap   = heap,
+        .k      = k
+    };
+    return top_k;
+}
+
+/*!
+ * @brief Destroy the accumulator. In HEAP_PTR mode the kept payloads are
+ * freed with the destroy function
+ * @param top_k
+ */
+void heap_top_k_destroy(heap_top_k_t * top_k)
+{
+    assert(top_k);
+    heap_destroy(top_k->heap);
+    free(top_k);
+}
+
+/*!
+ * @brief Offer a payload to the accumulator. The payload is kept if fewer
+ * than k items are kept or if it ranks better than the worst kept item, in
+ * which case the worst kept item is dropped.
+ *
+ * @param top_k
+ * @param payload Pointer to the payload passed in
+ */
+void heap_top_k_push(heap_top_k_t * top_k, void * payload)
+{
+    assert(top_k);
+    heap_t * heap = top_k->heap;
+
+    if (heap->array_length < top_k->k)
+    {
+        heap_insert(heap, payload);
+        return;
+    }
+
+    void * dropped = payload;
+    if ((top_k->k > 0) && (is_kept(heap, payload)))
+    {
+        dropped = (HEAP_PTR == heap->data_mode) ? get_value(heap, 0) : NULL;
+        replace_root(heap, payload);
+    }
+
+    if ((HEAP_PTR == heap->data_mode) && (NULL != heap->destroy))
+    {
+        heap->destroy(dropped);
+    }
+}
+
+/*!
+ * @brief Return the number of items kept by the accumulator
+ * @param top_k
+ * @return Number of kept items, at most k
+ */
+size_t heap_top_k_length(heap_top_k_t * top_k)
+{
+    assert(top_k);
+    return top_k->heap->array_length;
+}
+
+/*!
+ * @brief Return a borrowed reference to the worst of the kept items. Once k
+ * items are kept this is the kth best item pushed so far.
+ * @param top_k
+ * @return Pointer to the item or NULL if nothing is kept
+ */
+void * heap_top_k_peek_ref(heap_top_k_t * top_k)
+{
+    assert(top_k);
+    return heap_peek_ref(top_k->heap);
+}
+
+/*!
+ * @brief Move the kept items into out_array, best item first, and empty the
+ * accumulator. In HEAP_PTR mode the ownership of the payloads is handed to
+ * the caller.
+ *
+ * @param top_k
+ * @param out_array Caller owned array with room for k items
+ * @return Number of items written
+ */
+size_t heap_top_k_drain(heap_top_k_t * top_k, void * out_array)
+{
+    assert(top_k);
+    assert(out_array);
+    heap_t * heap = top_k->heap;
+
+    size_t kept = heap->array_length;
+    sort_heap(heap);
+    memcpy(out_array, heap->heap_array, get_slot_size(heap) * kept);
+
+    heap->array_length = 0;
+    return kept;
+}
+
+/*!
+ * @brief Check to see if the data provided is already in the heap_adt
+ * @param heap
  * @param data
  * @return bool
  */
 bool heap_in_heap(heap_t * heap, void * data)
 {
     assert(heap);
+    assert(heap->compare);
 
-    bool found = false;
     heap_compare_t comparison;
     size_t start_index = 0;
-    while ((!found) && (start_index <= heap->array_length))
+    while (start_index < heap->array_length)
     {
-        comparison = heap->compare(get_slice(heap, start_index), data);
+        STATS_ADD(heap, compares);
+        comparison = heap->compare(get_value(heap, start_index), data);
         if (HEAP_EQ == comparison)
         {
             return true;
@@ -362,11 +1156,23 @@ bool heap_in_heap(heap_t * heap, void * data)
  */
 void heap_dump(heap_t * heap)
 {
-    for (size_t i = 0; i < heap->array_length; i++)
+    if ((HEAP_PTR == heap->data_mode) && (NULL != heap->destroy))
     {
-        heap->destroy(heap->heap_array[i]);
+        for (size_t i = 0; i < heap->array_length; i++)
+        {
+            heap->destroy(get_value(heap, i));
+        }
     }
     heap->array_length = 0;
+
+    // Every handle is released at once. The slots are handed out again from
+    // the first one, so their generations change to keep the old handles out.
+    for (size_t slot = 0; slot < heap->handle_count; slot++)
+    {
+        heap->handle_generations[slot]++;
+    }
+    heap->handle_count = 0;
+    heap->free_handle = SIZE_MAX;
     ensure_downgrade_size(heap);
 }
 
@@ -385,6 +1191,9 @@ bool heap_is_empty(heap_t * heap)
  * @brief Pop the root value of the tree. Always returns a
  * pointer that must be freed
  *
+ * In HEAP_MEM mode a new block is allocated for every pop. Use heap_pop_into
+ * to copy the value into storage owned by the caller instead.
+ *
  * @param heap
  * @return Pointer that must be freed
  */
@@ -399,101 +1208,209 @@ void * heap_pop(heap_t * heap)
         return NULL;
     }
 
-    void * payload;
+    void * payload = NULL;
 
-     if (HEAP_PTR == heap->data_mode)
+    if (HEAP_PTR == heap->data_mode)
     {
-        // pop the root node and decrement our array_length size
-        payload = heap->heap_array[0];
-        heap->array_length--;
-        heap->heap_array[0] = heap->heap_array[heap->array_length];
+        heap_pop_into(heap, &payload);
     }
     else
     {
-        // Extract the current data at index 0
-        uint8_t * temp = (uint8_t *)calloc(1, sizeof(heap->node_size));
-        uint8_t * index_0_ptr = get_slice(heap, 0);
-        memcpy(temp, index_0_ptr, heap->node_size);
+        payload = malloc(heap->node_size);
+        if (INVALID_PTR == verify_alloc(payload))
+        {
+            return NULL;
+        }
+        heap_pop_into(heap, payload);
+    }
 
-        // Place the last node at index 0 to start the bubble algorithm
-        // the copied node is zeroes out
-        heap->array_length--;
-        uint8_t * index_last_ptr = get_slice(heap, heap->array_length);
-        memcpy(index_0_ptr, index_last_ptr, heap->node_size);
-        memset(index_last_ptr, 0, heap->node_size);
+    // return pop value
+    return payload;
+}
 
-        // save the pointer to the variable
-        payload = (void *)temp;
+/*!
+ * @brief Pop the root value of the tree into the storage provided by the
+ * caller.
+ *
+ * In HEAP_MEM mode the payload is copied into out, which must be at least
+ * payload_size bytes. In HEAP_PTR mode out is treated as a "void **" and the
+ * stored pointer is written to it. No memory is allocated by the call.
+ *
+ * @param heap
+ * @param out Caller owned storage for the popped value
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the heap is empty
+ */
+heap_result_t heap_pop_into(heap_t * heap, void * out)
+{
+    // ensure that the pointers are valid
+    assert(heap);
+    assert(out);
+
+    if (heap_is_empty(heap))
+    {
+        return HEAP_FAILURE;
     }
 
+    // Copy the root out, the last node then takes its place and is bubbled
+    // down to restore the heap
+    copy_out(heap, 0, out);
+    remove_at(heap, 0);
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Return a borrowed reference to the root of the heap without
+ * removing it.
+ *
+ * In HEAP_PTR mode this is the pointer that was inserted. In HEAP_MEM mode
+ * this points into the heaps own storage and is only valid until the next
+ * call that modifies the heap.
+ *
+ * @param heap
+ * @return Pointer to the root value or NULL if the heap is empty
+ */
+void * heap_peek_ref(heap_t * heap)
+{
+    assert(heap);
 
-    // perform the bubble down algorithm
-    if (heap->array_length)
+    if (heap_is_empty(heap))
     {
-        bubble_down(heap);
+        return NULL;
     }
 
-    // resize array if we need to
-    ensure_downgrade_size(heap);
-
-    // return pop value
-    return payload;
+    return get_value(heap, 0);
 }
 
 /*!
- * @brief Dynamically increase the size of the heap_adt
+ * @brief Replace the root with the payload and bubble it down.
+ *
+ * This is a pop followed by an insert in a single bubble down, for loops that
+ * take the best item and put back the item that follows it. The old root is
+ * copied into out like heap_pop_into. If out is NULL the old root is
+ * discarded and freed with the destroy callback in HEAP_PTR mode.
+ *
+ * Indexed heaps can not replace their root since the handle of the old root
+ * would be handed to the new payload. Use heap_update_priority instead.
  * @param heap
+ * @param payload Pointer to the new payload
+ * @param out Caller owned storage for the old root or NULL
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the heap is empty or indexed
  */
-static void ensure_space(heap_t * heap)
+heap_result_t heap_replace_root(heap_t * heap, void * payload, void * out)
 {
-    if (heap->array_length == heap->array_size)
+    assert(heap);
+    if ((heap_is_empty(heap)) || (is_indexed(heap)))
     {
-        heap->array_size = heap->array_size * 2;
-        resize_heap(heap);
+        return HEAP_FAILURE;
     }
+
+    if (NULL != out)
+    {
+        copy_out(heap, 0, out);
+    }
+    else if ((HEAP_PTR == heap->data_mode) && (NULL != heap->destroy))
+    {
+        heap->destroy(get_value(heap, 0));
+    }
+    replace_root(heap, payload);
+    return HEAP_SUCCESS;
 }
 
 /*!
- * Change the size of the data array if the length of the array can fit
- * within the size/2 of the array. Unless, the size becomes less than the
- * base size
+ * Shrink the data array once the items fit in half of the array that a
+ * shrink would leave. The gap between the grow and shrink points stops a heap
+ * that moves back and forth around a boundary from reallocating on every
+ * insert and pop. The array never shrinks below the reserved size.
  * @param heap
  */
 static void ensure_downgrade_size(heap_t * heap)
 {
-    if ((heap->array_length == (heap->array_size / 2))
-        & (heap->array_size > BASE_SIZE))
+    if ((HEAP_SHRINK_NEVER == heap->shrink_policy)
+        || (heap->array_size <= heap->min_size))
+    {
+        return;
+    }
+
+    size_t array_size = (size_t)((double)heap->array_size
+                                 / heap->growth_factor);
+    if (array_size < heap->min_size)
+    {
+        array_size = heap->min_size;
+    }
+    if (heap->array_length <= (array_size / 2))
     {
-        heap->array_size = heap->array_size / 2;
-        resize_heap(heap);
+        resize_heap(heap, array_size);
     }
 }
 
 /*!
  * Resize the array based on the what is happening dynamically.
  * @param heap
+ * @param array_size New physical size of the array
  */
-static void resize_heap(heap_t * heap)
+static void resize_heap(heap_t * heap, size_t array_size)
 {
-    void * re_alloc = NULL;
-    if (HEAP_PTR == heap->data_mode)
+    if (HEAP_SUCCESS != set_capacity(heap, array_size))
     {
-        re_alloc = realloc(heap->heap_array, sizeof(void * ) *
-        heap->array_size);
+        fprintf(stderr, "[!] Could not reallocate memory for heap_adt!\n");
+        heap_destroy(heap);
+        abort();
     }
-    else
-    {
-        re_alloc = realloc(heap->heap_array, heap->node_size *
-        heap->array_size);
+}
 
-    }
+/*!
+ * @brief Reallocate the array to the size. On failure the heap is left as it
+ * was so the caller can decide if the failure is fatal.
+ * @param heap
+ * @param array_size New physical size of the array
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the memory could not be allocated
+ */
+static heap_result_t set_capacity(heap_t * heap, size_t array_size)
+{
+    void * re_alloc = realloc(heap->heap_array,
+                              get_slot_size(heap) * array_size);
     if (INVALID_PTR == verify_alloc(re_alloc))
     {
-        fprintf(stderr, "[!] Could not reallocate memory for heap_adt!\n");
-        heap_destroy(heap);
-        abort();
+        return HEAP_FAILURE;
     }
     heap->heap_array = re_alloc;
+
+    // The handle of each node is kept in a parallel array of the same size.
+    // A handle array left larger than a shrunk heap array is harmless, but
+    // the size can only grow once both arrays have grown.
+    if (is_indexed(heap))
+    {
+        re_alloc = realloc(heap->slot_handles,
+                           sizeof(size_t) * array_size);
+        if (INVALID_PTR == verify_alloc(re_alloc))
+        {
+            if (array_size > heap->array_size)
+            {
+                return HEAP_FAILURE;
+            }
+        }
+        else
+        {
+            heap->slot_handles = re_alloc;
+        }
+    }
+    heap->array_size = array_size;
+    STATS_ADD(heap, resizes);
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Return the size of a full array after it grows by the growth factor.
+ * The array always grows by at least one node.
+ * @param heap
+ * @return New physical size of the array
+ */
+static size_t get_grown_size(heap_t * heap)
+{
+    size_t array_size = (size_t)((double)heap->array_size
+                                 * heap->growth_factor);
+    return (array_size > heap->array_size) ? array_size
+                                            : heap->array_size + 1;
 }
 
 /*!
@@ -504,18 +1421,16 @@ static void resize_heap(heap_t * heap)
  * This operation only occurs at maximum of the height of the tree making
  * it have a time complexity of O(log n)
  * @param heap
+ * @param index Index of the node to start bubbling up from
  */
-static void bubble_up(heap_t * heap)
+static void bubble_up(heap_t * heap, size_t index)
 {
-    // get the last index
-    size_t index = heap->array_length - 1;
-
     while ((index > 0) &&
         (heap->heap_type
-            == get_comparison(heap, index, get_parent_index(index))))
+            == get_comparison(heap, index, get_parent_index(heap, index))))
     {
-        swap(heap, index, get_parent_index(index));
-        index = get_parent_index(index);
+        swap(heap, index, get_parent_index(heap, index));
+        index = get_parent_index(heap, index);
     }
 }
 
@@ -528,150 +1443,429 @@ static void bubble_up(heap_t * heap)
  * it have a time complexity of O(log n)
  *
  * @param heap[in]
+ * @param parent_index[in] Index of the node to start bubbling down from
  */
-static void bubble_down(heap_t * heap)
+static void bubble_down(heap_t * heap, size_t parent_index)
 {
-    size_t parent_index = 0;
-    size_t target_index = 0;
-    while ((parent_index < heap->array_length) && (!(is_valid_parent(heap, parent_index))))
+    // if the "target_index" or the index to swap the parent with is the
+    // parent itself then we know that we are done bubbling.
+    size_t target_index = get_target_index(heap, parent_index);
+    while (target_index != parent_index)
     {
-        // if the "target_index" or the index to swap the parent with is the
-        // parent itself then we know that we are done bubbling.
+        // if target is identified, then swap the values
+        swap(heap, parent_index, target_index);
+        parent_index = target_index;
         target_index = get_target_index(heap, parent_index);
-        if (target_index == parent_index)
+    }
+}
+
+/*!
+ * @brief Move the node at the index to its correct place after it was
+ * replaced or changed. The node either bubbles up or down but never both.
+ * @param heap[in]
+ * @param index[in] Index of the node that changed
+ */
+static void restore_order(heap_t * heap, size_t index)
+{
+    if ((index > 0)
+        && (heap->heap_type
+            == get_comparison(heap, index, get_parent_index(heap, index))))
+    {
+        bubble_up(heap, index);
+    }
+    else
+    {
+        bubble_down(heap, index);
+    }
+}
+
+/*!
+ * @brief Place the payload at the end of the heap and bubble it up
+ *
+ * The array and the handles grow before anything is written, so a failed
+ * allocation leaves the heap as it was.
+ * @param heap[in]
+ * @param payload[in] Pointer to the payload passed in
+ * @param handle[out] Handle of the node for indexed heaps
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the heap could not grow
+ */
+static heap_result_t insert_node(heap_t * heap,
+                                 void * payload,
+                                 heap_handle_t * handle)
+{
+    if ((heap->array_length == heap->array_size)
+        && (HEAP_SUCCESS != set_capacity(heap, get_grown_size(heap))))
+    {
+        return HEAP_FAILURE;
+    }
+    if ((is_indexed(heap)) && (HEAP_SUCCESS != reserve_handle(heap)))
+    {
+        return HEAP_FAILURE;
+    }
+
+    write_node(heap, heap->array_length, payload);
+    if (is_indexed(heap))
+    {
+        * handle = acquire_handle(heap, heap->array_length);
+    }
+
+    // increment the array_length of the array
+    heap->array_length++;
+    STATS_PEAK(heap);
+
+    // perform bubble up
+    bubble_up(heap, heap->array_length - 1);
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Remove the node at the index. The last node takes its place and is
+ * moved to its correct place. The caller must copy the node out first.
+ * @param heap[in]
+ * @param index[in] Index of the node to remove
+ */
+static void remove_at(heap_t * heap, size_t index)
+{
+    if (is_indexed(heap))
+    {
+        release_handle(heap, heap->slot_handles[index]);
+    }
+
+    heap->array_length--;
+    size_t last_index = heap->array_length;
+    if (index != last_index)
+    {
+        if (is_pointer_array(heap))
         {
-            break;
+            heap->heap_array[index] = heap->heap_array[last_index];
+        }
+        else
+        {
+            memcpy(get_slice(heap, index),
+                   get_slice(heap, last_index),
+                   heap->node_size);
         }
 
-        // if target is identified, then swap the values
-        swap(heap, parent_index, target_index);
-        parent_index = target_index;
+        if (is_indexed(heap))
+        {
+            heap->slot_handles[index] = heap->slot_handles[last_index];
+            heap->handle_positions[heap->slot_handles[index]] = index;
+        }
+        restore_order(heap, index);
     }
+
+    // resize array if we need to
+    ensure_downgrade_size(heap);
 }
 
 /*!
- * @brief Gets the parent index of the index provided
- * @param index[in] index to inspect
- * @return Index of the parent
+ * @brief Turn the unordered array of the heap into a valid heap using the
+ * bottom up (Floyd) construction.
+ *
+ * Every parent is bubbled down starting from the last parent and working
+ * towards the root. Most of the nodes are near the bottom of the tree where
+ * the bubbling is short, which makes the construction O(n) instead of the
+ * O(n log n) of inserting the nodes one by one.
+ *
+ * @param heap[in]
  */
-static size_t get_parent_index(size_t index)
+static void heapify(heap_t * heap)
 {
-    return (index - 1) / 2;
+    if (heap->array_length < 2)
+    {
+        return;
+    }
+
+    size_t parent_index = get_parent_index(heap, heap->array_length - 1) + 1;
+    while (parent_index > 0)
+    {
+        parent_index--;
+        bubble_down(heap, parent_index);
+    }
 }
 
 /*!
- * @brief Gets the child index of the index provided
- * @param index[in] index to inspect
- * @return Index of the child
+ * @brief Sort a valid heap in place by repeatedly swapping the root to the
+ * end of the shrinking heap. The array ends up in the reverse order of the
+ * heap type and the heap is left with its length unchanged.
+ *
+ * @param heap[in]
  */
-static size_t get_left_child_index(size_t index)
+static void sort_heap(heap_t * heap)
 {
-    return index * 2 + 1;
+    size_t length = heap->array_length;
+    while (heap->array_length > 1)
+    {
+        heap->array_length--;
+        swap(heap, 0, heap->array_length);
+        bubble_down(heap, 0);
+    }
+    heap->array_length = length;
 }
 
 /*!
- * @brief Gets the child index of the index provided
- * @param index[in] index to inspect
- * @return Index of the child
+ * @brief Check if the payload belongs in a full bounded heap. The root of a
+ * bounded heap is the worst of the kept items, so the payload is kept when
+ * the root is above it in the heap order.
+ *
+ * @param heap[in] Bounded heap with at least one item
+ * @param payload[in] Pointer to the payload passed in
+ * @return True if the payload should replace the root
  */
-static size_t get_right_child_index(size_t index)
+static bool is_kept(heap_t * heap, void * payload)
 {
-    return index * 2 + 2;
+    STATS_ADD(heap, compares);
+    return heap->heap_type == heap->compare(get_value(heap, 0), payload);
 }
 
 /*!
- * @brief Swap the positions of the two index in the array
- * @param heap[in] heap_t
- * @param child_index[in] index of the child_index to swap from
- * @param parent_index[in] index of the new get_parent_index
+ * @brief Overwrite the root with the payload and bubble it down. This is
+ * cheaper than a pop followed by an insert.
+ *
+ * @param heap[in]
+ * @param payload[in] Pointer to the payload passed in
  */
-static void swap(heap_t * heap, size_t child_index, size_t parent_index)
+static void replace_root(heap_t * heap, void * payload)
+{
+    write_node(heap, 0, payload);
+    bubble_down(heap, 0);
+}
+
+/*!
+ * @brief Copy the cell at the index into out. In HEAP_PTR mode the pointer
+ * itself is written to out
+ * @param heap[in]
+ * @param index[in]
+ * @param out[out] Caller owned storage
+ */
+static void copy_out(heap_t * heap, size_t index, void * out)
 {
     if (HEAP_PTR == heap->data_mode)
     {
-        void * temp_payload = heap->heap_array[child_index];
-        heap->heap_array[child_index] = heap->heap_array[parent_index];
-        heap->heap_array[parent_index] = temp_payload;
+        * (void **)out = get_value(heap, index);
     }
     else
     {
-        // copy node to temp var
-        uint8_t * temp = calloc(1, sizeof(uint8_t) * heap->node_size);
-        uint8_t * child_data = get_slice(heap, child_index);
-        uint8_t * parent_data = get_slice(heap, parent_index);
-
-        // copy the child data to temp, then replace it with the parent
-        memcpy(temp, child_data, heap->node_size);
-        memcpy(child_data, parent_data, heap->node_size);
-
-        // replace parent data with the child data
-        memcpy(parent_data, temp, heap->node_size);
-        free(temp);
+        memcpy(out, get_slice(heap, index), heap->node_size);
     }
 }
 
 /*!
- * @brief Return bool indicating that the parent is either greater or equal
- * to its children for a max heap_adt or if the parent is less than or equal to
- * both of its children in the case of a min heap_adt
- * @param heap
- * @param parent_index
- * @return
+ * @brief Store the payload in the cell at the index. Keyed heaps extract the
+ * key of the payload here, once per write, so the comparisons that follow
+ * never have to dereference the payload.
+ * @param heap[in]
+ * @param index[in]
+ * @param payload[in] Pointer to the payload passed in
  */
-static bool is_valid_parent(heap_t * heap, size_t parent_index)
+static void write_node(heap_t * heap, size_t index, void * payload)
 {
-    // Heaps will only have a right child if there is a left child because of
-    // the binary tree rule. Therefore, if there is no left, then just return
-    // the root which means that the node is a valid parent, a lonely parent.
-    if (!(has_left_child(heap, parent_index)))
+    if (is_keyed(heap))
+    {
+        * (heap_key_slot_t *)get_slice(heap, index) = (heap_key_slot_t){
+            .key        = heap->key(payload),
+            .payload    = payload
+        };
+    }
+    else if (HEAP_PTR == heap->data_mode)
     {
-        return true;
+        heap->heap_array[index] = payload;
     }
+    else
+    {
+        memcpy(get_slice(heap, index), payload, heap->node_size);
+    }
+}
 
-    // since left child exists, check if current item is greater or less than
-    size_t left_child_index = get_left_child_index(parent_index);
-    heap_compare_t eval = get_comparison(heap, parent_index, left_child_index);
+/*!
+ * @brief Reorder the array so that the item at target_index is the item that
+ * would be there if the array was sorted best first.
+ *
+ * The range is narrowed with a three way partition around the median of
+ * three. Once the range is small, or after too many partitions which means
+ * that the pivots are bad, the rest of the range is heap sorted instead.
+ *
+ * @param heap[in] View over the array
+ * @param target_index[in] Index of the item to place
+ * @param type[in] MAX_HEAP for highest first or MIN_HEAP for lowest first
+ */
+static void introselect(heap_t * heap, size_t target_index, heap_type_t type)
+{
+    // An item ranks better than the pivot when it compares as this value
+    heap_compare_t better = type ? HEAP_LT : HEAP_GT;
+    size_t low = 0;
+    size_t high = heap->array_length;
+
+    // Allow two partitions per level of a balanced partitioning
+    size_t depth_limit = 0;
+    for (size_t length = high; length > 1; length /= 2)
+    {
+        depth_limit += 2;
+    }
 
-    // if the parent is GT the left_child in a GT heap_adt, or it is equal, then
-    // the parent is valid. Otherwise, it is not. Same goes for min
-    if ((eval != heap->heap_type) || (eval != HEAP_EQ))
+    while ((high - low) > SELECT_SMALL_RANGE)
     {
-        return false;
+        if (0 == depth_limit)
+        {
+            break;
+        }
+        depth_limit--;
+
+        // Place the pivot at the start of the range. The items in
+        // [low, less) rank better, [less, index) are equal to the pivot and
+        // (greater, high) rank worse.
+        swap(heap, low, get_median_of_three(heap, low, high - 1));
+        size_t less = low;
+        size_t index = low + 1;
+        size_t greater = high - 1;
+        while (index <= greater)
+        {
+            heap_compare_t eval = get_comparison(heap, index, less);
+            if (better == eval)
+            {
+                swap(heap, less, index);
+                less++;
+                index++;
+            }
+            else if (HEAP_EQ == eval)
+            {
+                index++;
+            }
+            else
+            {
+                swap(heap, index, greater);
+                greater--;
+            }
+        }
+
+        if (target_index < less)
+        {
+            high = less;
+        }
+        else if (target_index > greater)
+        {
+            low = greater + 1;
+        }
+        else
+        {
+            return;
+        }
     }
 
-    // if there is a right child, and we get to here then do the same
-    // comparison for the right child
-    if (has_right_child(heap, parent_index))
+    heap_sort(get_cell(heap, low), high - low, heap->node_size,
+              heap->data_mode, type, heap->compare);
+}
+
+/*!
+ * @brief Return the index of the median of the first, middle and last item
+ * of the range
+ * @param heap[in]
+ * @param low[in] First index of the range
+ * @param high[in] Last index of the range
+ * @return Index of the median
+ */
+static size_t get_median_of_three(heap_t * heap, size_t low, size_t high)
+{
+    size_t middle = low + ((high - low) / 2);
+
+    if (HEAP_LT == get_comparison(heap, middle, low))
+    {
+        size_t temp = middle;
+        middle = low;
+        low = temp;
+    }
+    if (HEAP_LT == get_comparison(heap, high, middle))
     {
-        size_t right_child_index = get_right_child_index(parent_index);
-        eval = get_comparison(heap, parent_index, right_child_index);
-        if ((eval != heap->heap_type) || (eval != HEAP_EQ))
+        middle = high;
+        if (HEAP_LT == get_comparison(heap, middle, low))
         {
-            return false;
+            middle = low;
         }
     }
+    return middle;
+}
 
-    return true;
+/*!
+ * @brief Return the heap order of the opposite heap type. Sorting with the
+ * opposite order leaves the root of the requested type first.
+ * @param type
+ * @return HEAP_GT for MIN_HEAP and HEAP_LT for MAX_HEAP
+ */
+static heap_compare_t get_inverse_type(heap_type_t type)
+{
+    return type ? HEAP_GT : HEAP_LT;
 }
 
 /*!
- * Return if the node has a left child by getting the what would be the index
- * of its child and see if that index fits in the range of items that we have
- * on the list.
+ * @brief Gets the parent index of the index provided
+ * @param heap[in] heap_t
+ * @param index[in] index to inspect
+ * @return Index of the parent
  */
-static bool has_left_child(heap_t * heap, size_t index)
+static size_t get_parent_index(heap_t * heap, size_t index)
 {
-    return get_left_child_index(index) < heap->array_length;
+    return (index - 1) / heap->arity;
 }
 
 /*!
- * Return if the node has a right child by getting the what would be the index
- * of its child and see if that index fits in the range of items that we have
- * on the list.
+ * @brief Gets the index of the first child of the index provided. The rest of
+ * the children follow it in the array.
+ * @param heap[in] heap_t
+ * @param index[in] index to inspect
+ * @return Index of the first child
  */
-static bool has_right_child(heap_t * heap, size_t index)
+static size_t get_first_child_index(heap_t * heap, size_t index)
 {
-    return get_right_child_index(index) < heap->array_length;
+    return index * heap->arity + 1;
+}
+
+/*!
+ * @brief Swap the positions of the two index in the array
+ * @param heap[in] heap_t
+ * @param child_index[in] index of the child_index to swap from
+ * @param parent_index[in] index of the new get_parent_index
+ */
+static void swap(heap_t * heap, size_t child_index, size_t parent_index)
+{
+    STATS_ADD(heap, swaps);
+    if (is_pointer_array(heap))
+    {
+        void * temp_payload = heap->heap_array[child_index];
+        heap->heap_array[child_index] = heap->heap_array[parent_index];
+        heap->heap_array[parent_index] = temp_payload;
+    }
+    else
+    {
+        uint8_t * child_data = get_slice(heap, child_index);
+        uint8_t * parent_data = get_slice(heap, parent_index);
+
+        // Swap the nodes through a small stack buffer one chunk at a time
+        // so that swapping never has to allocate
+        uint8_t temp[SWAP_CHUNK];
+        size_t remaining = heap->node_size;
+        while (remaining > 0)
+        {
+            size_t chunk = (remaining < SWAP_CHUNK) ? remaining : SWAP_CHUNK;
+            memcpy(temp, child_data, chunk);
+            memcpy(child_data, parent_data, chunk);
+            memcpy(parent_data, temp, chunk);
+
+            child_data += chunk;
+            parent_data += chunk;
+            remaining -= chunk;
+        }
+    }
+
+    // Keep the handles pointing at the nodes they were handed out for
+    if (is_indexed(heap))
+    {
+        size_t child_handle = heap->slot_handles[child_index];
+        heap->slot_handles[child_index] = heap->slot_handles[parent_index];
+        heap->slot_handles[parent_index] = child_handle;
+
+        heap->handle_positions[heap->slot_handles[child_index]] = child_index;
+        heap->handle_positions[child_handle] = parent_index;
+    }
 }
 
 /*!
@@ -686,42 +1880,25 @@ static bool has_right_child(heap_t * heap, size_t index)
  */
 static size_t get_target_index(heap_t * heap, size_t parent_index)
 {
-    // if there is no left child, then there is no right child because of the
-    // rule of binary fill from left to right. Therefore, return the root.
-    if (!(has_left_child(heap, parent_index)))
-    {
-        return parent_index;
-    }
-
     // target index is either the max child (maxheap) or min child (min heap_adt)
     size_t target_index = parent_index;
-    heap_compare_t eval;
-
-    // grab the left child, because we know that it is there
-    size_t left_child_index = get_left_child_index(parent_index);
 
-
-    // perform the comparison between the parent and the left child. The
-    // return value is based on the heap_adt type. If the evaluation between
-    // parent and left is GT and the heap_adt type is GT_type, then set the
-    // parent as the target because the goal is to set the target as the
-    // heaptype == eval
-    eval = get_comparison(heap, parent_index, left_child_index);
-    if (eval != heap->heap_type)
+    // Children fill from left to right so only the children that are within
+    // the length of the heap exist. If there are none, the parent is returned.
+    size_t child_index = get_first_child_index(heap, parent_index);
+    size_t last_child_index = child_index + heap->arity;
+    if (last_child_index > heap->array_length)
     {
-        target_index = left_child_index;
+        last_child_index = heap->array_length;
     }
 
-
-    // If there is a right child, make the comparison between the
-    // target_index and the right child
-    if (has_right_child(heap, parent_index))
+    // A child only becomes the target when it is strictly ahead of the
+    // current target in the heap order. This avoids swapping equal nodes.
+    for (; child_index < last_child_index; child_index++)
     {
-        size_t right_child_index = get_right_child_index(parent_index);
-        eval = get_comparison(heap, target_index, right_child_index);
-        if (eval != heap->heap_type)
+        if (heap->heap_type == get_comparison(heap, child_index, target_index))
         {
-            target_index = right_child_index;
+            target_index = child_index;
         }
     }
     return target_index;
@@ -755,6 +1932,42 @@ static uint8_t * get_slice(heap_t * heap, size_t index)
     return (uint8_t *)heap->heap_array + get_index(index, heap->node_size);
 }
 
+/*!
+ * @brief Return the payload at the index. This is the stored pointer in
+ * HEAP_PTR mode and a pointer into the array in HEAP_MEM mode
+ * @param heap
+ * @param index
+ * @return Pointer to the payload
+ */
+static void * get_value(heap_t * heap, size_t index)
+{
+    if (is_keyed(heap))
+    {
+        return ((heap_key_slot_t *)get_slice(heap, index))->payload;
+    }
+    if (HEAP_PTR == heap->data_mode)
+    {
+        return heap->heap_array[index];
+    }
+    return get_slice(heap, index);
+}
+
+/*!
+ * @brief Return the address of the cell at the index in either mode. This is
+ * used to hand a part of the array to the functions working on arrays.
+ * @param heap
+ * @param index
+ * @return Pointer to the cell
+ */
+static void * get_cell(heap_t * heap, size_t index)
+{
+    if (is_pointer_array(heap))
+    {
+        return heap->heap_array + index;
+    }
+    return get_slice(heap, index);
+}
+
 /*!
  * Small function for calculating the index. This was part of get_slice but a
  * seperation was required for the inline sort function
@@ -767,6 +1980,17 @@ static size_t get_index(size_t index, size_t node_size)
     return index * node_size;
 }
 
+/*!
+ * @brief Return the size of a single cell in the heap array. This is the size
+ * of a pointer in HEAP_PTR mode and the size of the payload in HEAP_MEM mode
+ * @param heap
+ * @return Size of each cell in bytes
+ */
+static size_t get_slot_size(heap_t * heap)
+{
+    return (is_pointer_array(heap)) ? sizeof(void *) : heap->node_size;
+}
+
 
 /*!
  * @brief Small wrapper for getting the comparisons between nodes
@@ -778,23 +2002,172 @@ static heap_compare_t get_comparison(heap_t * heap,
                                      size_t left_index,
                                      size_t right_index)
 {
-    heap_compare_t result = 0;
+    STATS_ADD(heap, compares);
+    if (is_keyed(heap))
+    {
+        heap_key_slot_t * left = (heap_key_slot_t *)get_slice(heap, left_index);
+        heap_key_slot_t * right = (heap_key_slot_t *)get_slice(heap,
+                                                               right_index);
+        heap_compare_t comparison = compare_keys(heap, left, right);
+        if ((HEAP_EQ != comparison) || (NULL == heap->compare))
+        {
+            return comparison;
+        }
 
-    if (HEAP_PTR == heap->data_mode)
+        // Only equal keys fall through to the payloads
+        return heap->compare(left->payload, right->payload);
+    }
+    return heap->compare(get_value(heap, left_index),
+                         get_value(heap, right_index));
+}
+
+/*!
+ * @brief Compare the cached keys of two cells of a keyed heap
+ * @param heap
+ * @param left
+ * @param right
+ * @return The result of the comparison
+ */
+static heap_compare_t compare_keys(heap_t * heap,
+                                   heap_key_slot_t * left,
+                                   heap_key_slot_t * right)
+{
+    if (HEAP_KEY_DOUBLE == heap->key_type)
     {
-        result = heap->compare(
-            heap->heap_array[left_index],
-            heap->heap_array[right_index]
-        );
+        if (left->key.f64 > right->key.f64)
+        {
+            return HEAP_GT;
+        }
+        return (left->key.f64 < right->key.f64) ? HEAP_LT : HEAP_EQ;
+    }
+
+    if (left->key.u64 > right->key.u64)
+    {
+        return HEAP_GT;
+    }
+    return (left->key.u64 < right->key.u64) ? HEAP_LT : HEAP_EQ;
+}
+
+/*!
+ * @brief Make sure acquire_handle has a handle to hand out
+ * @param heap
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the handles could not grow
+ */
+static heap_result_t reserve_handle(heap_t * heap)
+{
+    if ((SIZE_MAX != heap->free_handle)
+        || (heap->handle_count < heap->handle_size))
+    {
+        return HEAP_SUCCESS;
+    }
+
+    // The slot has to fit in the lower half of a handle
+    if (heap->handle_count >= UINT32_MAX)
+    {
+        return HEAP_FAILURE;
+    }
+
+    // An array left larger by a failed second realloc is harmless
+    size_t handle_size = heap->handle_size * 2;
+    void * re_alloc = realloc(heap->handle_positions,
+                              sizeof(size_t) * handle_size);
+    if (INVALID_PTR == verify_alloc(re_alloc))
+    {
+        return HEAP_FAILURE;
+    }
+    heap->handle_positions = re_alloc;
+
+    re_alloc = realloc(heap->handle_generations,
+                       sizeof(uint32_t) * handle_size);
+    if (INVALID_PTR == verify_alloc(re_alloc))
+    {
+        return HEAP_FAILURE;
+    }
+    heap->handle_generations = re_alloc;
+
+    // Slots start at generation 0 and only count up from then on, even when
+    // heap_dump hands them out again
+    memset(heap->handle_generations + heap->handle_size, 0,
+           sizeof(uint32_t) * (handle_size - heap->handle_size));
+    heap->handle_size = handle_size;
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Hand out a handle for the node at the index. Released handles are
+ * reused before new ones are created. A handle must have been reserved.
+ * @param heap
+ * @param index Index of the node in the heap_array
+ * @return The handle
+ */
+static heap_handle_t acquire_handle(heap_t * heap, size_t index)
+{
+    size_t slot = heap->free_handle;
+    if (SIZE_MAX != slot)
+    {
+        // Released slots are chained through their position
+        heap->free_handle = heap->handle_positions[slot];
     }
     else
     {
-        result = heap->compare(
-            get_slice(heap, left_index),
-            get_slice(heap, right_index)
-        );
+        slot = heap->handle_count;
+        heap->handle_count++;
     }
 
-    return result;
+    heap->handle_positions[slot] = index;
+    heap->slot_handles[index] = slot;
+    return ((heap_handle_t)heap->handle_generations[slot] << 32) | slot;
+}
+
+/*!
+ * @brief Put the slot back on the list of slots to reuse. Its generation
+ * changes so the handles handed out for it stop matching.
+ * @param heap
+ * @param slot
+ */
+static void release_handle(heap_t * heap, size_t slot)
+{
+    heap->handle_generations[slot]++;
+    heap->handle_positions[slot] = heap->free_handle;
+    heap->free_handle = slot;
+}
+
+/*!
+ * @brief Return the slot of the handle
+ * @param handle
+ * @return Slot in the handle arrays
+ */
+static size_t get_handle_slot(heap_handle_t handle)
+{
+    return (size_t)(handle & UINT32_MAX);
+}
+
+/*!
+ * @brief Return true if the heap was created with heap_init_indexed
+ * @param heap
+ * @return bool
+ */
+static bool is_indexed(heap_t * heap)
+{
+    return NULL != heap->slot_handles;
+}
+
+/*!
+ * @brief Check if the heap caches a key next to each payload
+ * @param heap
+ * @return True if the heap was created with heap_init_keyed
+ */
+static bool is_keyed(heap_t * heap)
+{
+    return HEAP_KEY_NONE != heap->key_type;
 }
 
+/*!
+ * @brief Check if the cells of the heap array are bare pointers
+ * @param heap
+ * @return True for HEAP_PTR heaps that are not keyed
+ */
+static bool is_pointer_array(heap_t * heap)
+{
+    return (HEAP_PTR == heap->data_mode) && (!(is_keyed(heap)));
+}
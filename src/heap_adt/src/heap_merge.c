@@ -0,0 +1,328 @@
+#include <heap_merge.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+// Enum for determining if malloc calls were valid
+typedef enum
+{
+    VALID_PTR = 1,
+    INVALID_PTR = 0
+} merge_pointer_t;
+
+typedef struct heap_merge_t
+{
+    heap_t * runs;                  // HEAP_PTR heap of merge_run_t
+    size_t run_count;               // Number of runs ever added
+    size_t slot_size;               // Size of an item or of a pointer
+    heap_data_mode_t data_mode;
+    heap_compare_t heap_type;
+    heap_compare_t (* compare)(void * payload, void * payload2);
+} heap_merge_t;
+
+// Cursor of a single run. Array runs point into the callers array while
+// source runs keep the last produced item in the item buffer.
+typedef struct merge_run_t
+{
+    heap_merge_t * merge;
+    size_t sequence;                // Order the run was added in
+    uint8_t * current;              // Next item of an array run
+    uint8_t * end;                  // One past the last item of an array run
+    heap_run_next_t next;           // Producer of a source run or NULL
+    void * context;
+    max_align_t item[];             // Current item of a source run
+} merge_run_t;
+
+static merge_run_t * create_run(heap_merge_t * merge);
+static bool advance_run(merge_run_t * run);
+static heap_compare_t compare_runs(void * payload, void * payload2);
+
+static uint8_t * get_run_slot(merge_run_t * run);
+static void * get_run_value(merge_run_t * run);
+static merge_pointer_t verify_alloc(void * ptr);
+
+
+
+/*!
+ * @brief Create a k-way merge of sorted runs
+ *
+ * The runs are added with heap_merge_add_array and heap_merge_add_source and
+ * the merged items are read one at a time with heap_merge_next. Every run
+ * must already be sorted in the order of the type, lowest first for
+ * MIN_HEAP and highest first for MAX_HEAP.
+ *
+ * The merge keeps a heap of one cursor per run, so reading an item costs
+ * O(log k) and the merge never holds more than one item per run. Items that
+ * compare equal are returned in the order their runs were added.
+ * @param type MIN_HEAP merges lowest first and MAX_HEAP highest first
+ * @param data_mode Data storage strategy of the runs
+ * @param payload_size The size of each item. This can be 0 if using HEAP_PTR
+ * @param compare Pointer to function that compares the items
+ * @return Pointer to heap_merge_t or NULL
+ */
+heap_merge_t * heap_merge_init(heap_type_t type,
+                               heap_data_mode_t data_mode,
+                               size_t payload_size,
+                               heap_compare_t (* compare)(void *, void *))
+{
+    assert(compare);
+    heap_merge_t * merge = (heap_merge_t *)malloc(sizeof(heap_merge_t));
+    if (INVALID_PTR == verify_alloc((void *)merge))
+    {
+        return NULL;
+    }
+
+    * merge = (heap_merge_t){
+        .runs           = NULL,
+        .run_count      = 0,
+        .slot_size      = (HEAP_PTR == data_mode) ? sizeof(void *)
+                                                  : payload_size,
+        .data_mode      = data_mode,
+        .heap_type      = type ? HEAP_LT : HEAP_GT,
+        .compare        = compare
+    };
+
+    // The runs left in the heap are freed with the heap
+    merge->runs = heap_init(type, HEAP_PTR, 0, free, compare_runs,
+                            HEAP_BINARY);
+    if (NULL == merge->runs)
+    {
+        free(merge);
+        return NULL;
+    }
+    return merge;
+}
+
+/*!
+ * @brief Destroy the merge. The runs themselves are owned by the caller and
+ * are not modified.
+ * @param merge
+ */
+void heap_merge_destroy(heap_merge_t * merge)
+{
+    assert(merge);
+    heap_destroy(merge->runs);
+    free(merge);
+}
+
+/*!
+ * @brief Add a sorted array as a run. The array is read in place and must
+ * stay valid until the merge has read all of it.
+ * @param merge
+ * @param array Array of pointers (HEAP_PTR) or array of items (HEAP_MEM)
+ * @param item_count Number of items in the array
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the cursor could not be allocated
+ */
+heap_result_t heap_merge_add_array(heap_merge_t * merge,
+                                   void * array,
+                                   size_t item_count)
+{
+    assert(merge);
+    if (0 == item_count)
+    {
+        return HEAP_SUCCESS;
+    }
+    assert(array);
+
+    merge_run_t * run = create_run(merge);
+    if (NULL == run)
+    {
+        return HEAP_FAILURE;
+    }
+    run->current = (uint8_t *)array;
+    run->end = run->current + (item_count * merge->slot_size);
+    heap_insert(merge->runs, run);
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Add a run whose items are produced on demand by the next function.
+ * The first item is produced right away, the others as the merge reads
+ * them.
+ * @param merge
+ * @param next Producer of the items of the run
+ * @param context Passed to every call of next
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the cursor could not be allocated
+ */
+heap_result_t heap_merge_add_source(heap_merge_t * merge,
+                                    heap_run_next_t next,
+                                    void * context)
+{
+    assert(merge);
+    assert(next);
+    merge_run_t * run = create_run(merge);
+    if (NULL == run)
+    {
+        return HEAP_FAILURE;
+    }
+    run->next = next;
+    run->context = context;
+
+    if (!advance_run(run))
+    {
+        free(run);
+        return HEAP_SUCCESS;
+    }
+    heap_insert(merge->runs, run);
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Copy the next item of the merge into out
+ * @param merge
+ * @param out Memory of the payload size in HEAP_MEM mode or a pointer to a
+ * void pointer in HEAP_PTR mode
+ * @return HEAP_SUCCESS or HEAP_FAILURE once every run is exhausted
+ */
+heap_result_t heap_merge_next(heap_merge_t * merge, void * out)
+{
+    assert(merge);
+    assert(out);
+    merge_run_t * run = (merge_run_t *)heap_peek_ref(merge->runs);
+    if (NULL == run)
+    {
+        return HEAP_FAILURE;
+    }
+    memcpy(out, get_run_slot(run), merge->slot_size);
+
+    // The advanced run goes back in place of the root with a single bubble
+    // down. The old root is the same run so it must not be freed.
+    merge_run_t * old_root = NULL;
+    if (advance_run(run))
+    {
+        heap_replace_root(merge->runs, run, &old_root);
+    }
+    else
+    {
+        heap_pop_into(merge->runs, &old_root);
+        free(old_root);
+    }
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Check if every run of the merge is exhausted
+ * @param merge
+ * @return True if heap_merge_next has no items left to return
+ */
+bool heap_merge_is_empty(heap_merge_t * merge)
+{
+    assert(merge);
+    return heap_is_empty(merge->runs);
+}
+
+/*!
+ * @brief Allocate a run with an item buffer large enough for one item
+ * @param merge
+ * @return Pointer to the run or NULL
+ */
+static merge_run_t * create_run(heap_merge_t * merge)
+{
+    merge_run_t * run = (merge_run_t *)malloc(sizeof(merge_run_t)
+                                              + merge->slot_size);
+    if (INVALID_PTR == verify_alloc((void *)run))
+    {
+        return NULL;
+    }
+
+    * run = (merge_run_t){
+        .merge      = merge,
+        .sequence   = merge->run_count,
+        .current    = NULL,
+        .end        = NULL,
+        .next       = NULL,
+        .context    = NULL
+    };
+    merge->run_count++;
+    return run;
+}
+
+/*!
+ * @brief Move the run to its next item
+ * @param run
+ * @return True if the run has a current item, false once it is exhausted
+ */
+static bool advance_run(merge_run_t * run)
+{
+    if (NULL != run->next)
+    {
+        return HEAP_SUCCESS == run->next(run->context, run->item);
+    }
+    run->current += run->merge->slot_size;
+    return run->current != run->end;
+}
+
+/*!
+ * @brief Compare function of the heap of runs. Compares the current items
+ * with the callers compare function and breaks ties with the order the runs
+ * were added in, so that the merge is stable.
+ * @param payload merge_run_t
+ * @param payload2 merge_run_t
+ * @return Comparison of the current items of the runs
+ */
+static heap_compare_t compare_runs(void * payload, void * payload2)
+{
+    merge_run_t * left = (merge_run_t *)payload;
+    merge_run_t * right = (merge_run_t *)payload2;
+    heap_merge_t * merge = left->merge;
+
+    heap_compare_t result = merge->compare(get_run_value(left),
+                                           get_run_value(right));
+    if (HEAP_EQ != result)
+    {
+        return result;
+    }
+
+    // The run added first wins the tie
+    if (left->sequence < right->sequence)
+    {
+        return merge->heap_type;
+    }
+    return (HEAP_LT == merge->heap_type) ? HEAP_GT : HEAP_LT;
+}
+
+/*!
+ * @brief Return the cell holding the current item of the run
+ * @param run
+ * @return Pointer into the array or into the item buffer of the run
+ */
+static uint8_t * get_run_slot(merge_run_t * run)
+{
+    if (NULL != run->next)
+    {
+        return (uint8_t *)run->item;
+    }
+    return run->current;
+}
+
+/*!
+ * @brief Return the current item of the run. This is the stored pointer in
+ * HEAP_PTR mode and a pointer to the item in HEAP_MEM mode
+ * @param run
+ * @return Pointer to the item
+ */
+static void * get_run_value(merge_run_t * run)
+{
+    uint8_t * slot = get_run_slot(run);
+    if (HEAP_PTR == run->merge->data_mode)
+    {
+        return * (void **)slot;
+    }
+    return slot;
+}
+
+/*!
+ * @brief Verify that the allocation was successful
+ * @param ptr Any allocated pointer
+ */
+static merge_pointer_t verify_alloc(void * ptr)
+{
+    if (NULL == ptr)
+    {
+        fprintf(stderr, "[!] Could not allocate memory!\n");
+        return INVALID_PTR;
+    }
+    return VALID_PTR;
+}
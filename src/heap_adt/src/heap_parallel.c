@@ -0,0 +1,219 @@
+#include <heap.h>
+#include <heap_merge.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <assert.h>
+
+typedef enum
+{
+    PARALLEL_MIN_RUN = 4096,        // Fewest items worth sorting on a thread
+} heap_parallel_default_t;
+
+// Slice of the array sorted by a single thread
+typedef struct sort_run_t
+{
+    uint8_t * start;                // First item of the run
+    size_t item_count;              // Number of items in the run
+    size_t item_size;               // Item size as passed to heap_sort
+    heap_data_mode_t data_mode;
+    heap_type_t type;
+    heap_compare_t (* compare)(void * payload, void * payload2);
+    pthread_t thread;
+    bool is_threaded;               // False if sorted on the calling thread
+} sort_run_t;
+
+static void * sort_run(void * arg);
+static heap_result_t merge_runs(sort_run_t * runs,
+                                size_t run_count,
+                                size_t slot_size,
+                                uint8_t * out);
+
+static size_t get_run_count(size_t item_count, size_t thread_count);
+
+
+
+/*!
+ * @brief Sort the array using several threads
+ *
+ * The array is split into one run per thread and every run is heap sorted in
+ * place on its own thread. The sorted runs are then merged with a heap of
+ * cursors, one per run, into a scratch array that is copied back over the
+ * array. The array is sorted in the same direction as heap_sort, the
+ * relative order of equal items is unspecified.
+ *
+ * Arrays too small to be worth a thread, or a failed allocation of the
+ * scratch array, fall back to heap_sort on the calling thread.
+ * @param array Array of pointers (HEAP_PTR) or array of items (HEAP_MEM)
+ * @param item_count Number of items in the array
+ * @param item_size Size of each item. This can be 0 if using HEAP_PTR
+ * @param data_mode Data storage strategy of the array
+ * @param type MIN_HEAP sorts lowest first and MAX_HEAP highest first
+ * @param compare Pointer to function that compares the items
+ * @param thread_count Number of threads, 0 uses one thread per processor
+ * @return HEAP_SUCCESS once the array is sorted
+ */
+heap_result_t heap_sort_parallel(void * array,
+                                 size_t item_count,
+                                 size_t item_size,
+                                 heap_data_mode_t data_mode,
+                                 heap_type_t type,
+                                 heap_compare_t (* compare)(void *, void *),
+                                 size_t thread_count)
+{
+    assert(array);
+    assert(compare);
+    size_t slot_size = (HEAP_PTR == data_mode) ? sizeof(void *) : item_size;
+    size_t run_count = get_run_count(item_count, thread_count);
+    sort_run_t * runs = NULL;
+    uint8_t * merged = NULL;
+    if (run_count > 1)
+    {
+        runs = (sort_run_t *)calloc(run_count, sizeof(sort_run_t));
+        merged = (uint8_t *)malloc(item_count * slot_size);
+    }
+    if ((NULL == runs) || (NULL == merged))
+    {
+        free(runs);
+        free(merged);
+        heap_sort(array, item_count, item_size, data_mode, type, compare);
+        return HEAP_SUCCESS;
+    }
+
+    // Spread the remainder over the first runs so no run is more than one
+    // item longer than another
+    uint8_t * start = (uint8_t *)array;
+    for (size_t i = 0; i < run_count; i++)
+    {
+        size_t run_length = (item_count / run_count)
+                            + ((i < (item_count % run_count)) ? 1 : 0);
+        runs[i] = (sort_run_t){
+            .start          = start,
+            .item_count     = run_length,
+            .item_size      = item_size,
+            .data_mode      = data_mode,
+            .type           = type,
+            .compare        = compare,
+            .is_threaded    = false
+        };
+        start += run_length * slot_size;
+    }
+
+    // The first run is sorted by the calling thread. Runs whose thread could
+    // not be created are sorted by the calling thread as well.
+    for (size_t i = 1; i < run_count; i++)
+    {
+        runs[i].is_threaded =
+            (0 == pthread_create(&runs[i].thread, NULL, sort_run, &runs[i]));
+    }
+    for (size_t i = 0; i < run_count; i++)
+    {
+        if (!runs[i].is_threaded)
+        {
+            sort_run(&runs[i]);
+        }
+    }
+    for (size_t i = 1; i < run_count; i++)
+    {
+        if (runs[i].is_threaded)
+        {
+            pthread_join(runs[i].thread, NULL);
+        }
+    }
+
+    if (HEAP_SUCCESS == merge_runs(runs, run_count, slot_size, merged))
+    {
+        memcpy(array, merged, item_count * slot_size);
+    }
+    else
+    {
+        heap_sort(array, item_count, item_size, data_mode, type, compare);
+    }
+    free(runs);
+    free(merged);
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Thread function sorting a single run in place
+ * @param arg Pointer to the sort_run_t
+ * @return NULL
+ */
+static void * sort_run(void * arg)
+{
+    sort_run_t * run = (sort_run_t *)arg;
+    heap_sort(run->start,
+              run->item_count,
+              run->item_size,
+              run->data_mode,
+              run->type,
+              run->compare);
+    return NULL;
+}
+
+/*!
+ * @brief Merge the sorted runs into the out array with a k-way merge
+ * @param runs Sorted runs
+ * @param run_count Number of runs
+ * @param slot_size Size of each cell of the array
+ * @param out Array large enough for every item of the runs
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the merge could not be created
+ */
+static heap_result_t merge_runs(sort_run_t * runs,
+                                size_t run_count,
+                                size_t slot_size,
+                                uint8_t * out)
+{
+    heap_merge_t * merge = heap_merge_init(runs[0].type,
+                                           runs[0].data_mode,
+                                           runs[0].item_size,
+                                           runs[0].compare);
+    if (NULL == merge)
+    {
+        return HEAP_FAILURE;
+    }
+
+    for (size_t i = 0; i < run_count; i++)
+    {
+        if (HEAP_SUCCESS != heap_merge_add_array(merge,
+                                                 runs[i].start,
+                                                 runs[i].item_count))
+        {
+            heap_merge_destroy(merge);
+            return HEAP_FAILURE;
+        }
+    }
+
+    while (HEAP_SUCCESS == heap_merge_next(merge, out))
+    {
+        out += slot_size;
+    }
+    heap_merge_destroy(merge);
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Return the number of runs to split the array into. Every run gets
+ * at least PARALLEL_MIN_RUN items.
+ * @param item_count
+ * @param thread_count Requested number of threads, 0 for one per processor
+ * @return Number of runs, 1 if the array should not be split
+ */
+static size_t get_run_count(size_t item_count, size_t thread_count)
+{
+    if (0 == thread_count)
+    {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = (processors > 0) ? (size_t)processors : 1;
+    }
+
+    size_t max_runs = item_count / PARALLEL_MIN_RUN;
+    if (thread_count > max_runs)
+    {
+        thread_count = max_runs;
+    }
+    return (0 == thread_count) ? 1 : thread_count;
+}
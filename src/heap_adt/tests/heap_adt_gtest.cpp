@@ -1,5 +1,11 @@
 #include <gtest/gtest.h>
 #include <heap.h>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
 
 /*
  * Heap structure supports printing your data by passing a callback to a
@@ -113,25 +119,29 @@ class HeapTestFixture : public ::testing::Test
                                  HEAP_PTR,
                                  0,
                                  payload_destroy,
-                                 heap_ptr_cmp);
+                                 heap_ptr_cmp,
+                                 HEAP_BINARY);
 
         min_heap_ptr = heap_init(MIN_HEAP,
                                  HEAP_PTR,
                                  0,
                                  payload_destroy,
-                                 heap_ptr_cmp);
+                                 heap_ptr_cmp,
+                                 HEAP_BINARY);
 
         max_heap_data = heap_init(MAX_HEAP,
                                   HEAP_MEM,
                                   sizeof(int32_t),
                                   nullptr,
-                                  heap_data_cmp
+                                  heap_data_cmp,
+                                  HEAP_BINARY
         );
         min_heap_data = heap_init(MIN_HEAP,
                                   HEAP_MEM,
                                   sizeof(int32_t),
                                   nullptr,
-                                  heap_data_cmp
+                                  heap_data_cmp,
+                                  HEAP_BINARY
         );
         ASSERT_NE(max_heap_ptr, nullptr);
         ASSERT_NE(min_heap_ptr, nullptr);
@@ -214,6 +224,44 @@ TEST_F(HeapTestFixture, TestAllPopAndOrder)
     }
 }
 
+// Ensure that popping into caller owned storage produces the same order as
+// the allocating pop for both modes
+TEST_F(HeapTestFixture, TestPopIntoOrder)
+{
+    int32_t value = 0;
+    int * ptr_payload = nullptr;
+    size_t count = 0;
+    while (HEAP_SUCCESS == heap_pop_into(min_heap_data, &value))
+    {
+        EXPECT_EQ(value, test_values[count]);
+
+        ASSERT_EQ(heap_pop_into(max_heap_ptr, &ptr_payload), HEAP_SUCCESS);
+        EXPECT_EQ(* ptr_payload, test_values[(test_values.size() - 1) - count]);
+        payload_destroy(ptr_payload);
+        count++;
+    }
+    EXPECT_EQ(count, test_values.size());
+    EXPECT_TRUE(heap_is_empty(max_heap_ptr));
+    EXPECT_EQ(heap_pop_into(max_heap_ptr, &ptr_payload), HEAP_FAILURE);
+}
+
+// Peeking returns a borrowed reference to the root without removing it
+TEST_F(HeapTestFixture, TestPeekRef)
+{
+    EXPECT_EQ(* (int32_t *)heap_peek_ref(max_heap_data), get_max());
+    EXPECT_EQ(* (int32_t *)heap_peek_ref(min_heap_data), get_min());
+    EXPECT_EQ(* (int *)heap_peek_ref(max_heap_ptr), get_max());
+
+    // The pointer mode peek is the same pointer that is popped
+    void * peeked = heap_peek_ref(min_heap_ptr);
+    void * popped = heap_pop(min_heap_ptr);
+    EXPECT_EQ(peeked, popped);
+    payload_destroy(popped);
+
+    heap_dump(max_heap_ptr);
+    EXPECT_EQ(heap_peek_ref(max_heap_ptr), nullptr);
+}
+
 // take a dump
 TEST_F(HeapTestFixture, DumpHeap)
 {
@@ -296,6 +344,263 @@ TEST(HeapSort, HeapSortTestPtrModeMax)
     free(int_ptr_array);
 }
 
+// Sort records larger than the internal swap buffer to make sure that the
+// whole record is moved with the key
+TEST(HeapSort, HeapSortTestMemModeLargeRecords)
+{
+    typedef struct
+    {
+        int32_t key;
+        char text[124];
+    } record_t;
+
+    const int32_t record_count = 257;
+    std::vector<record_t> records(record_count);
+    for (int32_t i = 0; i < record_count; i++)
+    {
+        records[i].key = (i * 7919) % record_count;
+        snprintf(records[i].text, sizeof(records[i].text), "%d", records[i].key);
+    }
+
+    heap_sort(records.data(), records.size(), sizeof(record_t), HEAP_MEM,
+              MIN_HEAP, heap_data_cmp);
+
+    for (int32_t i = 0; i < record_count; i++)
+    {
+        EXPECT_EQ(records[i].key, i);
+        EXPECT_EQ(atoi(records[i].text), i);
+    }
+}
+
+// Large enough for several runs, with a count that does not split evenly
+TEST(HeapSort, ParallelMatchesSequential)
+{
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int32_t> dist(-100000, 100000);
+    std::vector<int32_t> values(50001);
+    for (int32_t & value : values)
+    {
+        value = dist(rng);
+    }
+
+    for (size_t thread_count : {(size_t)0, (size_t)1, (size_t)3, (size_t)8})
+    {
+        std::vector<int32_t> ascending = values;
+        std::vector<int32_t> descending = values;
+        EXPECT_EQ(heap_sort_parallel(ascending.data(), ascending.size(),
+                                     sizeof(int32_t), HEAP_MEM, MIN_HEAP,
+                                     heap_data_cmp, thread_count),
+                  HEAP_SUCCESS);
+        EXPECT_EQ(heap_sort_parallel(descending.data(), descending.size(),
+                                     sizeof(int32_t), HEAP_MEM, MAX_HEAP,
+                                     heap_data_cmp, thread_count),
+                  HEAP_SUCCESS);
+
+        std::vector<int32_t> expected = values;
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(ascending, expected);
+        std::reverse(expected.begin(), expected.end());
+        EXPECT_EQ(descending, expected);
+    }
+}
+
+TEST(HeapSort, ParallelPtrMode)
+{
+    const int count = 20000;
+    std::vector<int *> pointers(count);
+    for (int i = 0; i < count; i++)
+    {
+        pointers[(size_t)i] = create_heap_payload((i * 7919) % count);
+    }
+
+    heap_sort_parallel(pointers.data(), pointers.size(), 0, HEAP_PTR,
+                       MIN_HEAP, heap_ptr_cmp, 4);
+    for (int i = 0; i < count; i++)
+    {
+        EXPECT_EQ(* pointers[(size_t)i], i);
+        free(pointers[(size_t)i]);
+    }
+}
+
+TEST(HeapSort, ParallelSmallArray)
+{
+    int32_t values[] = {5, 3, 9, 1, 7};
+    heap_sort_parallel(values, 5, sizeof(int32_t), HEAP_MEM, MIN_HEAP,
+                       heap_data_cmp, 4);
+    int32_t expected[] = {1, 3, 5, 7, 9};
+    for (size_t i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(values[i], expected[i]);
+    }
+}
+
+TEST(HeapReplaceRoot, ReplaceKeepsOrder)
+{
+    heap_t * heap = heap_init(MIN_HEAP, HEAP_MEM, sizeof(int32_t), nullptr,
+                              heap_data_cmp, HEAP_BINARY);
+    int32_t value = 0;
+    EXPECT_EQ(heap_replace_root(heap, &value, nullptr), HEAP_FAILURE);
+    for (value = 0; value < 10; value++)
+    {
+        heap_insert(heap, &value);
+    }
+
+    int32_t replacement = 100;
+    int32_t old_root = -1;
+    EXPECT_EQ(heap_replace_root(heap, &replacement, &old_root), HEAP_SUCCESS);
+    EXPECT_EQ(old_root, 0);
+    EXPECT_EQ(* (int32_t *)heap_peek_ref(heap), 1);
+
+    for (int32_t expected : {1, 2, 3, 4, 5, 6, 7, 8, 9, 100})
+    {
+        ASSERT_EQ(heap_pop_into(heap, &value), HEAP_SUCCESS);
+        EXPECT_EQ(value, expected);
+    }
+    heap_destroy(heap);
+
+    heap = heap_init_indexed(MIN_HEAP, HEAP_MEM, sizeof(int32_t), nullptr,
+                             heap_data_cmp, HEAP_BINARY);
+    heap_insert_handle(heap, &value);
+    EXPECT_EQ(heap_replace_root(heap, &replacement, nullptr), HEAP_FAILURE);
+    heap_destroy(heap);
+}
+
+/*
+ * Run the pop order for every supported arity. Random values with duplicates
+ * are inserted and popped in batches to exercise both bubbling directions
+ */
+class HeapArityTest : public ::testing::TestWithParam<heap_arity_t>
+{
+};
+
+TEST_P(HeapArityTest, TestPopOrder)
+{
+    heap_t * heap = heap_init(MIN_HEAP, HEAP_MEM, sizeof(int32_t), nullptr,
+                              heap_data_cmp, GetParam());
+    ASSERT_NE(heap, nullptr);
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int32_t> dist(-1000, 1000);
+    std::vector<int32_t> expected;
+    for (int round = 0; round < 4; round++)
+    {
+        for (int i = 0; i < 500; i++)
+        {
+            int32_t value = dist(rng);
+            expected.push_back(value);
+            heap_insert(heap, &value);
+        }
+
+        // Pop half of the items out before the next round of inserts
+        std::sort(expected.begin(), expected.end());
+        size_t pop_count = expected.size() / 2;
+        for (size_t i = 0; i < pop_count; i++)
+        {
+            int32_t value = 0;
+            ASSERT_EQ(heap_pop_into(heap, &value), HEAP_SUCCESS);
+            EXPECT_EQ(value, expected[i]);
+        }
+        expected.erase(expected.begin(), expected.begin() + (long)pop_count);
+    }
+
+    for (int32_t target: expected)
+    {
+        int32_t value = 0;
+        ASSERT_EQ(heap_pop_into(heap, &value), HEAP_SUCCESS);
+        EXPECT_EQ(value, target);
+    }
+    EXPECT_TRUE(heap_is_empty(heap));
+    heap_destroy(heap);
+}
+
+TEST_P(HeapArityTest, TestFromArray)
+{
+    std::vector<int32_t> values(1000);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        values[i] = (int32_t)((i * 7919) % values.size());
+    }
+    heap_t * heap = heap_init_from_array(MAX_HEAP, HEAP_MEM, sizeof(int32_t),
+                                         nullptr, heap_data_cmp,
+                                         values.data(), values.size(),
+                                         HEAP_COPY, GetParam());
+    ASSERT_NE(heap, nullptr);
+
+    int32_t value = 0;
+    for (int32_t target = (int32_t)values.size() - 1; target >= 0; target--)
+    {
+        ASSERT_EQ(heap_pop_into(heap, &value), HEAP_SUCCESS);
+        EXPECT_EQ(value, target);
+    }
+    heap_destroy(heap);
+}
+
+INSTANTIATE_TEST_SUITE_P(HeapArity,
+                         HeapArityTest,
+                         ::testing::Values(HEAP_BINARY, HEAP_4_ARY, HEAP_8_ARY));
+
+// Heaps created from an array are built in place from the copied items
+TEST(HeapFromArray, HeapFromArrayCopy)
+{
+    int my_array[] = {5, 8, 2, 8, 9, 2, 3, 40, 1, 78};
+    int my_array_order[] = {1, 2, 2, 3, 5, 8, 8, 9, 40, 78};
+    int array_length = 10;
+
+    heap_t * heap = heap_init_from_array(MIN_HEAP, HEAP_MEM, sizeof(int),
+                                         nullptr, heap_data_cmp, my_array,
+                                         (size_t)array_length, HEAP_COPY,
+                                         HEAP_BINARY);
+    ASSERT_NE(heap, nullptr);
+
+    // The callers array is left untouched
+    EXPECT_EQ(my_array[0], 5);
+
+    // Inserting after creation grows the heap as usual
+    int extra = 0;
+    heap_insert(heap, &extra);
+    int value = 0;
+    ASSERT_EQ(heap_pop_into(heap, &value), HEAP_SUCCESS);
+    EXPECT_EQ(value, 0);
+
+    for (int i = 0; i < array_length; i++)
+    {
+        ASSERT_EQ(heap_pop_into(heap, &value), HEAP_SUCCESS);
+        EXPECT_EQ(value, my_array_order[i]);
+    }
+    EXPECT_TRUE(heap_is_empty(heap));
+    heap_destroy(heap);
+}
+
+// Adopting an array hands the ownership of the array to the heap
+TEST(HeapFromArray, HeapFromArrayAdopt)
+{
+    int my_array[] = {5, 8, 2, 8, 9, 2, 3, 40, 1, 78};
+    int my_array_order[] = {1, 2, 2, 3, 5, 8, 8, 9, 40, 78};
+    size_t array_length = 10;
+
+    int ** int_ptr_array = (int **)malloc(array_length * sizeof(void *));
+    for (size_t i = 0; i < array_length; i++)
+    {
+        int_ptr_array[i] = create_heap_payload(my_array[i]);
+    }
+
+    heap_t * heap = heap_init_from_array(MAX_HEAP, HEAP_PTR, 0,
+                                         payload_destroy, heap_ptr_cmp,
+                                         int_ptr_array, array_length,
+                                         HEAP_ADOPT, HEAP_4_ARY);
+    ASSERT_NE(heap, nullptr);
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        int * payload = (int *)heap_pop(heap);
+        EXPECT_EQ(* payload, my_array_order[array_length - (i + 1)]);
+        payload_destroy(payload);
+    }
+
+    // The rest of the payloads and the adopted array are freed by the heap
+    heap_destroy(heap);
+}
+
 /*
  * Test the ability to find the nth item in the heap_adt. The array passed in is
  * first heapafied
@@ -325,6 +630,502 @@ TEST(HeapSortFind, HeapFindTestPtrModeMax)
     free(int_ptr_array);
 }
 
+// Selecting the nth item must match a full sort for both the bounded heap
+// path (ranks near either end) and the introselect path (ranks in the middle)
+TEST(HeapSelect, HeapSelectNthMatchesSort)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int32_t> dist(0, 500);
+    std::vector<int32_t> values(5000);
+    for (int32_t& value: values)
+    {
+        value = dist(rng);
+    }
+    std::vector<int32_t> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+
+    for (size_t nth: {(size_t)1, (size_t)10, (size_t)2500, (size_t)4000,
+                      (size_t)4999, (size_t)5000})
+    {
+        std::vector<int32_t> work = values;
+        int32_t found = -1;
+        ASSERT_EQ(heap_select_nth(work.data(), work.size(), sizeof(int32_t),
+                                  nth, HEAP_MEM, MIN_HEAP, heap_data_cmp,
+                                  &found), HEAP_SUCCESS);
+        EXPECT_EQ(found, sorted[nth - 1]) << "nth: " << nth;
+
+        work = values;
+        ASSERT_EQ(heap_select_nth(work.data(), work.size(), sizeof(int32_t),
+                                  nth, HEAP_MEM, MAX_HEAP, heap_data_cmp,
+                                  &found), HEAP_SUCCESS);
+        EXPECT_EQ(found, sorted[sorted.size() - nth]) << "nth: " << nth;
+    }
+
+    int32_t found = 0;
+    EXPECT_EQ(heap_select_nth(values.data(), values.size(), sizeof(int32_t),
+                              0, HEAP_MEM, MIN_HEAP, heap_data_cmp, &found),
+              HEAP_FAILURE);
+    EXPECT_EQ(heap_select_nth(values.data(), values.size(), sizeof(int32_t),
+                              values.size() + 1, HEAP_MEM, MIN_HEAP,
+                              heap_data_cmp, &found),
+              HEAP_FAILURE);
+}
+
+// Sorted and constant input are the worst cases for a naive quick select
+TEST(HeapSelect, HeapSelectNthDegenerateInput)
+{
+    std::vector<int32_t> ascending(20000);
+    for (size_t i = 0; i < ascending.size(); i++)
+    {
+        ascending[i] = (int32_t)i;
+    }
+    int32_t found = -1;
+    ASSERT_EQ(heap_select_nth(ascending.data(), ascending.size(),
+                              sizeof(int32_t), 7000, HEAP_MEM, MIN_HEAP,
+                              heap_data_cmp, &found), HEAP_SUCCESS);
+    EXPECT_EQ(found, 6999);
+
+    std::vector<int32_t> constant(20000, 7);
+    ASSERT_EQ(heap_select_nth(constant.data(), constant.size(),
+                              sizeof(int32_t), 9000, HEAP_MEM, MAX_HEAP,
+                              heap_data_cmp, &found), HEAP_SUCCESS);
+    EXPECT_EQ(found, 7);
+}
+
+// Pointer mode returns the pointer stored in the array
+TEST(HeapSelect, HeapSelectNthPtrMode)
+{
+    std::vector<int> values(3000);
+    std::vector<int *> pointers(values.size());
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        values[i] = (int)((i * 7919) % values.size());
+        pointers[i] = &values[i];
+    }
+
+    int * found = nullptr;
+    ASSERT_EQ(heap_select_nth(pointers.data(), pointers.size(), 0, 1500,
+                              HEAP_PTR, MAX_HEAP, heap_ptr_cmp, &found),
+              HEAP_SUCCESS);
+    EXPECT_EQ(* found, 1500);
+    EXPECT_GE(found, values.data());
+    EXPECT_LT(found, values.data() + values.size());
+}
+
+// The top k items are written best first without touching the input
+TEST(HeapSelect, HeapTopKArray)
+{
+    int my_array[] = {5, 8, 2, 8, 9, 2, 3, 40, 1, 78};
+    int top[4] = {0};
+
+    size_t written = heap_top_k(my_array, 10, sizeof(int), 4, HEAP_MEM,
+                                MAX_HEAP, heap_data_cmp, top);
+    ASSERT_EQ(written, 4);
+    EXPECT_EQ(top[0], 78);
+    EXPECT_EQ(top[1], 40);
+    EXPECT_EQ(top[2], 9);
+    EXPECT_EQ(top[3], 8);
+    EXPECT_EQ(my_array[0], 5);
+
+    int all[12] = {0};
+    written = heap_top_k(my_array, 10, sizeof(int), 12, HEAP_MEM, MIN_HEAP,
+                         heap_data_cmp, all);
+    ASSERT_EQ(written, 10);
+    EXPECT_EQ(all[0], 1);
+    EXPECT_EQ(all[9], 78);
+}
+
+// The accumulator only ever keeps k items and frees the dropped payloads
+TEST(HeapSelect, HeapTopKAccumulator)
+{
+    heap_top_k_t * top_k = heap_top_k_init(3, MIN_HEAP, HEAP_PTR, 0,
+                                           payload_destroy, heap_ptr_cmp);
+    ASSERT_NE(top_k, nullptr);
+
+    int stream[] = {50, 7, 90, 3, 3, 64, 1, 12};
+    for (int value: stream)
+    {
+        heap_top_k_push(top_k, create_heap_payload(value));
+        EXPECT_LE(heap_top_k_length(top_k), 3);
+    }
+
+    // The worst kept item is the third lowest value seen
+    EXPECT_EQ(* (int *)heap_top_k_peek_ref(top_k), 3);
+
+    int * kept[3] = {nullptr};
+    ASSERT_EQ(heap_top_k_drain(top_k, kept), 3);
+    EXPECT_EQ(* kept[0], 1);
+    EXPECT_EQ(* kept[1], 3);
+    EXPECT_EQ(* kept[2], 3);
+    EXPECT_EQ(heap_top_k_length(top_k), 0);
+
+    for (int * payload: kept)
+    {
+        payload_destroy(payload);
+    }
+    heap_top_k_destroy(top_k);
+}
+
+// Random updates and removals through handles must keep the heap order and
+// the handles pointing at the right items
+TEST(HeapIndexed, HeapIndexedRandomOperations)
+{
+    heap_t * heap = heap_init_indexed(MIN_HEAP, HEAP_MEM, sizeof(int32_t),
+                                      nullptr, heap_data_cmp, HEAP_4_ARY);
+    ASSERT_NE(heap, nullptr);
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int32_t> dist(0, 10000);
+    std::map<heap_handle_t, int32_t> live;
+
+    for (int i = 0; i < 2000; i++)
+    {
+        int32_t value = dist(rng);
+        heap_handle_t handle = heap_insert_handle(heap, &value);
+        ASSERT_NE(handle, HEAP_INVALID_HANDLE);
+        ASSERT_EQ(live.count(handle), 0);
+        live[handle] = value;
+    }
+
+    // Change the priority of every third item and remove every fifth
+    int count = 0;
+    for (auto it = live.begin(); it != live.end(); count++)
+    {
+        if (0 == count % 5)
+        {
+            int32_t removed = -1;
+            ASSERT_EQ(heap_remove(heap, it->first, &removed), HEAP_SUCCESS);
+            EXPECT_EQ(removed, it->second);
+            EXPECT_FALSE(heap_contains(heap, it->first));
+            it = live.erase(it);
+            continue;
+        }
+        if (0 == count % 3)
+        {
+            int32_t value = dist(rng);
+            ASSERT_EQ(heap_update_priority(heap, it->first, &value),
+                      HEAP_SUCCESS);
+            it->second = value;
+        }
+        EXPECT_TRUE(heap_contains(heap, it->first));
+        EXPECT_EQ(* (int32_t *)heap_handle_ref(heap, it->first), it->second);
+        it++;
+    }
+
+    std::vector<int32_t> expected;
+    for (auto& item: live)
+    {
+        expected.push_back(item.second);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    for (int32_t target: expected)
+    {
+        int32_t value = 0;
+        ASSERT_EQ(heap_pop_into(heap, &value), HEAP_SUCCESS);
+        EXPECT_EQ(value, target);
+    }
+    EXPECT_TRUE(heap_is_empty(heap));
+    heap_destroy(heap);
+}
+
+// In pointer mode the priority can be changed in place, and removing without
+// an output frees the payload
+TEST(HeapIndexed, HeapIndexedPtrMode)
+{
+    heap_t * heap = heap_init_indexed(MAX_HEAP, HEAP_PTR, 0, payload_destroy,
+                                      heap_ptr_cmp, HEAP_BINARY);
+    ASSERT_NE(heap, nullptr);
+
+    heap_handle_t handles[5];
+    int * payloads[5];
+    for (int i = 0; i < 5; i++)
+    {
+        payloads[i] = create_heap_payload(i * 10);
+        handles[i] = heap_insert_handle(heap, payloads[i]);
+    }
+    EXPECT_EQ(* (int *)heap_peek_ref(heap), 40);
+
+    // Decrease the key of the current root in place
+    * payloads[4] = -1;
+    ASSERT_EQ(heap_update_priority(heap, handles[4], nullptr), HEAP_SUCCESS);
+    EXPECT_EQ(* (int *)heap_peek_ref(heap), 30);
+
+    // Removed handles are no longer members, and the insert that reuses
+    // their slot gets a new handle the stale one does not match
+    ASSERT_EQ(heap_remove(heap, handles[1], nullptr), HEAP_SUCCESS);
+    EXPECT_FALSE(heap_contains(heap, handles[1]));
+    EXPECT_EQ(heap_remove(heap, handles[1], nullptr), HEAP_FAILURE);
+    int * reinserted = create_heap_payload(100);
+    heap_handle_t handle = heap_insert_handle(heap, reinserted);
+    EXPECT_NE(handle, handles[1]);
+    EXPECT_TRUE(heap_contains(heap, handle));
+    EXPECT_FALSE(heap_contains(heap, handles[1]));
+    EXPECT_EQ(heap_handle_ref(heap, handles[1]), nullptr);
+    EXPECT_EQ(heap_update_priority(heap, handles[1], nullptr), HEAP_FAILURE);
+    EXPECT_EQ(heap_remove(heap, handles[1], nullptr), HEAP_FAILURE);
+    EXPECT_EQ(heap_handle_ref(heap, handle), reinserted);
+
+    int * popped = nullptr;
+    ASSERT_EQ(heap_pop_into(heap, &popped), HEAP_SUCCESS);
+    EXPECT_EQ(* popped, 100);
+    EXPECT_FALSE(heap_contains(heap, handle));
+    payload_destroy(popped);
+
+    // Handles from before a dump do not match the items inserted after it
+    heap_dump(heap);
+    handle = heap_insert_handle(heap, create_heap_payload(5));
+    EXPECT_NE(handle, handles[0]);
+    EXPECT_FALSE(heap_contains(heap, handles[0]));
+    EXPECT_TRUE(heap_contains(heap, handle));
+
+    heap_destroy(heap);
+}
+
+/*
+ * Record of a keyed heap. The priority is cached in the heap and the id
+ * breaks ties between equal priorities.
+ */
+typedef struct
+{
+    uint64_t priority;
+    double weight;
+    int id;
+} keyed_record_t;
+
+static heap_key_t keyed_priority(void * payload)
+{
+    heap_key_t key;
+    key.u64 = ((keyed_record_t *)payload)->priority;
+    return key;
+}
+
+static heap_key_t keyed_weight(void * payload)
+{
+    heap_key_t key;
+    key.f64 = ((keyed_record_t *)payload)->weight;
+    return key;
+}
+
+static heap_compare_t keyed_id_cmp(void * payload, void * payload2)
+{
+    return heap_ptr_cmp(&((keyed_record_t *)payload)->id,
+                        &((keyed_record_t *)payload2)->id);
+}
+
+TEST(HeapKeyed, HeapKeyedU64TieBreak)
+{
+    heap_t * heap = heap_init_keyed(MIN_HEAP, HEAP_KEY_U64, keyed_priority,
+                                    payload_destroy, keyed_id_cmp, HEAP_4_ARY);
+    ASSERT_NE(heap, nullptr);
+
+    std::mt19937 engine(12);
+    std::vector<std::pair<uint64_t, int>> expected;
+    for (int i = 0; i < 1000; i++)
+    {
+        keyed_record_t * record = (keyed_record_t *)malloc(
+            sizeof(keyed_record_t));
+        * record = {engine() % 50, 0.0, i};
+        expected.push_back({record->priority, record->id});
+        heap_insert(heap, record);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    // Replace the root with an item that belongs at the very end
+    keyed_record_t * root = (keyed_record_t *)heap_peek_ref(heap);
+    EXPECT_EQ(root->priority, expected[0].first);
+    EXPECT_EQ(root->id, expected[0].second);
+    keyed_record_t * last = (keyed_record_t *)malloc(sizeof(keyed_record_t));
+    * last = {100, 0.0, 1000};
+    keyed_record_t * old_root = nullptr;
+    ASSERT_EQ(heap_replace_root(heap, last, &old_root), HEAP_SUCCESS);
+    EXPECT_EQ(old_root, root);
+    free(old_root);
+    expected.erase(expected.begin());
+    expected.push_back({100, 1000});
+
+    for (std::pair<uint64_t, int> & item : expected)
+    {
+        keyed_record_t * record = nullptr;
+        ASSERT_EQ(heap_pop_into(heap, &record), HEAP_SUCCESS);
+        EXPECT_EQ(record->priority, item.first);
+        EXPECT_EQ(record->id, item.second);
+        free(record);
+    }
+    EXPECT_TRUE(heap_is_empty(heap));
+    heap_destroy(heap);
+}
+
+TEST(HeapKeyed, HeapKeyedDoubleWithoutCompare)
+{
+    heap_t * heap = heap_init_keyed(MAX_HEAP, HEAP_KEY_DOUBLE, keyed_weight,
+                                    payload_destroy, nullptr, HEAP_BINARY);
+    ASSERT_NE(heap, nullptr);
+
+    std::mt19937 engine(13);
+    std::uniform_real_distribution<double> distribution(-1e6, 1e6);
+    std::vector<double> expected;
+    for (int i = 0; i < 500; i++)
+    {
+        keyed_record_t * record = (keyed_record_t *)malloc(
+            sizeof(keyed_record_t));
+        * record = {0, distribution(engine), i};
+        expected.push_back(record->weight);
+        heap_insert(heap, record);
+    }
+    std::sort(expected.begin(), expected.end(), std::greater<double>());
+
+    for (size_t i = 0; i < 250; i++)
+    {
+        keyed_record_t * record = (keyed_record_t *)heap_pop(heap);
+        ASSERT_NE(record, nullptr);
+        EXPECT_EQ(record->weight, expected[i]);
+        free(record);
+    }
+
+    // The remaining records are freed by the destroy callback
+    heap_destroy(heap);
+}
+
+TEST(HeapCapacity, HeapReserveAndShrinkToFit)
+{
+    heap_t * heap = heap_init(MIN_HEAP, HEAP_MEM, sizeof(int), NULL,
+                              heap_data_cmp, HEAP_BINARY);
+    ASSERT_EQ(heap_reserve(heap, 1000), HEAP_SUCCESS);
+    EXPECT_EQ(heap_capacity(heap), 1000);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        heap_insert(heap, &i);
+    }
+    EXPECT_EQ(heap_capacity(heap), 1000);
+
+    // The reserved capacity is kept while the heap empties
+    int value = 0;
+    for (int i = 0; i < 990; i++)
+    {
+        ASSERT_EQ(heap_pop_into(heap, &value), HEAP_SUCCESS);
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_EQ(heap_capacity(heap), 1000);
+
+    // Smaller reservations do nothing
+    ASSERT_EQ(heap_reserve(heap, 10), HEAP_SUCCESS);
+    EXPECT_EQ(heap_capacity(heap), 1000);
+
+    ASSERT_EQ(heap_shrink_to_fit(heap), HEAP_SUCCESS);
+    EXPECT_EQ(heap_capacity(heap), 10);
+    for (int i = 990; i < 1000; i++)
+    {
+        ASSERT_EQ(heap_pop_into(heap, &value), HEAP_SUCCESS);
+        EXPECT_EQ(value, i);
+    }
+    heap_destroy(heap);
+}
+
+TEST(HeapCapacity, HeapShrinkHysteresis)
+{
+    heap_t * heap = heap_init(MAX_HEAP, HEAP_MEM, sizeof(int), NULL,
+                              heap_data_cmp, HEAP_4_ARY);
+    size_t base_capacity = heap_capacity(heap);
+    for (int i = 0; i <= (int)base_capacity; i++)
+    {
+        heap_insert(heap, &i);
+    }
+    size_t grown_capacity = heap_capacity(heap);
+    EXPECT_EQ(grown_capacity, base_capacity * 2);
+
+    // Going back and forth over the boundary does not resize the array
+    int value = 0;
+    for (int i = 0; i < 100; i++)
+    {
+        heap_pop_into(heap, &value);
+        heap_insert(heap, &value);
+        EXPECT_EQ(heap_capacity(heap), grown_capacity);
+    }
+
+    // The array shrinks once the items fit in half of the smaller array
+    while (heap_capacity(heap) == grown_capacity)
+    {
+        ASSERT_EQ(heap_pop_into(heap, &value), HEAP_SUCCESS);
+    }
+    EXPECT_EQ(heap_capacity(heap), base_capacity);
+    heap_destroy(heap);
+}
+
+TEST(HeapCapacity, HeapGrowthPolicy)
+{
+    heap_t * heap = heap_init_indexed(MIN_HEAP, HEAP_PTR, 0, payload_destroy,
+                                      heap_ptr_cmp, HEAP_BINARY);
+    heap_set_growth_policy(heap, 1.5, HEAP_SHRINK_NEVER);
+    size_t base_capacity = heap_capacity(heap);
+
+    std::vector<heap_handle_t> handles;
+    for (int i = 0; i < 100; i++)
+    {
+        handles.push_back(heap_insert_handle(heap, create_heap_payload(i)));
+    }
+    size_t grown_capacity = heap_capacity(heap);
+    EXPECT_GE(grown_capacity, 100);
+    EXPECT_LT(grown_capacity, 150);
+    EXPECT_GT(grown_capacity, base_capacity);
+
+    for (int i = 99; i > 0; i--)
+    {
+        ASSERT_EQ(heap_remove(heap, handles[(size_t)i], nullptr),
+                  HEAP_SUCCESS);
+    }
+    EXPECT_EQ(heap_capacity(heap), grown_capacity);
+    EXPECT_TRUE(heap_contains(heap, handles[0]));
+
+    ASSERT_EQ(heap_shrink_to_fit(heap), HEAP_SUCCESS);
+    EXPECT_EQ(heap_capacity(heap), base_capacity);
+    EXPECT_EQ(* (int *)heap_handle_ref(heap, handles[0]), 0);
+    heap_destroy(heap);
+}
+
+TEST(HeapStats, HeapStatsCounters)
+{
+    heap_t * heap = heap_init(MIN_HEAP, HEAP_MEM, sizeof(int), NULL,
+                              heap_data_cmp, HEAP_BINARY);
+    heap_stats_t stats;
+
+    // Descending values bubble all the way up to the root
+    for (int i = 100; i > 0; i--)
+    {
+        heap_insert(heap, &i);
+    }
+#ifdef HEAP_STATS
+    ASSERT_EQ(heap_get_stats(heap, &stats), HEAP_SUCCESS);
+    EXPECT_EQ(stats.compares, 480);
+    EXPECT_EQ(stats.swaps, 480);
+    EXPECT_EQ(stats.resizes, 4);
+    EXPECT_EQ(stats.peak_length, 100);
+
+    int value = 0;
+    for (int i = 0; i < 50; i++)
+    {
+        heap_pop_into(heap, &value);
+    }
+    heap_get_stats(heap, &stats);
+    EXPECT_GT(stats.compares, 480);
+    EXPECT_EQ(stats.peak_length, 100);
+
+    heap_reset_stats(heap);
+    heap_get_stats(heap, &stats);
+    EXPECT_EQ(stats.compares, 0);
+    EXPECT_EQ(stats.swaps, 0);
+    EXPECT_EQ(stats.resizes, 0);
+    EXPECT_EQ(stats.peak_length, 50);
+#else
+    EXPECT_EQ(heap_get_stats(heap, &stats), HEAP_FAILURE);
+    EXPECT_EQ(stats.compares, 0);
+    EXPECT_EQ(stats.peak_length, 0);
+    heap_reset_stats(heap);
+#endif // HEAP_STATS
+    heap_destroy(heap);
+}
+
 /*!
  * Find if the value specified is in the heap_adt
  */
@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include <heap_merge.h>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+static heap_compare_t merge_int_cmp(void * payload, void * payload2)
+{
+    int val1 = * (int *)payload;
+    int val2 = * (int *)payload2;
+
+    if (val1 > val2)
+    {
+        return HEAP_GT;
+    } else if (val1 < val2)
+    {
+        return HEAP_LT;
+    } else
+    {
+        return HEAP_EQ;
+    }
+}
+
+/*
+ * Records with the same key must come out in the order of their runs
+ */
+typedef struct
+{
+    int key;
+    int run;
+} tagged_t;
+
+static heap_compare_t merge_tagged_cmp(void * payload, void * payload2)
+{
+    return merge_int_cmp(&((tagged_t *)payload)->key,
+                         &((tagged_t *)payload2)->key);
+}
+
+/*
+ * Callback source producing start, start + step, ... for count items
+ */
+typedef struct
+{
+    int next;
+    int step;
+    int remaining;
+} sequence_t;
+
+static heap_result_t sequence_next(void * context, void * out)
+{
+    sequence_t * sequence = (sequence_t *)context;
+    if (0 == sequence->remaining)
+    {
+        return HEAP_FAILURE;
+    }
+    * (int *)out = sequence->next;
+    sequence->next += sequence->step;
+    sequence->remaining--;
+    return HEAP_SUCCESS;
+}
+
+static std::vector<int> get_sorted_run(size_t count, unsigned seed)
+{
+    std::mt19937 engine(seed);
+    std::uniform_int_distribution<int> distribution(-1000, 1000);
+    std::vector<int> run(count);
+    for (int & value : run)
+    {
+        value = distribution(engine);
+    }
+    std::sort(run.begin(), run.end());
+    return run;
+}
+
+TEST(HeapMerge, MergeArrays)
+{
+    std::vector<std::vector<int>> runs;
+    std::vector<int> expected;
+    for (unsigned i = 0; i < 7; i++)
+    {
+        runs.push_back(get_sorted_run(100 + (i * 37), i));
+        expected.insert(expected.end(), runs.back().begin(),
+                        runs.back().end());
+    }
+    std::sort(expected.begin(), expected.end());
+
+    heap_merge_t * merge = heap_merge_init(MIN_HEAP, HEAP_MEM, sizeof(int),
+                                           merge_int_cmp);
+    for (std::vector<int> & run : runs)
+    {
+        EXPECT_EQ(heap_merge_add_array(merge, run.data(), run.size()),
+                  HEAP_SUCCESS);
+    }
+    EXPECT_EQ(heap_merge_add_array(merge, nullptr, 0), HEAP_SUCCESS);
+
+    int value = 0;
+    for (int target : expected)
+    {
+        ASSERT_EQ(heap_merge_next(merge, &value), HEAP_SUCCESS);
+        EXPECT_EQ(value, target);
+    }
+    EXPECT_TRUE(heap_merge_is_empty(merge));
+    EXPECT_EQ(heap_merge_next(merge, &value), HEAP_FAILURE);
+    heap_merge_destroy(merge);
+}
+
+TEST(HeapMerge, MergeSourcesAndArrays)
+{
+    sequence_t evens = {0, 2, 500};
+    sequence_t odds = {1, 2, 500};
+    sequence_t empty = {0, 1, 0};
+    std::vector<int> tail = {1000, 1001, 1002};
+
+    heap_merge_t * merge = heap_merge_init(MIN_HEAP, HEAP_MEM, sizeof(int),
+                                           merge_int_cmp);
+    heap_merge_add_source(merge, sequence_next, &evens);
+    heap_merge_add_source(merge, sequence_next, &empty);
+    heap_merge_add_array(merge, tail.data(), tail.size());
+    heap_merge_add_source(merge, sequence_next, &odds);
+
+    int value = 0;
+    for (int expected = 0; expected < 1003; expected++)
+    {
+        ASSERT_EQ(heap_merge_next(merge, &value), HEAP_SUCCESS);
+        EXPECT_EQ(value, expected);
+    }
+    EXPECT_EQ(heap_merge_next(merge, &value), HEAP_FAILURE);
+    heap_merge_destroy(merge);
+}
+
+TEST(HeapMerge, MaxHeapPtrMode)
+{
+    std::vector<int> first = get_sorted_run(200, 10);
+    std::vector<int> second = get_sorted_run(300, 11);
+    std::reverse(first.begin(), first.end());
+    std::reverse(second.begin(), second.end());
+
+    std::vector<int *> first_ptrs;
+    std::vector<int *> second_ptrs;
+    for (int & value : first)
+    {
+        first_ptrs.push_back(&value);
+    }
+    for (int & value : second)
+    {
+        second_ptrs.push_back(&value);
+    }
+
+    std::vector<int> expected = first;
+    expected.insert(expected.end(), second.begin(), second.end());
+    std::sort(expected.begin(), expected.end(), std::greater<int>());
+
+    heap_merge_t * merge = heap_merge_init(MAX_HEAP, HEAP_PTR, 0,
+                                           merge_int_cmp);
+    heap_merge_add_array(merge, first_ptrs.data(), first_ptrs.size());
+    heap_merge_add_array(merge, second_ptrs.data(), second_ptrs.size());
+
+    int * pointer = nullptr;
+    for (int target : expected)
+    {
+        ASSERT_EQ(heap_merge_next(merge, &pointer), HEAP_SUCCESS);
+        EXPECT_EQ(* pointer, target);
+    }
+    heap_merge_destroy(merge);
+}
+
+TEST(HeapMerge, EqualItemsKeepRunOrder)
+{
+    std::vector<std::vector<tagged_t>> runs(4);
+    for (int run = 0; run < 4; run++)
+    {
+        for (int key = 0; key < 50; key++)
+        {
+            runs[(size_t)run].push_back({key / 5, run});
+        }
+    }
+
+    heap_merge_t * merge = heap_merge_init(MIN_HEAP, HEAP_MEM,
+                                           sizeof(tagged_t),
+                                           merge_tagged_cmp);
+    for (std::vector<tagged_t> & run : runs)
+    {
+        heap_merge_add_array(merge, run.data(), run.size());
+    }
+
+    tagged_t previous = {-1, 0};
+    tagged_t current;
+    while (HEAP_SUCCESS == heap_merge_next(merge, &current))
+    {
+        ASSERT_GE(current.key, previous.key);
+        if (current.key == previous.key)
+        {
+            ASSERT_GE(current.run, previous.run);
+        }
+        previous = current;
+    }
+    heap_merge_destroy(merge);
+}
+
+TEST(HeapMerge, DestroyBeforeExhausted)
+{
+    sequence_t sequence = {0, 1, 100};
+    std::vector<int> run = {5, 6, 7};
+    heap_merge_t * merge = heap_merge_init(MIN_HEAP, HEAP_MEM, sizeof(int),
+                                           merge_int_cmp);
+    heap_merge_add_source(merge, sequence_next, &sequence);
+    heap_merge_add_array(merge, run.data(), run.size());
+
+    int value = 0;
+    heap_merge_next(merge, &value);
+    EXPECT_EQ(value, 0);
+    heap_merge_destroy(merge);
+}
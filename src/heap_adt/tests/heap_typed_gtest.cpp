@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <heap_typed.h>
+#include <heap.hpp>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <memory>
+#include <optional>
+
+#define INT_LESS(left, right) ((left) < (right))
+#define INT_GREATER(left, right) ((left) > (right))
+
+HEAP_DECLARE(int_min_heap, int, INT_LESS)
+HEAP_DECLARE(int_max_heap, int, INT_GREATER)
+
+/*
+ * Record type to make sure the generated heap moves whole structs
+ */
+typedef struct
+{
+    uint64_t key;
+    uint64_t id;
+    char pad[48];
+} record_t;
+
+static inline bool record_before(record_t left, record_t right)
+{
+    return left.key < right.key;
+}
+
+HEAP_DECLARE(record_heap, record_t, record_before)
+
+static std::vector<int> get_random_values(size_t count)
+{
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> distribution(-1000, 1000);
+    std::vector<int> values(count);
+    for (int & value : values)
+    {
+        value = distribution(engine);
+    }
+    return values;
+}
+
+TEST(HeapTyped, MinHeapPopOrder)
+{
+    std::vector<int> values = get_random_values(500);
+    int_min_heap_t heap;
+    ASSERT_TRUE(int_min_heap_init(&heap));
+    EXPECT_TRUE(int_min_heap_is_empty(&heap));
+    EXPECT_EQ(int_min_heap_peek(&heap), nullptr);
+
+    for (int value : values)
+    {
+        ASSERT_TRUE(int_min_heap_insert(&heap, value));
+    }
+    EXPECT_EQ(int_min_heap_length(&heap), values.size());
+    EXPECT_EQ(* int_min_heap_peek(&heap),
+              * std::min_element(values.begin(), values.end()));
+
+    std::sort(values.begin(), values.end());
+    int value = 0;
+    for (int expected : values)
+    {
+        ASSERT_TRUE(int_min_heap_pop(&heap, &value));
+        EXPECT_EQ(value, expected);
+    }
+    EXPECT_FALSE(int_min_heap_pop(&heap, &value));
+    int_min_heap_destroy(&heap);
+}
+
+TEST(HeapTyped, MaxHeapPopOrder)
+{
+    std::vector<int> values = get_random_values(500);
+    int_max_heap_t heap;
+    ASSERT_TRUE(int_max_heap_init(&heap));
+    for (int value : values)
+    {
+        ASSERT_TRUE(int_max_heap_insert(&heap, value));
+    }
+
+    std::sort(values.begin(), values.end(), std::greater<int>());
+    int value = 0;
+    for (int expected : values)
+    {
+        ASSERT_TRUE(int_max_heap_pop(&heap, &value));
+        EXPECT_EQ(value, expected);
+    }
+    int_max_heap_destroy(&heap);
+}
+
+TEST(HeapTyped, StructItems)
+{
+    record_heap_t heap;
+    ASSERT_TRUE(record_heap_init(&heap));
+    for (uint64_t index = 0; index < 200; index++)
+    {
+        record_t record = {};
+        record.key = (index * 37) % 200;
+        record.id = index;
+        ASSERT_TRUE(record_heap_insert(&heap, record));
+    }
+
+    record_t record;
+    for (uint64_t expected = 0; expected < 200; expected++)
+    {
+        ASSERT_TRUE(record_heap_pop(&heap, &record));
+        EXPECT_EQ(record.key, expected);
+        EXPECT_EQ((record.id * 37) % 200, expected);
+    }
+    record_heap_destroy(&heap);
+}
+
+TEST(HeapTemplate, PopOrder)
+{
+    std::vector<int> values = get_random_values(500);
+    heap_adt::heap<int> min_heap;
+    heap_adt::heap<int, std::greater<int>> max_heap;
+    for (int value : values)
+    {
+        min_heap.push(value);
+        max_heap.push(value);
+    }
+    EXPECT_EQ(min_heap.size(), values.size());
+
+    std::vector<int> ascending = values;
+    std::sort(ascending.begin(), ascending.end());
+    for (size_t index = 0; index < ascending.size(); index++)
+    {
+        EXPECT_EQ(min_heap.top(), ascending[index]);
+        EXPECT_EQ(min_heap.pop(), ascending[index]);
+        EXPECT_EQ(max_heap.pop(), ascending[ascending.size() - index - 1]);
+    }
+    EXPECT_TRUE(min_heap.empty());
+    EXPECT_FALSE(min_heap.pop().has_value());
+}
+
+TEST(HeapTemplate, FromVectorAndMoveOnly)
+{
+    std::vector<int> values = get_random_values(300);
+    heap_adt::heap<int> heap(values);
+    std::sort(values.begin(), values.end());
+    for (int expected : values)
+    {
+        EXPECT_EQ(heap.pop(), expected);
+    }
+
+    auto by_value = [](const std::unique_ptr<int> & left,
+                       const std::unique_ptr<int> & right)
+    {
+        return * left < * right;
+    };
+    heap_adt::heap<std::unique_ptr<int>, decltype(by_value)> owned(by_value);
+    for (int value : {5, 1, 4, 2, 3})
+    {
+        owned.emplace(new int(value));
+    }
+    for (int expected = 1; expected <= 5; expected++)
+    {
+        std::optional<std::unique_ptr<int>> item = owned.pop();
+        ASSERT_TRUE(item.has_value());
+        EXPECT_EQ(** item, expected);
+    }
+}
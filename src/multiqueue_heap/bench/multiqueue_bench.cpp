@@ -0,0 +1,141 @@
+/*
+ * Measures the throughput of the MultiQueue against a single heap_t behind
+ * one global mutex. Every thread alternates an insert of a random key and a
+ * pop on a queue that was filled with a number of keys first.
+ *
+ * Usage: multiqueue_bench [operations_per_thread] [max_threads]
+ */
+#include <multiqueue.h>
+#include <heap.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+static const size_t PREFILL = 100000;
+
+static heap_compare_t u32_compare(void * payload, void * payload2)
+{
+    uint32_t left = * (uint32_t *)payload;
+    uint32_t right = * (uint32_t *)payload2;
+    if (left > right)
+    {
+        return HEAP_GT;
+    }
+    else if (left < right)
+    {
+        return HEAP_LT;
+    }
+    return HEAP_EQ;
+}
+
+/*
+ * Start every thread at the same time and return the elapsed seconds
+ */
+template <typename Work>
+static double run_threads(size_t thread_count, Work work)
+{
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; t++)
+    {
+        threads.emplace_back([&, t]() {
+            while (!start.load())
+            {
+            }
+            work(t);
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start = true;
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+static double bench_global_lock(size_t thread_count, size_t operations)
+{
+    heap_t * heap = heap_init(MIN_HEAP, HEAP_MEM, sizeof(uint32_t), NULL,
+                              u32_compare, HEAP_BINARY);
+    std::mutex lock;
+    for (uint32_t i = 0; i < PREFILL; i++)
+    {
+        uint32_t key = i * 2654435761u;
+        heap_insert(heap, &key);
+    }
+
+    double seconds = run_threads(thread_count, [&](size_t t) {
+        std::mt19937 engine((unsigned)t);
+        uint32_t value = 0;
+        for (size_t i = 0; i < operations; i++)
+        {
+            uint32_t key = engine();
+            std::lock_guard<std::mutex> guard(lock);
+            heap_insert(heap, &key);
+            heap_pop_into(heap, &value);
+        }
+    });
+    heap_destroy(heap);
+    return seconds;
+}
+
+static double bench_multiqueue(size_t thread_count, size_t operations)
+{
+    mqueue_t * queue = mqueue_init(thread_count, 4, MIN_HEAP, HEAP_MEM,
+                                   sizeof(uint32_t), NULL, u32_compare);
+    for (uint32_t i = 0; i < PREFILL; i++)
+    {
+        uint32_t key = i * 2654435761u;
+        mqueue_insert(queue, &key);
+    }
+
+    double seconds = run_threads(thread_count, [&](size_t t) {
+        std::mt19937 engine((unsigned)t);
+        uint32_t value = 0;
+        for (size_t i = 0; i < operations; i++)
+        {
+            uint32_t key = engine();
+            mqueue_insert(queue, &key);
+            mqueue_try_pop(queue, &value);
+        }
+    });
+    mqueue_destroy(queue);
+    return seconds;
+}
+
+int main(int argc, char ** argv)
+{
+    size_t operations = 200000;
+    size_t max_threads = std::thread::hardware_concurrency();
+    if (argc > 1)
+    {
+        operations = strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2)
+    {
+        max_threads = strtoul(argv[2], NULL, 10);
+    }
+
+    printf("%zu insert+pop pairs per thread, %zu prefilled keys\n",
+           operations, PREFILL);
+    printf("%8s %20s %20s\n", "threads", "global lock Mops/s",
+           "multiqueue Mops/s");
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        double total = (double)(threads * operations * 2) / 1e6;
+        double locked = bench_global_lock(threads, operations);
+        double sharded = bench_multiqueue(threads, operations);
+        printf("%8zu %20.2f %20.2f\n", threads, total / locked,
+               total / sharded);
+    }
+    return 0;
+}
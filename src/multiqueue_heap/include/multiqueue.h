@@ -0,0 +1,37 @@
+#ifndef MULTIQUEUE_H
+#define MULTIQUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <heap.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Relaxed concurrent priority queue made of several heap_t shards that are
+ * each protected by their own lock. The items, callbacks and data modes are
+ * the same as the ones of heap_t.
+ */
+typedef struct mqueue_t mqueue_t;
+
+mqueue_t * mqueue_init(size_t thread_count,
+                       size_t shard_factor,
+                       heap_type_t type,
+                       heap_data_mode_t data_mode,
+                       size_t payload_size,
+                       void (* destroy)(void *),
+                       heap_compare_t (* compare)(void *, void *));
+void mqueue_destroy(mqueue_t * queue);
+heap_result_t mqueue_insert(mqueue_t * queue, void * payload);
+heap_result_t mqueue_try_pop(mqueue_t * queue, void * out);
+heap_result_t mqueue_pop(mqueue_t * queue, void * out);
+void mqueue_close(mqueue_t * queue);
+size_t mqueue_length(mqueue_t * queue);
+bool mqueue_is_empty(mqueue_t * queue);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+#endif //MULTIQUEUE_H
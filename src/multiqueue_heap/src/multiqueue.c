@@ -0,0 +1,487 @@
+#include <multiqueue.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+
+typedef enum
+{
+    CACHE_LINE = 64,
+} mqueue_default_t;
+
+// Enum for determining if malloc calls were valid
+typedef enum
+{
+    VALID_PTR = 1,
+    INVALID_PTR = 0
+} mqueue_pointer_t;
+
+// Each shard is aligned to its own cache line so that threads working on
+// neighbouring shards do not invalidate each others locks
+typedef struct mqueue_shard_t
+{
+    _Alignas(CACHE_LINE) pthread_mutex_t lock;
+    heap_t * heap;
+} mqueue_shard_t;
+
+typedef struct mqueue_t
+{
+    size_t shard_count;             // Number of heaps in the shards array
+    mqueue_shard_t * shards;
+    heap_compare_t heap_type;
+    heap_compare_t (* compare)(void * payload, void * payload2);
+
+    // Number of items in all the shards. The count is updated after the
+    // shard is unlocked, so it is only exact while no thread is inserting
+    // or popping.
+    _Alignas(CACHE_LINE) atomic_size_t length;
+
+    // Only used by the threads sleeping in mqueue_pop
+    _Alignas(CACHE_LINE) atomic_size_t waiters;
+    pthread_mutex_t wait_lock;
+    pthread_cond_t wait_cond;
+    bool closed;
+} mqueue_t;
+
+static mqueue_shard_t * lock_any_shard(mqueue_t * queue);
+static mqueue_shard_t * try_lock_shard(mqueue_t * queue, size_t index);
+static mqueue_shard_t * get_best_shard(mqueue_t * queue,
+                                       mqueue_shard_t * first,
+                                       mqueue_shard_t * second);
+static heap_result_t pop_two_choice(mqueue_t * queue, void * out);
+static heap_result_t pop_sweep(mqueue_t * queue, void * out);
+static void wake_waiter(mqueue_t * queue);
+static void unlock_shard(mqueue_shard_t * shard);
+
+static size_t get_random_index(mqueue_t * queue);
+static mqueue_pointer_t verify_alloc(void * ptr);
+
+// Seeds the random state of every thread the first time it uses a queue
+static atomic_uint_fast64_t seed_counter = 0;
+static _Thread_local uint64_t random_state = 0;
+
+
+
+/*!
+ * @brief Create the concurrent priority queue
+ *
+ * The queue is a relaxed MultiQueue. The items are spread over
+ * thread_count * shard_factor heaps that each have their own lock. Inserting
+ * picks a random shard that is not locked by another thread. Popping locks
+ * two random shards and removes the best root of the two.
+ *
+ * The queue is relaxed, so a pop returns one of the best items but not
+ * always the best item in the queue. The more shards there are, the less
+ * the threads contend on the locks and the more relaxed the order is. A
+ * shard_factor of 2 to 4 is a good trade off.
+ * @param thread_count Number of threads expected to use the queue
+ * @param shard_factor Number of shards per thread
+ * @param type Heap type, max heap or min heap
+ * @param data_mode Data storage strategy
+ * @param payload_size The size of the payload. This can be 0 if using HEAP_PTR
+ * @param destroy Pointer to function that frees the block of memory
+ * @param compare Pointer to function that compares the nodes
+ * @return Pointer to mqueue_t or NULL
+ */
+mqueue_t * mqueue_init(size_t thread_count,
+                       size_t shard_factor,
+                       heap_type_t type,
+                       heap_data_mode_t data_mode,
+                       size_t payload_size,
+                       void (* destroy)(void *),
+                       heap_compare_t (* compare)(void *, void *))
+{
+    assert(compare);
+    size_t shard_count = thread_count * shard_factor;
+    if (0 == shard_count)
+    {
+        shard_count = 1;
+    }
+
+    mqueue_t * queue = (mqueue_t *)aligned_alloc(CACHE_LINE, sizeof(mqueue_t));
+    if (INVALID_PTR == verify_alloc((void *)queue))
+    {
+        return NULL;
+    }
+
+    queue->shards = (mqueue_shard_t *)aligned_alloc(
+        CACHE_LINE, shard_count * sizeof(mqueue_shard_t));
+    if (INVALID_PTR == verify_alloc((void *)queue->shards))
+    {
+        free(queue);
+        return NULL;
+    }
+
+    queue->shard_count = shard_count;
+    queue->heap_type = type ? HEAP_LT : HEAP_GT;
+    queue->compare = compare;
+    atomic_init(&queue->length, 0);
+    atomic_init(&queue->waiters, 0);
+    pthread_mutex_init(&queue->wait_lock, NULL);
+    pthread_cond_init(&queue->wait_cond, NULL);
+    queue->closed = false;
+
+    for (size_t i = 0; i < shard_count; i++)
+    {
+        mqueue_shard_t * shard = &queue->shards[i];
+        shard->heap = heap_init(type,
+                                data_mode,
+                                payload_size,
+                                destroy,
+                                compare,
+                                HEAP_BINARY);
+        if (NULL == shard->heap)
+        {
+            queue->shard_count = i;
+            mqueue_destroy(queue);
+            return NULL;
+        }
+        pthread_mutex_init(&shard->lock, NULL);
+    }
+    return queue;
+}
+
+/*!
+ * @brief Destroy the queue and the items left in it. No other thread can be
+ * using the queue.
+ * @param queue
+ */
+void mqueue_destroy(mqueue_t * queue)
+{
+    assert(queue);
+    for (size_t i = 0; i < queue->shard_count; i++)
+    {
+        heap_destroy(queue->shards[i].heap);
+        pthread_mutex_destroy(&queue->shards[i].lock);
+    }
+    pthread_mutex_destroy(&queue->wait_lock);
+    pthread_cond_destroy(&queue->wait_cond);
+    free(queue->shards);
+    free(queue);
+}
+
+/*!
+ * @brief Insert the payload into a random shard that is not locked
+ *
+ * The length is counted while the shard is still locked, so a pop of the
+ * item can not be counted before its insert.
+ * @param queue
+ * @param payload Pointer to the payload, copied in HEAP_MEM mode
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the shard could not grow
+ */
+heap_result_t mqueue_insert(mqueue_t * queue, void * payload)
+{
+    assert(queue);
+    mqueue_shard_t * shard = lock_any_shard(queue);
+    heap_result_t result = heap_insert(shard->heap, payload);
+    if (HEAP_SUCCESS == result)
+    {
+        atomic_fetch_add(&queue->length, 1);
+    }
+    unlock_shard(shard);
+
+    if (HEAP_SUCCESS == result)
+    {
+        wake_waiter(queue);
+    }
+    return result;
+}
+
+/*!
+ * @brief Remove one of the best items of the queue without blocking
+ *
+ * A few attempts are made at locking two random shards and popping the
+ * better of their roots. If all of them run into locked or empty shards,
+ * every shard is checked in turn so that an item is only missed if the
+ * queue is empty.
+ * @param queue
+ * @param out Memory of the payload size in HEAP_MEM mode or a pointer to a
+ * void pointer in HEAP_PTR mode
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the queue is empty
+ */
+heap_result_t mqueue_try_pop(mqueue_t * queue, void * out)
+{
+    assert(queue);
+    assert(out);
+    for (size_t attempt = 0; attempt < queue->shard_count; attempt++)
+    {
+        if (0 == atomic_load(&queue->length))
+        {
+            return HEAP_FAILURE;
+        }
+        if (HEAP_SUCCESS == pop_two_choice(queue, out))
+        {
+            return HEAP_SUCCESS;
+        }
+    }
+    return pop_sweep(queue, out);
+}
+
+/*!
+ * @brief Remove one of the best items of the queue, waiting for an item to
+ * be inserted if the queue is empty
+ * @param queue
+ * @param out Memory of the payload size in HEAP_MEM mode or a pointer to a
+ * void pointer in HEAP_PTR mode
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the queue is empty and closed
+ */
+heap_result_t mqueue_pop(mqueue_t * queue, void * out)
+{
+    assert(queue);
+    assert(out);
+    while (HEAP_SUCCESS != mqueue_try_pop(queue, out))
+    {
+        pthread_mutex_lock(&queue->wait_lock);
+
+        // The waiter is counted before checking the length. Inserting
+        // increments the length before checking the waiters, so either this
+        // thread sees the item or the inserting thread sees this waiter.
+        atomic_fetch_add(&queue->waiters, 1);
+        while ((0 == atomic_load(&queue->length)) && (!queue->closed))
+        {
+            pthread_cond_wait(&queue->wait_cond, &queue->wait_lock);
+        }
+        atomic_fetch_sub(&queue->waiters, 1);
+        bool is_done = (queue->closed) && (0 == atomic_load(&queue->length));
+        pthread_mutex_unlock(&queue->wait_lock);
+
+        if (is_done)
+        {
+            return HEAP_FAILURE;
+        }
+    }
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Wake every thread waiting in mqueue_pop. Once the queue is empty
+ * mqueue_pop returns HEAP_FAILURE instead of waiting.
+ * @param queue
+ */
+void mqueue_close(mqueue_t * queue)
+{
+    assert(queue);
+    pthread_mutex_lock(&queue->wait_lock);
+    queue->closed = true;
+    pthread_cond_broadcast(&queue->wait_cond);
+    pthread_mutex_unlock(&queue->wait_lock);
+}
+
+/*!
+ * @brief Return the number of items in the queue. The count is only exact
+ * while no other thread is using the queue.
+ * @param queue
+ * @return Number of items
+ */
+size_t mqueue_length(mqueue_t * queue)
+{
+    assert(queue);
+    return atomic_load(&queue->length);
+}
+
+/*!
+ * @brief Check if the queue is empty
+ * @param queue
+ * @return True if empty
+ */
+bool mqueue_is_empty(mqueue_t * queue)
+{
+    return 0 == mqueue_length(queue);
+}
+
+/*!
+ * @brief Lock a random shard. Shards locked by other threads are skipped and
+ * the thread only blocks on a lock if every attempt found a locked shard.
+ * @param queue
+ * @return Locked shard
+ */
+static mqueue_shard_t * lock_any_shard(mqueue_t * queue)
+{
+    for (size_t attempt = 0; attempt < queue->shard_count; attempt++)
+    {
+        size_t index = get_random_index(queue);
+        mqueue_shard_t * shard = try_lock_shard(queue, index);
+        if (NULL != shard)
+        {
+            return shard;
+        }
+    }
+
+    mqueue_shard_t * shard = &queue->shards[get_random_index(queue)];
+    pthread_mutex_lock(&shard->lock);
+    return shard;
+}
+
+/*!
+ * @brief Try to lock the shard at the index without blocking
+ * @param queue
+ * @param index
+ * @return Locked shard or NULL if another thread holds the lock
+ */
+static mqueue_shard_t * try_lock_shard(mqueue_t * queue, size_t index)
+{
+    mqueue_shard_t * shard = &queue->shards[index];
+    if (0 != pthread_mutex_trylock(&shard->lock))
+    {
+        return NULL;
+    }
+    return shard;
+}
+
+/*!
+ * @brief Pick the shard with the better root from two locked shards
+ * @param queue
+ * @param first Locked shard or NULL
+ * @param second Locked shard or NULL
+ * @return Shard with the better root or NULL if both are missing or empty
+ */
+static mqueue_shard_t * get_best_shard(mqueue_t * queue,
+                                       mqueue_shard_t * first,
+                                       mqueue_shard_t * second)
+{
+    if ((NULL != first) && (heap_is_empty(first->heap)))
+    {
+        first = NULL;
+    }
+    if ((NULL != second) && (heap_is_empty(second->heap)))
+    {
+        second = NULL;
+    }
+    if ((NULL == first) || (NULL == second))
+    {
+        return (NULL == first) ? second : first;
+    }
+
+    if (queue->heap_type == queue->compare(heap_peek_ref(second->heap),
+                                           heap_peek_ref(first->heap)))
+    {
+        return second;
+    }
+    return first;
+}
+
+/*!
+ * @brief Try to lock two random shards and pop the better of their roots
+ * @param queue
+ * @param out
+ * @return HEAP_SUCCESS or HEAP_FAILURE if no item could be popped
+ */
+static heap_result_t pop_two_choice(mqueue_t * queue, void * out)
+{
+    size_t first_index = get_random_index(queue);
+    size_t second_index = get_random_index(queue);
+    mqueue_shard_t * first = try_lock_shard(queue, first_index);
+    mqueue_shard_t * second = NULL;
+    if (second_index != first_index)
+    {
+        second = try_lock_shard(queue, second_index);
+    }
+
+    heap_result_t result = HEAP_FAILURE;
+    mqueue_shard_t * best = get_best_shard(queue, first, second);
+    if (NULL != best)
+    {
+        result = heap_pop_into(best->heap, out);
+    }
+    unlock_shard(first);
+    unlock_shard(second);
+
+    if (HEAP_SUCCESS == result)
+    {
+        atomic_fetch_sub(&queue->length, 1);
+    }
+    return result;
+}
+
+/*!
+ * @brief Lock every shard in turn, starting at a random one, and pop the
+ * root of the first shard that is not empty
+ * @param queue
+ * @param out
+ * @return HEAP_SUCCESS or HEAP_FAILURE if every shard was empty
+ */
+static heap_result_t pop_sweep(mqueue_t * queue, void * out)
+{
+    size_t start = get_random_index(queue);
+    for (size_t i = 0; i < queue->shard_count; i++)
+    {
+        size_t index = (start + i) % queue->shard_count;
+        mqueue_shard_t * shard = &queue->shards[index];
+        pthread_mutex_lock(&shard->lock);
+        heap_result_t result = heap_pop_into(shard->heap, out);
+        pthread_mutex_unlock(&shard->lock);
+
+        if (HEAP_SUCCESS == result)
+        {
+            atomic_fetch_sub(&queue->length, 1);
+            return HEAP_SUCCESS;
+        }
+    }
+    return HEAP_FAILURE;
+}
+
+/*!
+ * @brief Wake a thread waiting in mqueue_pop if there is one. The wait lock
+ * is only taken when a thread is waiting.
+ * @param queue
+ */
+static void wake_waiter(mqueue_t * queue)
+{
+    if (0 == atomic_load(&queue->waiters))
+    {
+        return;
+    }
+    pthread_mutex_lock(&queue->wait_lock);
+    pthread_cond_signal(&queue->wait_cond);
+    pthread_mutex_unlock(&queue->wait_lock);
+}
+
+/*!
+ * @brief Unlock the shard if it is not NULL
+ * @param shard
+ */
+static void unlock_shard(mqueue_shard_t * shard)
+{
+    if (NULL != shard)
+    {
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+/*!
+ * @brief Return a random shard index using a xorshift generator local to the
+ * calling thread
+ * @param queue
+ * @return Index in the shards array
+ */
+static size_t get_random_index(mqueue_t * queue)
+{
+    if (0 == random_state)
+    {
+        // Any non zero seed works, the counter keeps the threads apart
+        random_state = (uint64_t)atomic_fetch_add(&seed_counter,
+                                                  0x9E3779B97F4A7C15ULL)
+                       ^ (uint64_t)(uintptr_t)&random_state;
+        random_state |= 1;
+    }
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return (size_t)(random_state % queue->shard_count);
+}
+
+/*!
+ * @brief Verify that the allocation was successful
+ * @param ptr Any allocated pointer
+ */
+static mqueue_pointer_t verify_alloc(void * ptr)
+{
+    if (NULL == ptr)
+    {
+        fprintf(stderr, "[!] Could not allocate memory!\n");
+        return INVALID_PTR;
+    }
+    return VALID_PTR;
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <multiqueue.h>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+heap_compare_t mqueue_int_cmp(void * payload, void * payload2)
+{
+    int val1 = * (int *)payload;
+    int val2 = * (int *)payload2;
+
+    if (val1 > val2)
+    {
+        return HEAP_GT;
+    } else if (val1 < val2)
+    {
+        return HEAP_LT;
+    } else
+    {
+        return HEAP_EQ;
+    }
+}
+
+void mqueue_payload_destroy(void * payload)
+{
+    free(payload);
+}
+
+TEST(MultiQueue, SingleShardIsExact)
+{
+    mqueue_t * queue = mqueue_init(1, 1, MIN_HEAP, HEAP_MEM, sizeof(int),
+                                   NULL, mqueue_int_cmp);
+    std::vector<int> values(1000);
+    std::mt19937 engine(1);
+    for (int & value : values)
+    {
+        value = (int)(engine() % 10000);
+        ASSERT_EQ(mqueue_insert(queue, &value), HEAP_SUCCESS);
+    }
+    EXPECT_EQ(mqueue_length(queue), values.size());
+
+    std::sort(values.begin(), values.end());
+    int value = 0;
+    for (int expected : values)
+    {
+        ASSERT_EQ(mqueue_try_pop(queue, &value), HEAP_SUCCESS);
+        EXPECT_EQ(value, expected);
+    }
+    EXPECT_TRUE(mqueue_is_empty(queue));
+    EXPECT_EQ(mqueue_try_pop(queue, &value), HEAP_FAILURE);
+    mqueue_destroy(queue);
+}
+
+TEST(MultiQueue, ShardedKeepsEveryItem)
+{
+    mqueue_t * queue = mqueue_init(4, 2, MAX_HEAP, HEAP_MEM, sizeof(int),
+                                   NULL, mqueue_int_cmp);
+    for (int i = 0; i < 5000; i++)
+    {
+        mqueue_insert(queue, &i);
+    }
+
+    std::vector<int> popped;
+    int value = 0;
+    while (HEAP_SUCCESS == mqueue_try_pop(queue, &value))
+    {
+        popped.push_back(value);
+    }
+    ASSERT_EQ(popped.size(), 5000);
+
+    // The order is relaxed but the first item comes from the top of a shard
+    EXPECT_GT(popped.front(), 4000);
+    std::sort(popped.begin(), popped.end());
+    for (int i = 0; i < 5000; i++)
+    {
+        EXPECT_EQ(popped[(size_t)i], i);
+    }
+    mqueue_destroy(queue);
+}
+
+TEST(MultiQueue, DestroyFreesPtrPayloads)
+{
+    mqueue_t * queue = mqueue_init(2, 2, MIN_HEAP, HEAP_PTR, 0,
+                                   mqueue_payload_destroy, mqueue_int_cmp);
+    for (int i = 0; i < 100; i++)
+    {
+        int * payload = (int *)malloc(sizeof(int));
+        * payload = i;
+        mqueue_insert(queue, payload);
+    }
+    int * payload = NULL;
+    ASSERT_EQ(mqueue_try_pop(queue, &payload), HEAP_SUCCESS);
+    free(payload);
+    mqueue_destroy(queue);
+}
+
+TEST(MultiQueue, ConcurrentProducersConsumers)
+{
+    const int thread_count = 8;
+    const int per_thread = 20000;
+    mqueue_t * queue = mqueue_init(thread_count, 2, MIN_HEAP, HEAP_MEM,
+                                   sizeof(int), NULL, mqueue_int_cmp);
+
+    std::vector<std::atomic<int>> seen(thread_count * per_thread);
+    for (std::atomic<int> & count : seen)
+    {
+        count = 0;
+    }
+
+    std::vector<std::thread> consumers;
+    for (int t = 0; t < thread_count; t++)
+    {
+        consumers.emplace_back([&]() {
+            int value = 0;
+            while (HEAP_SUCCESS == mqueue_pop(queue, &value))
+            {
+                seen[(size_t)value]++;
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < thread_count; t++)
+    {
+        producers.emplace_back([&, t]() {
+            int value = 0;
+            for (int i = 0; i < per_thread; i++)
+            {
+                value = (t * per_thread) + i;
+                mqueue_insert(queue, &value);
+
+                // Mix in non blocking pops to contend on the same shards
+                if ((i % 16 == 0)
+                    && (HEAP_SUCCESS == mqueue_try_pop(queue, &value)))
+                {
+                    seen[(size_t)value]++;
+                }
+            }
+        });
+    }
+
+    for (std::thread & producer : producers)
+    {
+        producer.join();
+    }
+    mqueue_close(queue);
+    for (std::thread & consumer : consumers)
+    {
+        consumer.join();
+    }
+
+    EXPECT_TRUE(mqueue_is_empty(queue));
+    for (std::atomic<int> & count : seen)
+    {
+        ASSERT_EQ(count.load(), 1);
+    }
+    mqueue_destroy(queue);
+}
+
+TEST(MultiQueue, CloseWakesWaiters)
+{
+    mqueue_t * queue = mqueue_init(2, 2, MIN_HEAP, HEAP_MEM, sizeof(int),
+                                   NULL, mqueue_int_cmp);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> waiters;
+    for (int t = 0; t < 4; t++)
+    {
+        waiters.emplace_back([&]() {
+            int value = 0;
+            if (HEAP_FAILURE == mqueue_pop(queue, &value))
+            {
+                failures++;
+            }
+        });
+    }
+    mqueue_close(queue);
+    for (std::thread & waiter : waiters)
+    {
+        waiter.join();
+    }
+    EXPECT_EQ(failures.load(), 4);
+    mqueue_destroy(queue);
+}
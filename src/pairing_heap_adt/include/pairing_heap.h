@@ -0,0 +1,37 @@
+#ifndef PAIRING_HEAP_H
+#define PAIRING_HEAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <heap.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * The pairing heap shares the heap_type_t, heap_data_mode_t, heap_compare_t
+ * and heap_result_t types with the array heap so the same compare and
+ * destroy callbacks can be used with both.
+ */
+typedef struct pheap_t pheap_t;
+
+pheap_t * pheap_init(heap_type_t type,
+                     heap_data_mode_t data_mode,
+                     size_t payload_size,
+                     void (* destroy)(void *),
+                     heap_compare_t (* compare)(void *, void *));
+void pheap_destroy(pheap_t * heap);
+heap_result_t pheap_insert(pheap_t * heap, void * payload);
+void * pheap_pop(pheap_t * heap);
+heap_result_t pheap_pop_into(pheap_t * heap, void * out);
+void * pheap_peek_ref(pheap_t * heap);
+heap_result_t pheap_meld(pheap_t * heap, pheap_t * other);
+void pheap_dump(pheap_t * heap);
+size_t pheap_length(pheap_t * heap);
+bool pheap_is_empty(pheap_t * heap);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+#endif //PAIRING_HEAP_H
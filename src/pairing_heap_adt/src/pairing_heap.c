@@ -0,0 +1,631 @@
+#include <pairing_heap.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+typedef enum
+{
+    POOL_BASE_NODES = 16,
+    POOL_MAX_NODES = 1024,
+} pheap_default_t;
+
+// Enum for determining if malloc calls were valid
+typedef enum
+{
+    VALID_PTR = 1,
+    INVALID_PTR = 0
+} pheap_pointer_t;
+
+// Every node of the heap is a link to its first child and to its next
+// sibling. The payload follows the links in the same block of memory.
+typedef struct pheap_node_t
+{
+    struct pheap_node_t * child;    // Leftmost child of the node
+    struct pheap_node_t * sibling;  // Next sibling or next free node
+} pheap_node_t;
+
+// Slabs are the blocks of nodes allocated by the pool. The nodes follow the
+// header in the same block of memory.
+typedef struct pheap_slab_t
+{
+    struct pheap_slab_t * next;
+} pheap_slab_t;
+
+typedef struct pheap_t
+{
+    size_t length;                  // Number of nodes in the heap
+    size_t payload_size;            // Size of the payload passed in
+    size_t node_size;               // Size of each node in the slabs
+    heap_data_mode_t data_mode;     // Mode being pointer mode or data mode
+
+    heap_compare_t heap_type;
+    pheap_node_t * root;
+    heap_compare_t (* compare)(void * payload, void * payload2);
+    void (* destroy)(void * payload);
+
+    // The node pool. Both lists keep their tail so that melding two heaps
+    // can hand over the pool of the other heap in O(1)
+    pheap_slab_t * slabs;           // Every slab allocated by the pool
+    pheap_slab_t * last_slab;
+    pheap_node_t * free_nodes;      // Nodes ready to be handed out
+    pheap_node_t * last_free;
+    size_t slab_nodes;              // Number of nodes in the next slab
+} pheap_t;
+
+static pheap_node_t * link_trees(pheap_t * heap,
+                                 pheap_node_t * left,
+                                 pheap_node_t * right);
+static pheap_node_t * merge_pairs(pheap_t * heap, pheap_node_t * first);
+static pheap_node_t * remove_root(pheap_t * heap);
+static void copy_out(pheap_t * heap, pheap_node_t * node, void * out);
+
+static pheap_node_t * acquire_node(pheap_t * heap);
+static void release_node(pheap_t * heap, pheap_node_t * node);
+static pheap_pointer_t grow_pool(pheap_t * heap);
+
+static size_t get_aligned(size_t size);
+static size_t get_slot_size(pheap_t * heap);
+static uint8_t * get_slot(pheap_node_t * node);
+static void * get_value(pheap_t * heap, pheap_node_t * node);
+static bool is_compatible(pheap_t * heap, pheap_t * other);
+
+static pheap_pointer_t verify_alloc(void * ptr);
+
+
+
+/*!
+ * @brief Create the pairing heap
+ *
+ * The pairing heap is a tree where every node is smaller (MIN_HEAP) or
+ * larger (MAX_HEAP) than its children. Inserting and melding two heaps only
+ * link two roots together and run in O(1), while removing the root pairs up
+ * its children and runs in amortized O(log n).
+ *
+ * The nodes are handed out by a pool that allocates them in slabs, so
+ * inserting does not call malloc for every node and a heap that is popped and
+ * refilled reuses the same nodes.
+ * @param type Heap type, max heap or min heap
+ * @param data_mode Data storage strategy
+ * @param payload_size The size of the payload. This can be 0 if using HEAP_PTR
+ * @param destroy Pointer to function that frees the block of memory
+ * @param compare Pointer to function that compares the nodes
+ * @return Pointer to pheap_t or NULL
+ */
+pheap_t * pheap_init(heap_type_t type,
+                     heap_data_mode_t data_mode,
+                     size_t payload_size,
+                     void (* destroy)(void *),
+                     heap_compare_t (* compare)(void *, void *))
+{
+    assert(compare);
+    pheap_t * heap = (pheap_t *)malloc(sizeof(pheap_t));
+    if (INVALID_PTR == verify_alloc((void *)heap))
+    {
+        return NULL;
+    }
+
+    * heap = (pheap_t){
+        .length             = 0,
+        .payload_size       = payload_size,
+        .node_size          = 0,
+        .data_mode          = data_mode,
+
+        .heap_type          = type ? HEAP_LT : HEAP_GT,
+        .root               = NULL,
+
+        .compare            = compare,
+        .destroy            = destroy,
+
+        .slabs              = NULL,
+        .last_slab          = NULL,
+        .free_nodes         = NULL,
+        .last_free          = NULL,
+        .slab_nodes         = POOL_BASE_NODES
+    };
+    heap->node_size = get_aligned(sizeof(pheap_node_t))
+                      + get_aligned(get_slot_size(heap));
+    return heap;
+}
+
+/*!
+ * @brief Destroy the heap, its nodes and the payloads in HEAP_PTR mode
+ * @param heap
+ */
+void pheap_destroy(pheap_t * heap)
+{
+    assert(heap);
+    pheap_dump(heap);
+
+    pheap_slab_t * slab = heap->slabs;
+    while (NULL != slab)
+    {
+        pheap_slab_t * next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    free(heap);
+}
+
+/*!
+ * @brief Insert the payload into the heap in O(1)
+ * @param heap
+ * @param payload Pointer to the payload. In HEAP_MEM mode the payload is
+ * copied into the heap.
+ * @return HEAP_SUCCESS or HEAP_FAILURE if a node could not be allocated
+ */
+heap_result_t pheap_insert(pheap_t * heap, void * payload)
+{
+    assert(heap);
+    pheap_node_t * node = acquire_node(heap);
+    if (NULL == node)
+    {
+        return HEAP_FAILURE;
+    }
+
+    * node = (pheap_node_t){
+        .child      = NULL,
+        .sibling    = NULL
+    };
+    if (HEAP_PTR == heap->data_mode)
+    {
+        memcpy(get_slot(node), &payload, sizeof(void *));
+    }
+    else
+    {
+        memcpy(get_slot(node), payload, heap->payload_size);
+    }
+
+    heap->root = (NULL == heap->root)
+                 ? node
+                 : link_trees(heap, heap->root, node);
+    heap->length++;
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Remove the root of the heap and return it
+ *
+ * In HEAP_PTR mode the stored pointer is returned. In HEAP_MEM mode a copy
+ * of the payload is allocated which the caller must free.
+ * @param heap
+ * @return Pointer to the payload or NULL if the heap is empty
+ */
+void * pheap_pop(pheap_t * heap)
+{
+    assert(heap);
+    if (NULL == heap->root)
+    {
+        return NULL;
+    }
+
+    void * payload = NULL;
+    if (HEAP_PTR == heap->data_mode)
+    {
+        copy_out(heap, heap->root, &payload);
+    }
+    else
+    {
+        payload = malloc(heap->payload_size);
+        if (INVALID_PTR == verify_alloc(payload))
+        {
+            return NULL;
+        }
+        copy_out(heap, heap->root, payload);
+    }
+    release_node(heap, remove_root(heap));
+    return payload;
+}
+
+/*!
+ * @brief Remove the root of the heap and copy it into the memory passed in.
+ * No memory is allocated.
+ * @param heap
+ * @param out Memory of the payload size in HEAP_MEM mode or a pointer to a
+ * void pointer in HEAP_PTR mode
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the heap is empty
+ */
+heap_result_t pheap_pop_into(pheap_t * heap, void * out)
+{
+    assert(heap);
+    assert(out);
+    if (NULL == heap->root)
+    {
+        return HEAP_FAILURE;
+    }
+
+    copy_out(heap, heap->root, out);
+    release_node(heap, remove_root(heap));
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Return the payload of the root without removing it. The pointer is
+ * only valid until the next call that modifies the heap.
+ * @param heap
+ * @return Pointer to the payload or NULL if the heap is empty
+ */
+void * pheap_peek_ref(pheap_t * heap)
+{
+    assert(heap);
+    if (NULL == heap->root)
+    {
+        return NULL;
+    }
+    return get_value(heap, heap->root);
+}
+
+/*!
+ * @brief Move every item of the other heap into the heap in O(1)
+ *
+ * The roots of the two heaps are linked and the node pool of the other heap
+ * is handed over without copying any node. The other heap is left empty and
+ * can still be used or destroyed. Both heaps must have been created with the
+ * same type, data mode, payload size and callbacks.
+ * @param heap Heap receiving the items
+ * @param other Heap giving away its items
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the heaps can not be melded
+ */
+heap_result_t pheap_meld(pheap_t * heap, pheap_t * other)
+{
+    assert(heap);
+    assert(other);
+    if ((heap == other) || (!is_compatible(heap, other)))
+    {
+        return HEAP_FAILURE;
+    }
+
+    if (NULL != other->root)
+    {
+        heap->root = (NULL == heap->root)
+                     ? other->root
+                     : link_trees(heap, heap->root, other->root);
+        heap->length += other->length;
+    }
+
+    // Hand over the slabs and the free nodes of the other pool
+    if (NULL != other->slabs)
+    {
+        if (NULL == heap->slabs)
+        {
+            heap->slabs = other->slabs;
+        }
+        else
+        {
+            heap->last_slab->next = other->slabs;
+        }
+        heap->last_slab = other->last_slab;
+    }
+    if (NULL != other->free_nodes)
+    {
+        if (NULL == heap->free_nodes)
+        {
+            heap->free_nodes = other->free_nodes;
+        }
+        else
+        {
+            heap->last_free->sibling = other->free_nodes;
+        }
+        heap->last_free = other->last_free;
+    }
+
+    other->root = NULL;
+    other->length = 0;
+    other->slabs = NULL;
+    other->last_slab = NULL;
+    other->free_nodes = NULL;
+    other->last_free = NULL;
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Remove every item of the heap. In HEAP_PTR mode the payloads are
+ * freed with the destroy callback. The nodes are kept in the pool.
+ * @param heap
+ */
+void pheap_dump(pheap_t * heap)
+{
+    assert(heap);
+    pheap_node_t * node = heap->root;
+    while (NULL != node)
+    {
+        // Move the children in front of the remaining siblings so the whole
+        // tree is walked as a single list
+        if (NULL != node->child)
+        {
+            pheap_node_t * tail = node->child;
+            while (NULL != tail->sibling)
+            {
+                tail = tail->sibling;
+            }
+            tail->sibling = node->sibling;
+            node->sibling = node->child;
+            node->child = NULL;
+        }
+
+        pheap_node_t * next = node->sibling;
+        if ((HEAP_PTR == heap->data_mode) && (NULL != heap->destroy))
+        {
+            heap->destroy(get_value(heap, node));
+        }
+        release_node(heap, node);
+        node = next;
+    }
+    heap->root = NULL;
+    heap->length = 0;
+}
+
+/*!
+ * @brief Return the number of items in the heap
+ * @param heap
+ * @return Number of items
+ */
+size_t pheap_length(pheap_t * heap)
+{
+    assert(heap);
+    return heap->length;
+}
+
+/*!
+ * @brief Check if the heap is empty
+ * @param heap
+ * @return True if empty
+ */
+bool pheap_is_empty(pheap_t * heap)
+{
+    assert(heap);
+    return NULL == heap->root;
+}
+
+/*!
+ * @brief Link two trees by making the root that loses the comparison the
+ * leftmost child of the other root
+ * @param heap
+ * @param left Root of a tree without siblings
+ * @param right Root of a tree without siblings
+ * @return Root of the linked tree
+ */
+static pheap_node_t * link_trees(pheap_t * heap,
+                                 pheap_node_t * left,
+                                 pheap_node_t * right)
+{
+    if (heap->heap_type == heap->compare(get_value(heap, right),
+                                         get_value(heap, left)))
+    {
+        pheap_node_t * temp = left;
+        left = right;
+        right = temp;
+    }
+    right->sibling = left->child;
+    left->child = right;
+    return left;
+}
+
+/*!
+ * @brief Combine a list of siblings into a single tree with the two pass
+ * pairing. The first pass links the siblings in pairs from left to right and
+ * the second pass links the pairs from right to left. This is what gives the
+ * amortized O(log n) removal of the root.
+ * @param heap
+ * @param first First node of the list of siblings
+ * @return Root of the combined tree or NULL if the list is empty
+ */
+static pheap_node_t * merge_pairs(pheap_t * heap, pheap_node_t * first)
+{
+    // The pairs are kept in reverse order, chained through their siblings,
+    // so the second pass can start from the rightmost pair
+    pheap_node_t * pairs = NULL;
+    while (NULL != first)
+    {
+        pheap_node_t * left = first;
+        pheap_node_t * right = left->sibling;
+        if (NULL == right)
+        {
+            left->sibling = pairs;
+            pairs = left;
+            break;
+        }
+
+        first = right->sibling;
+        left->sibling = NULL;
+        right->sibling = NULL;
+        left = link_trees(heap, left, right);
+        left->sibling = pairs;
+        pairs = left;
+    }
+
+    pheap_node_t * root = NULL;
+    while (NULL != pairs)
+    {
+        pheap_node_t * next = pairs->sibling;
+        pairs->sibling = NULL;
+        root = (NULL == root) ? pairs : link_trees(heap, root, pairs);
+        pairs = next;
+    }
+    return root;
+}
+
+/*!
+ * @brief Unlink the root from the heap and replace it with its paired up
+ * children
+ * @param heap
+ * @return The node that was the root
+ */
+static pheap_node_t * remove_root(pheap_t * heap)
+{
+    pheap_node_t * node = heap->root;
+    heap->root = merge_pairs(heap, node->child);
+    heap->length--;
+    return node;
+}
+
+/*!
+ * @brief Copy the payload of the node into the memory passed in. This is the
+ * stored pointer in HEAP_PTR mode and the payload in HEAP_MEM mode
+ * @param heap
+ * @param node
+ * @param out
+ */
+static void copy_out(pheap_t * heap, pheap_node_t * node, void * out)
+{
+    memcpy(out, get_slot(node), get_slot_size(heap));
+}
+
+/*!
+ * @brief Take a node from the pool. A new slab is allocated if the pool ran
+ * out of free nodes.
+ * @param heap
+ * @return Pointer to the node or NULL if the allocation failed
+ */
+static pheap_node_t * acquire_node(pheap_t * heap)
+{
+    if ((NULL == heap->free_nodes) && (INVALID_PTR == grow_pool(heap)))
+    {
+        return NULL;
+    }
+
+    pheap_node_t * node = heap->free_nodes;
+    heap->free_nodes = node->sibling;
+    if (NULL == heap->free_nodes)
+    {
+        heap->last_free = NULL;
+    }
+    return node;
+}
+
+/*!
+ * @brief Give the node back to the pool
+ * @param heap
+ * @param node
+ */
+static void release_node(pheap_t * heap, pheap_node_t * node)
+{
+    node->child = NULL;
+    node->sibling = heap->free_nodes;
+    if (NULL == heap->free_nodes)
+    {
+        heap->last_free = node;
+    }
+    heap->free_nodes = node;
+}
+
+/*!
+ * @brief Allocate a new slab and chain its nodes into the free nodes. Each
+ * slab is twice the size of the previous one up to POOL_MAX_NODES.
+ * @param heap
+ * @return VALID_PTR or INVALID_PTR if the allocation failed
+ */
+static pheap_pointer_t grow_pool(pheap_t * heap)
+{
+    size_t header_size = get_aligned(sizeof(pheap_slab_t));
+    pheap_slab_t * slab = (pheap_slab_t *)malloc(
+        header_size + (heap->slab_nodes * heap->node_size));
+    if (INVALID_PTR == verify_alloc((void *)slab))
+    {
+        return INVALID_PTR;
+    }
+
+    slab->next = NULL;
+    if (NULL == heap->slabs)
+    {
+        heap->slabs = slab;
+    }
+    else
+    {
+        heap->last_slab->next = slab;
+    }
+    heap->last_slab = slab;
+
+    uint8_t * nodes = (uint8_t *)slab + header_size;
+    for (size_t i = heap->slab_nodes; i > 0; i--)
+    {
+        release_node(heap,
+                     (pheap_node_t *)(nodes + ((i - 1) * heap->node_size)));
+    }
+
+    if (heap->slab_nodes < POOL_MAX_NODES)
+    {
+        heap->slab_nodes = heap->slab_nodes * 2;
+    }
+    return VALID_PTR;
+}
+
+/*!
+ * @brief Round the size up to the alignment of any payload type
+ * @param size
+ * @return Aligned size
+ */
+static size_t get_aligned(size_t size)
+{
+    size_t alignment = _Alignof(max_align_t);
+    return ((size + alignment - 1) / alignment) * alignment;
+}
+
+/*!
+ * @brief Return the size of the payload slot of a node. This is the size of
+ * a pointer in HEAP_PTR mode and the size of the payload in HEAP_MEM mode
+ * @param heap
+ * @return Size of the slot in bytes
+ */
+static size_t get_slot_size(pheap_t * heap)
+{
+    return (HEAP_PTR == heap->data_mode) ? sizeof(void *) : heap->payload_size;
+}
+
+/*!
+ * @brief Return the address of the payload slot following the node links
+ * @param node
+ * @return Pointer to the slot
+ */
+static uint8_t * get_slot(pheap_node_t * node)
+{
+    return (uint8_t *)node + get_aligned(sizeof(pheap_node_t));
+}
+
+/*!
+ * @brief Return the payload of the node. This is the stored pointer in
+ * HEAP_PTR mode and a pointer into the node in HEAP_MEM mode
+ * @param heap
+ * @param node
+ * @return Pointer to the payload
+ */
+static void * get_value(pheap_t * heap, pheap_node_t * node)
+{
+    if (HEAP_PTR == heap->data_mode)
+    {
+        void * payload = NULL;
+        memcpy(&payload, get_slot(node), sizeof(void *));
+        return payload;
+    }
+    return get_slot(node);
+}
+
+/*!
+ * @brief Check that the nodes of the other heap can be moved into the heap
+ * @param heap
+ * @param other
+ * @return True if both heaps store and order the items the same way
+ */
+static bool is_compatible(pheap_t * heap, pheap_t * other)
+{
+    return (heap->heap_type == other->heap_type)
+           && (heap->data_mode == other->data_mode)
+           && (heap->payload_size == other->payload_size)
+           && (heap->compare == other->compare)
+           && (heap->destroy == other->destroy);
+}
+
+/*!
+ * @brief Verify that the allocation was successful
+ * @param ptr Any allocated pointer
+ */
+static pheap_pointer_t verify_alloc(void * ptr)
+{
+    if (NULL == ptr)
+    {
+        fprintf(stderr, "[!] Could not allocate memory!\n");
+        return INVALID_PTR;
+    }
+    return VALID_PTR;
+}
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <pairing_heap.h>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+/*
+ * Compare function for both modes. In HEAP_PTR mode the payloads are the
+ * pointers that were inserted
+ */
+heap_compare_t pheap_int_cmp(void * payload, void * payload2)
+{
+    int val1 = * (int *)payload;
+    int val2 = * (int *)payload2;
+
+    if (val1 > val2)
+    {
+        return HEAP_GT;
+    } else if (val1 < val2)
+    {
+        return HEAP_LT;
+    } else
+    {
+        return HEAP_EQ;
+    }
+}
+
+void pheap_payload_destroy(void * payload)
+{
+    free(payload);
+}
+
+std::vector<int> get_random_values(size_t count, unsigned seed)
+{
+    std::mt19937 engine(seed);
+    std::uniform_int_distribution<int> distribution(-5000, 5000);
+    std::vector<int> values(count);
+    for (int & value : values)
+    {
+        value = distribution(engine);
+    }
+    return values;
+}
+
+class PairingHeapFixture : public ::testing::Test
+{
+public:
+    pheap_t * min_heap;
+    pheap_t * max_heap;
+
+protected:
+    void SetUp() override
+    {
+        min_heap = pheap_init(MIN_HEAP, HEAP_MEM, sizeof(int), NULL,
+                              pheap_int_cmp);
+        max_heap = pheap_init(MAX_HEAP, HEAP_PTR, 0, pheap_payload_destroy,
+                              pheap_int_cmp);
+    }
+
+    void TearDown() override
+    {
+        pheap_destroy(min_heap);
+        pheap_destroy(max_heap);
+    }
+};
+
+TEST_F(PairingHeapFixture, TestPopOrder)
+{
+    std::vector<int> values = get_random_values(1000, 1);
+    for (int value : values)
+    {
+        EXPECT_EQ(pheap_insert(min_heap, &value), HEAP_SUCCESS);
+        int * payload = (int *)malloc(sizeof(int));
+        * payload = value;
+        EXPECT_EQ(pheap_insert(max_heap, payload), HEAP_SUCCESS);
+    }
+    EXPECT_EQ(pheap_length(min_heap), values.size());
+
+    std::sort(values.begin(), values.end());
+    int value = 0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        EXPECT_EQ(* (int *)pheap_peek_ref(min_heap), values[i]);
+        EXPECT_EQ(pheap_pop_into(min_heap, &value), HEAP_SUCCESS);
+        EXPECT_EQ(value, values[i]);
+
+        int * payload = (int *)pheap_pop(max_heap);
+        EXPECT_EQ(* payload, values[values.size() - i - 1]);
+        free(payload);
+    }
+    EXPECT_TRUE(pheap_is_empty(min_heap));
+    EXPECT_EQ(pheap_pop_into(min_heap, &value), HEAP_FAILURE);
+    EXPECT_EQ(pheap_pop(max_heap), nullptr);
+    EXPECT_EQ(pheap_peek_ref(max_heap), nullptr);
+}
+
+TEST_F(PairingHeapFixture, TestPopAllocates)
+{
+    int value = 42;
+    pheap_insert(min_heap, &value);
+    int * payload = (int *)pheap_pop(min_heap);
+    EXPECT_EQ(* payload, 42);
+    free(payload);
+}
+
+TEST_F(PairingHeapFixture, TestMeld)
+{
+    pheap_t * other = pheap_init(MIN_HEAP, HEAP_MEM, sizeof(int), NULL,
+                                 pheap_int_cmp);
+    std::vector<int> values = get_random_values(500, 2);
+    std::vector<int> other_values = get_random_values(700, 3);
+    for (int value : values)
+    {
+        pheap_insert(min_heap, &value);
+    }
+    for (int value : other_values)
+    {
+        pheap_insert(other, &value);
+    }
+
+    EXPECT_EQ(pheap_meld(min_heap, other), HEAP_SUCCESS);
+    EXPECT_TRUE(pheap_is_empty(other));
+    EXPECT_EQ(pheap_length(other), 0);
+    EXPECT_EQ(pheap_length(min_heap), values.size() + other_values.size());
+
+    // The emptied heap is still usable after giving away its pool
+    int extra = -10000;
+    pheap_insert(other, &extra);
+    EXPECT_EQ(pheap_meld(min_heap, other), HEAP_SUCCESS);
+    values.push_back(extra);
+
+    values.insert(values.end(), other_values.begin(), other_values.end());
+    std::sort(values.begin(), values.end());
+    int value = 0;
+    for (int expected : values)
+    {
+        EXPECT_EQ(pheap_pop_into(min_heap, &value), HEAP_SUCCESS);
+        EXPECT_EQ(value, expected);
+    }
+    EXPECT_TRUE(pheap_is_empty(min_heap));
+    pheap_destroy(other);
+}
+
+TEST_F(PairingHeapFixture, TestMeldIncompatible)
+{
+    pheap_t * other = pheap_init(MAX_HEAP, HEAP_MEM, sizeof(int), NULL,
+                                 pheap_int_cmp);
+    int value = 1;
+    pheap_insert(other, &value);
+    EXPECT_EQ(pheap_meld(min_heap, other), HEAP_FAILURE);
+    EXPECT_EQ(pheap_meld(min_heap, max_heap), HEAP_FAILURE);
+    EXPECT_EQ(pheap_meld(min_heap, min_heap), HEAP_FAILURE);
+    EXPECT_EQ(pheap_length(other), 1);
+    EXPECT_TRUE(pheap_is_empty(min_heap));
+    pheap_destroy(other);
+}
+
+TEST_F(PairingHeapFixture, TestDumpKeepsHeapUsable)
+{
+    for (int i = 0; i < 100; i++)
+    {
+        int * payload = (int *)malloc(sizeof(int));
+        * payload = i;
+        pheap_insert(max_heap, payload);
+    }
+    // Pop a few to build a deeper tree before dumping it
+    for (int i = 0; i < 10; i++)
+    {
+        free(pheap_pop(max_heap));
+    }
+    pheap_dump(max_heap);
+    EXPECT_TRUE(pheap_is_empty(max_heap));
+
+    int * payload = (int *)malloc(sizeof(int));
+    * payload = 7;
+    pheap_insert(max_heap, payload);
+    EXPECT_EQ(* (int *)pheap_peek_ref(max_heap), 7);
+}
+
+TEST_F(PairingHeapFixture, TestRandomOperations)
+{
+    std::priority_queue<int, std::vector<int>, std::greater<int>> expected;
+    std::mt19937 engine(4);
+    std::uniform_int_distribution<int> distribution(-100, 100);
+    int value = 0;
+    for (int i = 0; i < 20000; i++)
+    {
+        if ((expected.empty()) || (engine() % 3 != 0))
+        {
+            value = distribution(engine);
+            pheap_insert(min_heap, &value);
+            expected.push(value);
+        }
+        else
+        {
+            ASSERT_EQ(pheap_pop_into(min_heap, &value), HEAP_SUCCESS);
+            ASSERT_EQ(value, expected.top());
+            expected.pop();
+        }
+        ASSERT_EQ(pheap_length(min_heap), expected.size());
+    }
+}
@@ -17,6 +17,9 @@ typedef enum
 
 // constructors
 queue_t * queue_init(size_t queue_size, queue_status_t (* compare_func)(void*, void *));
+queue_t * queue_init_intrusive(size_t queue_size,
+                               size_t link_offset,
+                               queue_status_t (* compare_func)(void*, void *));
 void queue_destroy(queue_t * queue);
 void queue_destroy_free(queue_t * queue, void (* free_func)(void * data));
 
@@ -30,6 +33,7 @@ void * queue_dequeue(queue_t * queue);
 queue_t * queue_get_by_index(queue_t * queue, size_t index);
 queue_t * queue_get_by_value(queue_t * queue, void * data);
 void * queue_remove(queue_t * queue, void * data);
+void queue_unlink(queue_t * queue, void * data);
 void queue_clear(queue_t * queue);
 
 
@@ -3,13 +3,23 @@
 #include <stdio.h>
 #include <assert.h>
 #include <dl_list.h>
+#include <dl_ilist.h>
 
 typedef struct queue_t
 {
-    dlist_t * dlist;
+    dlist_t * dlist;        // NULL for an intrusive queue
+    ilist_t ilist;          // Links embedded in the data of an intrusive queue
+    size_t link_offset;     // Offset of the link in the data
     size_t queue_size;
+    queue_status_t (* compare_func)(void *, void *);
 } queue_t;
 
+static void * get_data(queue_t * queue, ilist_link_t * link);
+static ilist_link_t * get_link(queue_t * queue, void * data);
+static ilist_link_t * find_link(queue_t * queue, void * data);
+
+
+
 /*!
  * @brief Initialize the queue structure. A NULL is returned if there was a
  * failure in the creation of the structure
@@ -20,7 +30,8 @@ typedef struct queue_t
 queue_t * queue_init(size_t queue_size, queue_status_t (* compare_func)(void*, void *))
 {
     // dlist will abort if it cannot allocate
-    dlist_t * dlist = dlist_init((dlist_match_t (*)(void *,void *))compare_func);
+    dlist_t * dlist = dlist_init_pooled(
+        (dlist_match_t (*)(void *,void *))compare_func, NULL);
 
     queue_t * queue = (queue_t * )malloc(sizeof(queue_t));
     if (NULL == queue)
@@ -31,9 +42,43 @@ queue_t * queue_init(size_t queue_size, queue_status_t (* compare_func)(void*, v
     }
     *queue = (queue_t)
         {
-            .dlist      = dlist,
-            .queue_size = queue_size
+            .dlist          = dlist,
+            .queue_size     = queue_size,
+            .compare_func   = compare_func
+        };
+
+    return queue;
+}
+
+/*!
+ * @brief Initialize a queue that links the data together through an
+ * ilist_link_t embedded in the data, so enqueue and dequeue never allocate.
+ *
+ * The link is found at link_offset bytes into every item, as given by
+ * offsetof. An item can only be in one intrusive queue per link at a time.
+ * @param queue_size
+ * @param link_offset Offset of the ilist_link_t in the items
+ * @param compare_func
+ * @return NULL on failure or the queue
+ */
+queue_t * queue_init_intrusive(size_t queue_size,
+                               size_t link_offset,
+                               queue_status_t (* compare_func)(void*, void *))
+{
+    queue_t * queue = (queue_t * )malloc(sizeof(queue_t));
+    if (NULL == queue)
+    {
+        fprintf(stderr, "[!] Invalid allocation\n");
+        return NULL;
+    }
+    *queue = (queue_t)
+        {
+            .dlist          = NULL,
+            .link_offset    = link_offset,
+            .queue_size     = queue_size,
+            .compare_func   = compare_func
         };
+    ilist_init(&queue->ilist);
 
     return queue;
 }
@@ -56,7 +101,16 @@ void queue_destroy(queue_t * queue)
 void queue_destroy_free(queue_t * queue, void (* free_func)(void * data))
 {
     assert(queue);
-    if (NULL != free_func)
+    if (NULL == queue->dlist)
+    {
+        ilist_link_t * link = ilist_pop_head(&queue->ilist);
+        while ((NULL != free_func) && (NULL != link))
+        {
+            free_func(get_data(queue, link));
+            link = ilist_pop_head(&queue->ilist);
+        }
+    }
+    else if (NULL != free_func)
     {
         dlist_destroy_free(queue->dlist, free_func);
     }
@@ -74,6 +128,10 @@ void queue_destroy_free(queue_t * queue, void (* free_func)(void * data))
  */
 size_t queue_length(queue_t * queue)
 {
+    if (NULL == queue->dlist)
+    {
+        return ilist_get_length(&queue->ilist);
+    }
     return dlist_get_length(queue->dlist);
 }
 
@@ -102,6 +160,11 @@ queue_status_t queue_enqueue(queue_t * queue, void * data)
         return Q_FAILURE;
     }
 
+    if (NULL == queue->dlist)
+    {
+        ilist_push_tail(&queue->ilist, get_link(queue, data));
+        return Q_SUCCESS;
+    }
     dlist_append(queue->dlist, data);
     return Q_SUCCESS;
 }
@@ -117,6 +180,10 @@ void * queue_dequeue(queue_t * queue)
     {
         return NULL;
     }
+    if (NULL == queue->dlist)
+    {
+        return get_data(queue, ilist_pop_head(&queue->ilist));
+    }
     return dlist_pop_head(queue->dlist);
 }
 
@@ -129,6 +196,10 @@ void * queue_dequeue(queue_t * queue)
  */
 queue_t * queue_get_by_value(queue_t * queue, void * data)
 {
+    if (NULL == queue->dlist)
+    {
+        return get_data(queue, find_link(queue, data));
+    }
     return dlist_get_by_value(queue->dlist, data);
 }
 
@@ -141,6 +212,15 @@ queue_t * queue_get_by_value(queue_t * queue, void * data)
  */
 queue_t * queue_get_by_index(queue_t * queue, size_t index)
 {
+    if (NULL == queue->dlist)
+    {
+        ilist_link_t * link = ilist_get_head(&queue->ilist);
+        for (size_t i = 0; (i < index) && (NULL != link); i++)
+        {
+            link = ilist_get_next(&queue->ilist, link);
+        }
+        return get_data(queue, link);
+    }
     return dlist_get_by_index(queue->dlist, (int)index);
 }
 
@@ -156,5 +236,71 @@ void * queue_remove(queue_t * queue, void * data)
     assert(queue);
     assert(data);
 
+    if (NULL == queue->dlist)
+    {
+        ilist_link_t * link = find_link(queue, data);
+        if (NULL != link)
+        {
+            ilist_remove(&queue->ilist, link);
+        }
+        return get_data(queue, link);
+    }
     return dlist_remove_value(queue->dlist, data);
 }
+
+/*!
+ * @brief Remove the item itself from an intrusive queue in O(1). The item
+ * must be in the queue.
+ * @param queue Queue created with queue_init_intrusive
+ * @param data Item in the queue
+ */
+void queue_unlink(queue_t * queue, void * data)
+{
+    assert(queue);
+    assert(data);
+    assert(NULL == queue->dlist);
+    ilist_remove(&queue->ilist, get_link(queue, data));
+}
+
+/*!
+ * @brief Return the item the link is embedded in
+ * @param queue
+ * @param link
+ * @return Item or NULL if the link is NULL
+ */
+static void * get_data(queue_t * queue, ilist_link_t * link)
+{
+    return (NULL == link) ? NULL : (char *)link - queue->link_offset;
+}
+
+/*!
+ * @brief Return the link embedded in the item
+ * @param queue
+ * @param data
+ * @return Link of the item
+ */
+static ilist_link_t * get_link(queue_t * queue, void * data)
+{
+    return (ilist_link_t *)((char *)data + queue->link_offset);
+}
+
+/*!
+ * @brief Find the link of the first item matching the data with the
+ * comparison function
+ * @param queue
+ * @param data
+ * @return Link or NULL if no item matched
+ */
+static ilist_link_t * find_link(queue_t * queue, void * data)
+{
+    ilist_link_t * link = ilist_get_head(&queue->ilist);
+    while (NULL != link)
+    {
+        if (Q_MATCH == queue->compare_func(get_data(queue, link), data))
+        {
+            return link;
+        }
+        link = ilist_get_next(&queue->ilist, link);
+    }
+    return NULL;
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <dl_queue.h>
+#include <dl_ilist.h>
 
 /*
  * Helper Functions for testing
@@ -153,3 +154,55 @@ TEST_F(DQueueTestFixture, TestDeleteItem)
     free(payload);
     free(queue_node);
 }
+
+/*
+ * Item with an embedded link for the intrusive queue
+ */
+typedef struct
+{
+    int value;
+    ilist_link_t link;
+} queue_item_t;
+
+queue_status_t compare_items(void * data1, void * data2)
+{
+    return compare_payloads(&((queue_item_t *)data1)->value,
+                            &((queue_item_t *)data2)->value);
+}
+
+TEST(QueueIntrusiveTest, EnqueueDequeueWithoutAllocation)
+{
+    const int length = 10;
+    queue_item_t items[length];
+    queue_t * queue = queue_init_intrusive(length,
+                                           offsetof(queue_item_t, link),
+                                           compare_items);
+    ASSERT_NE(queue, nullptr);
+    for (int i = 0; i < length; i++)
+    {
+        items[i].value = i;
+        EXPECT_EQ(queue_enqueue(queue, &items[i]), Q_SUCCESS);
+    }
+    queue_item_t extra = {length, {}};
+    EXPECT_EQ(queue_enqueue(queue, &extra), Q_FAILURE);
+
+    EXPECT_EQ(queue_get_by_index(queue, 4), (queue_t *)&items[4]);
+    queue_item_t target = {7, {}};
+    EXPECT_EQ(queue_get_by_value(queue, &target), (queue_t *)&items[7]);
+    EXPECT_EQ(queue_remove(queue, &target), &items[7]);
+    EXPECT_EQ(queue_get_by_value(queue, &target), nullptr);
+
+    // Items can be taken out of the middle without a search
+    queue_unlink(queue, &items[3]);
+    EXPECT_EQ(queue_length(queue), length - 2);
+
+    EXPECT_EQ(queue_dequeue(queue), &items[0]);
+    queue_enqueue(queue, &items[0]);
+    for (int i : {1, 2, 4, 5, 6, 8, 9, 0})
+    {
+        EXPECT_EQ(queue_dequeue(queue), &items[i]);
+    }
+    EXPECT_TRUE(queue_is_empty(queue));
+    EXPECT_EQ(queue_dequeue(queue), nullptr);
+    queue_destroy(queue);
+}
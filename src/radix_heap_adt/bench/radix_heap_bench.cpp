@@ -0,0 +1,177 @@
+/*
+ * Compares the radix heap against heap_t on the traces of Dijkstra searches
+ * over random graphs. Both heaps use lazy deletion, a node is inserted again
+ * when its distance improves and stale entries are skipped when popped.
+ *
+ * Usage: radix_heap_bench [node_count] [edges_per_node]
+ */
+#include <radix_heap.h>
+#include <heap.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+typedef struct
+{
+    uint64_t distance;
+    uint32_t node;
+} entry_t;
+
+typedef struct
+{
+    uint32_t target;
+    uint32_t weight;
+} edge_t;
+
+typedef struct
+{
+    std::vector<uint32_t> offsets;
+    std::vector<edge_t> edges;
+} graph_t;
+
+static heap_compare_t entry_compare(void * payload, void * payload2)
+{
+    uint64_t left = ((entry_t *)payload)->distance;
+    uint64_t right = ((entry_t *)payload2)->distance;
+    if (left > right)
+    {
+        return HEAP_GT;
+    }
+    else if (left < right)
+    {
+        return HEAP_LT;
+    }
+    return HEAP_EQ;
+}
+
+static graph_t create_graph(uint32_t node_count, uint32_t degree,
+                            uint32_t max_weight, unsigned seed)
+{
+    std::mt19937 engine(seed);
+    graph_t graph;
+    graph.offsets.resize(node_count + 1);
+    for (uint32_t node = 0; node < node_count; node++)
+    {
+        graph.offsets[node] = node * degree;
+        for (uint32_t i = 0; i < degree; i++)
+        {
+            graph.edges.push_back({(uint32_t)(engine() % node_count),
+                                   (uint32_t)(engine() % max_weight) + 1});
+        }
+    }
+    graph.offsets[node_count] = node_count * degree;
+    return graph;
+}
+
+static uint64_t dijkstra_heap(const graph_t & graph, heap_arity_t arity)
+{
+    std::vector<uint64_t> distance(graph.offsets.size() - 1, UINT64_MAX);
+    heap_t * heap = heap_init(MIN_HEAP, HEAP_MEM, sizeof(entry_t), NULL,
+                              entry_compare, arity);
+    entry_t entry = {0, 0};
+    distance[0] = 0;
+    heap_insert(heap, &entry);
+    uint64_t total = 0;
+    while (HEAP_SUCCESS == heap_pop_into(heap, &entry))
+    {
+        if (entry.distance != distance[entry.node])
+        {
+            continue;
+        }
+        total += entry.distance;
+        for (uint32_t i = graph.offsets[entry.node];
+             i < graph.offsets[entry.node + 1]; i++)
+        {
+            const edge_t & edge = graph.edges[i];
+            uint64_t candidate = entry.distance + edge.weight;
+            if (candidate < distance[edge.target])
+            {
+                distance[edge.target] = candidate;
+                entry_t next = {candidate, edge.target};
+                heap_insert(heap, &next);
+            }
+        }
+    }
+    heap_destroy(heap);
+    return total;
+}
+
+static uint64_t dijkstra_radix(const graph_t & graph, rheap_key_width_t width)
+{
+    std::vector<uint64_t> distance(graph.offsets.size() - 1, UINT64_MAX);
+    rheap_t * heap = rheap_init(width, HEAP_MEM, sizeof(uint32_t), NULL);
+    uint32_t node = 0;
+    uint64_t key = 0;
+    distance[0] = 0;
+    rheap_insert(heap, 0, &node);
+    uint64_t total = 0;
+    while (HEAP_SUCCESS == rheap_pop_into(heap, &key, &node))
+    {
+        if (key != distance[node])
+        {
+            continue;
+        }
+        total += key;
+        for (uint32_t i = graph.offsets[node]; i < graph.offsets[node + 1];
+             i++)
+        {
+            const edge_t & edge = graph.edges[i];
+            uint64_t candidate = key + edge.weight;
+            if (candidate < distance[edge.target])
+            {
+                distance[edge.target] = candidate;
+                rheap_insert(heap, candidate, (void *)&edge.target);
+            }
+        }
+    }
+    rheap_destroy(heap);
+    return total;
+}
+
+template <typename Func>
+static void report(const char * name, Func func)
+{
+    auto start = std::chrono::steady_clock::now();
+    uint64_t total = func();
+    auto stop = std::chrono::steady_clock::now();
+    printf("  %-20s %10.2f ms  (checksum %llu)\n", name,
+           std::chrono::duration<double, std::milli>(stop - start).count(),
+           (unsigned long long)total);
+}
+
+int main(int argc, char ** argv)
+{
+    uint32_t node_count = 500000;
+    uint32_t degree = 8;
+    if (argc > 1)
+    {
+        node_count = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2)
+    {
+        degree = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+
+    for (uint32_t max_weight : {100u, 100000u})
+    {
+        graph_t graph = create_graph(node_count, degree, max_weight, 5);
+        printf("%u nodes, %u edges per node, weights 1..%u\n",
+               node_count, degree, max_weight);
+        report("heap_t binary", [&]() {
+            return dijkstra_heap(graph, HEAP_BINARY);
+        });
+        report("heap_t 4-ary", [&]() {
+            return dijkstra_heap(graph, HEAP_4_ARY);
+        });
+        report("rheap 32 bit keys", [&]() {
+            return dijkstra_radix(graph, RHEAP_KEY_32);
+        });
+        report("rheap 64 bit keys", [&]() {
+            return dijkstra_radix(graph, RHEAP_KEY_64);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef RADIX_HEAP_H
+#define RADIX_HEAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <heap.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Min heap for unsigned integer keys that never go below the last popped
+ * key, as in event simulations and shortest path searches. The data modes
+ * and result codes are shared with heap.h.
+ */
+typedef enum
+{
+    RHEAP_KEY_32 = 32,
+    RHEAP_KEY_64 = 64
+} rheap_key_width_t;
+
+typedef struct rheap_t rheap_t;
+
+rheap_t * rheap_init(rheap_key_width_t key_width,
+                     heap_data_mode_t data_mode,
+                     size_t payload_size,
+                     void (* destroy)(void *));
+void rheap_destroy(rheap_t * heap);
+heap_result_t rheap_insert(rheap_t * heap, uint64_t key, void * payload);
+void * rheap_pop(rheap_t * heap, uint64_t * key);
+heap_result_t rheap_pop_into(rheap_t * heap, uint64_t * key, void * out);
+heap_result_t rheap_peek_key(rheap_t * heap, uint64_t * key);
+void rheap_dump(rheap_t * heap);
+size_t rheap_length(rheap_t * heap);
+bool rheap_is_empty(rheap_t * heap);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+#endif //RADIX_HEAP_H
@@ -0,0 +1,543 @@
+#include <radix_heap.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+typedef enum
+{
+    BUCKET_BASE_SIZE = 8,
+    MAX_BUCKETS = 65,               // One per bit of a 64 bit key plus one
+} rheap_default_t;
+
+// Enum for determining if malloc calls were valid
+typedef enum
+{
+    VALID_PTR = 1,
+    INVALID_PTR = 0
+} rheap_pointer_t;
+
+// Unsorted array of entries. Each entry is the key followed by the payload
+// in HEAP_MEM mode or by the pointer in HEAP_PTR mode.
+typedef struct rheap_bucket_t
+{
+    uint8_t * entries;
+    size_t length;                  // Number of entries in the bucket
+    size_t size;                    // Number of entries that fit
+} rheap_bucket_t;
+
+typedef struct rheap_t
+{
+    size_t length;                  // Number of entries in all the buckets
+    size_t payload_size;            // Size of the payload passed in
+    size_t entry_size;              // Size of the key and payload
+    size_t bucket_count;            // Key width plus one
+    uint64_t max_key;
+    uint64_t last_key;              // Last popped key, keys may not go lower
+    heap_data_mode_t data_mode;
+    void (* destroy)(void * payload);
+    rheap_bucket_t buckets[MAX_BUCKETS];
+} rheap_t;
+
+static heap_result_t refill_first_bucket(rheap_t * heap);
+static size_t get_first_filled_bucket(rheap_t * heap);
+static uint64_t get_min_key(rheap_t * heap, rheap_bucket_t * bucket);
+static heap_result_t reserve_entries(rheap_bucket_t * bucket,
+                                     size_t entry_count,
+                                     size_t entry_size);
+static void take_entry(rheap_t * heap, uint64_t * key, void * out);
+
+static size_t get_bucket_index(rheap_t * heap, uint64_t key);
+static size_t get_highest_bit(uint64_t value);
+static size_t get_slot_size(rheap_t * heap);
+static uint8_t * get_entry(rheap_t * heap,
+                           rheap_bucket_t * bucket,
+                           size_t index);
+static uint64_t get_entry_key(uint8_t * entry);
+static rheap_pointer_t verify_alloc(void * ptr);
+
+
+
+/*!
+ * @brief Create the radix heap
+ *
+ * The radix heap is a min heap for integer keys where an inserted key is
+ * never lower than the last popped key. Keys are placed in buckets by the
+ * highest bit where they differ from the last popped key, so inserting is
+ * O(1) and every key moves down at most one bucket per bit, which makes
+ * popping O(log C) amortized where C is the key range. No comparison
+ * callback is used.
+ * @param key_width RHEAP_KEY_32 or RHEAP_KEY_64, the largest key allowed
+ * @param data_mode Data storage strategy
+ * @param payload_size The size of the payload. This can be 0 if using HEAP_PTR
+ * or if the keys are the only data
+ * @param destroy Pointer to function that frees the payloads in HEAP_PTR mode
+ * @return Pointer to rheap_t or NULL
+ */
+rheap_t * rheap_init(rheap_key_width_t key_width,
+                     heap_data_mode_t data_mode,
+                     size_t payload_size,
+                     void (* destroy)(void *))
+{
+    assert((RHEAP_KEY_32 == key_width) || (RHEAP_KEY_64 == key_width));
+    rheap_t * heap = (rheap_t *)calloc(1, sizeof(rheap_t));
+    if (INVALID_PTR == verify_alloc((void *)heap))
+    {
+        return NULL;
+    }
+
+    heap->length = 0;
+    heap->payload_size = payload_size;
+    heap->data_mode = data_mode;
+    heap->destroy = destroy;
+    heap->bucket_count = (size_t)key_width + 1;
+    heap->max_key = (RHEAP_KEY_32 == key_width) ? UINT32_MAX : UINT64_MAX;
+    heap->last_key = 0;
+
+    // Keep the keys aligned when the entries are next to each other
+    size_t entry_size = sizeof(uint64_t) + get_slot_size(heap);
+    heap->entry_size = ((entry_size + sizeof(uint64_t) - 1) / sizeof(uint64_t))
+                       * sizeof(uint64_t);
+    return heap;
+}
+
+/*!
+ * @brief Destroy the heap and the payloads left in HEAP_PTR mode
+ * @param heap
+ */
+void rheap_destroy(rheap_t * heap)
+{
+    assert(heap);
+    rheap_dump(heap);
+    for (size_t i = 0; i < heap->bucket_count; i++)
+    {
+        free(heap->buckets[i].entries);
+    }
+    free(heap);
+}
+
+/*!
+ * @brief Insert the payload with the key in O(1)
+ * @param heap
+ * @param key Priority of the payload, lowest is popped first
+ * @param payload Pointer to the payload. In HEAP_MEM mode the payload is
+ * copied into the heap.
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the key is lower than the last
+ * popped key, larger than the key width or the bucket could not grow
+ */
+heap_result_t rheap_insert(rheap_t * heap, uint64_t key, void * payload)
+{
+    assert(heap);
+    if ((key < heap->last_key) || (key > heap->max_key))
+    {
+        return HEAP_FAILURE;
+    }
+
+    rheap_bucket_t * bucket = &heap->buckets[get_bucket_index(heap, key)];
+    if (HEAP_SUCCESS != reserve_entries(bucket, 1, heap->entry_size))
+    {
+        return HEAP_FAILURE;
+    }
+
+    uint8_t * entry = get_entry(heap, bucket, bucket->length);
+    memcpy(entry, &key, sizeof(uint64_t));
+    if (HEAP_PTR == heap->data_mode)
+    {
+        memcpy(entry + sizeof(uint64_t), &payload, sizeof(void *));
+    }
+    else if (0 != heap->payload_size)
+    {
+        memcpy(entry + sizeof(uint64_t), payload, heap->payload_size);
+    }
+    bucket->length++;
+    heap->length++;
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Remove the entry with the lowest key and return its payload
+ *
+ * In HEAP_PTR mode the stored pointer is returned. In HEAP_MEM mode a copy
+ * of the payload is allocated which the caller must free.
+ * @param heap
+ * @param key Set to the key of the entry if not NULL
+ * @return Pointer to the payload or NULL if the heap is empty
+ */
+void * rheap_pop(rheap_t * heap, uint64_t * key)
+{
+    assert(heap);
+    assert((HEAP_PTR == heap->data_mode) || (0 != heap->payload_size));
+    if (HEAP_SUCCESS != refill_first_bucket(heap))
+    {
+        return NULL;
+    }
+
+    void * payload = NULL;
+    if (HEAP_PTR == heap->data_mode)
+    {
+        take_entry(heap, key, &payload);
+        return payload;
+    }
+
+    payload = malloc(heap->payload_size);
+    if (INVALID_PTR == verify_alloc(payload))
+    {
+        return NULL;
+    }
+    take_entry(heap, key, payload);
+    return payload;
+}
+
+/*!
+ * @brief Remove the entry with the lowest key and copy its payload into the
+ * memory passed in. No memory is allocated.
+ * @param heap
+ * @param key Set to the key of the entry if not NULL
+ * @param out Memory of the payload size in HEAP_MEM mode or a pointer to a
+ * void pointer in HEAP_PTR mode. If NULL the payload is discarded and freed
+ * with the destroy callback in HEAP_PTR mode.
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the heap is empty
+ */
+heap_result_t rheap_pop_into(rheap_t * heap, uint64_t * key, void * out)
+{
+    assert(heap);
+    if (HEAP_SUCCESS != refill_first_bucket(heap))
+    {
+        return HEAP_FAILURE;
+    }
+
+    if ((NULL == out) && (HEAP_PTR == heap->data_mode))
+    {
+        void * payload = NULL;
+        take_entry(heap, key, &payload);
+        if (NULL != heap->destroy)
+        {
+            heap->destroy(payload);
+        }
+        return HEAP_SUCCESS;
+    }
+    take_entry(heap, key, out);
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Read the lowest key without removing its entry
+ *
+ * The entries are not moved, so peeking does not change the lowest key that
+ * can be inserted. If the first bucket is empty the lowest key is found by
+ * scanning the first bucket that is not.
+ * @param heap
+ * @param key Set to the lowest key
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the heap is empty
+ */
+heap_result_t rheap_peek_key(rheap_t * heap, uint64_t * key)
+{
+    assert(heap);
+    assert(key);
+    if (0 == heap->length)
+    {
+        return HEAP_FAILURE;
+    }
+    if (0 != heap->buckets[0].length)
+    {
+        * key = heap->last_key;
+        return HEAP_SUCCESS;
+    }
+    * key = get_min_key(heap, &heap->buckets[get_first_filled_bucket(heap)]);
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Remove every entry of the heap. In HEAP_PTR mode the payloads are
+ * freed with the destroy callback. The buckets keep their memory and the
+ * keys may start from 0 again.
+ * @param heap
+ */
+void rheap_dump(rheap_t * heap)
+{
+    assert(heap);
+    for (size_t i = 0; i < heap->bucket_count; i++)
+    {
+        rheap_bucket_t * bucket = &heap->buckets[i];
+        if ((HEAP_PTR == heap->data_mode) && (NULL != heap->destroy))
+        {
+            for (size_t j = 0; j < bucket->length; j++)
+            {
+                void * payload = NULL;
+                memcpy(&payload,
+                       get_entry(heap, bucket, j) + sizeof(uint64_t),
+                       sizeof(void *));
+                heap->destroy(payload);
+            }
+        }
+        bucket->length = 0;
+    }
+    heap->length = 0;
+    heap->last_key = 0;
+}
+
+/*!
+ * @brief Return the number of entries in the heap
+ * @param heap
+ * @return Number of entries
+ */
+size_t rheap_length(rheap_t * heap)
+{
+    assert(heap);
+    return heap->length;
+}
+
+/*!
+ * @brief Check if the heap is empty
+ * @param heap
+ * @return True if empty
+ */
+bool rheap_is_empty(rheap_t * heap)
+{
+    assert(heap);
+    return 0 == heap->length;
+}
+
+/*!
+ * @brief Make sure the first bucket holds the lowest key
+ *
+ * The first bucket holds the entries equal to the last popped key. Once it
+ * is empty, the lowest key of the first bucket that is not empty becomes the
+ * last popped key and the entries of that bucket are spread over the lower
+ * buckets. Every entry lands in a lower bucket than before, which bounds the
+ * number of moves of an entry by the key width.
+ * @param heap
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the heap is empty or the buckets
+ * could not grow
+ */
+static heap_result_t refill_first_bucket(rheap_t * heap)
+{
+    if (0 != heap->buckets[0].length)
+    {
+        return HEAP_SUCCESS;
+    }
+    if (0 == heap->length)
+    {
+        return HEAP_FAILURE;
+    }
+
+    size_t source_index = get_first_filled_bucket(heap);
+    rheap_bucket_t * source = &heap->buckets[source_index];
+    uint64_t min_key = get_min_key(heap, source);
+
+    // Count the entries of every target bucket first so that all the
+    // buckets can grow before anything is moved
+    size_t counts[MAX_BUCKETS] = {0};
+    uint64_t previous_key = heap->last_key;
+    heap->last_key = min_key;
+    for (size_t i = 0; i < source->length; i++)
+    {
+        uint64_t key = get_entry_key(get_entry(heap, source, i));
+        counts[get_bucket_index(heap, key)]++;
+    }
+    for (size_t i = 0; i < source_index; i++)
+    {
+        if ((0 != counts[i])
+            && (HEAP_SUCCESS != reserve_entries(&heap->buckets[i],
+                                                counts[i],
+                                                heap->entry_size)))
+        {
+            heap->last_key = previous_key;
+            return HEAP_FAILURE;
+        }
+    }
+
+    for (size_t i = 0; i < source->length; i++)
+    {
+        uint8_t * entry = get_entry(heap, source, i);
+        rheap_bucket_t * target =
+            &heap->buckets[get_bucket_index(heap, get_entry_key(entry))];
+        memcpy(get_entry(heap, target, target->length),
+               entry,
+               heap->entry_size);
+        target->length++;
+    }
+    source->length = 0;
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Return the index of the first bucket holding entries
+ * @param heap Heap that is not empty
+ * @return Index of the bucket
+ */
+static size_t get_first_filled_bucket(rheap_t * heap)
+{
+    size_t index = 0;
+    while (0 == heap->buckets[index].length)
+    {
+        index++;
+    }
+    return index;
+}
+
+/*!
+ * @brief Return the lowest key of the entries in the bucket
+ * @param heap
+ * @param bucket Bucket holding entries
+ * @return Lowest key
+ */
+static uint64_t get_min_key(rheap_t * heap, rheap_bucket_t * bucket)
+{
+    uint64_t min_key = UINT64_MAX;
+    for (size_t i = 0; i < bucket->length; i++)
+    {
+        uint64_t key = get_entry_key(get_entry(heap, bucket, i));
+        if (key < min_key)
+        {
+            min_key = key;
+        }
+    }
+    return min_key;
+}
+
+/*!
+ * @brief Grow the bucket so that entry_count more entries fit. The bucket
+ * doubles in size and never shrinks, so a heap in a steady state stops
+ * allocating.
+ * @param bucket
+ * @param entry_count
+ * @param entry_size
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the allocation failed
+ */
+static heap_result_t reserve_entries(rheap_bucket_t * bucket,
+                                     size_t entry_count,
+                                     size_t entry_size)
+{
+    size_t required = bucket->length + entry_count;
+    if (required <= bucket->size)
+    {
+        return HEAP_SUCCESS;
+    }
+
+    size_t size = (0 == bucket->size) ? BUCKET_BASE_SIZE : bucket->size;
+    while (size < required)
+    {
+        size = size * 2;
+    }
+    uint8_t * entries = (uint8_t *)realloc(bucket->entries, size * entry_size);
+    if (INVALID_PTR == verify_alloc((void *)entries))
+    {
+        return HEAP_FAILURE;
+    }
+    bucket->entries = entries;
+    bucket->size = size;
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Remove the last entry of the first bucket. Every entry of the first
+ * bucket has the lowest key, so any of them can be taken.
+ * @param heap
+ * @param key Set to the key of the entry if not NULL
+ * @param out Set to the payload if not NULL
+ */
+static void take_entry(rheap_t * heap, uint64_t * key, void * out)
+{
+    rheap_bucket_t * bucket = &heap->buckets[0];
+    bucket->length--;
+    heap->length--;
+
+    uint8_t * entry = get_entry(heap, bucket, bucket->length);
+    if (NULL != key)
+    {
+        * key = get_entry_key(entry);
+    }
+    if ((NULL != out) && (0 != get_slot_size(heap)))
+    {
+        memcpy(out, entry + sizeof(uint64_t), get_slot_size(heap));
+    }
+}
+
+/*!
+ * @brief Return the bucket of the key. Keys equal to the last popped key go
+ * in the first bucket, the others in the bucket of the highest bit where
+ * they differ from it.
+ * @param heap
+ * @param key
+ * @return Index of the bucket
+ */
+static size_t get_bucket_index(rheap_t * heap, uint64_t key)
+{
+    if (key == heap->last_key)
+    {
+        return 0;
+    }
+    return get_highest_bit(key ^ heap->last_key) + 1;
+}
+
+/*!
+ * @brief Return the index of the highest set bit
+ * @param value Value that is not 0
+ * @return Index of the bit, 0 for the lowest bit
+ */
+static size_t get_highest_bit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return (size_t)(63 - __builtin_clzll(value));
+#else
+    size_t bit = 0;
+    while (value >>= 1)
+    {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/*!
+ * @brief Return the size of the payload stored in each entry. This is the
+ * size of a pointer in HEAP_PTR mode and the size of the payload in HEAP_MEM
+ * mode
+ * @param heap
+ * @return Size of the payload slot in bytes
+ */
+static size_t get_slot_size(rheap_t * heap)
+{
+    return (HEAP_PTR == heap->data_mode) ? sizeof(void *) : heap->payload_size;
+}
+
+/*!
+ * @brief Return the entry at the index of the bucket
+ * @param heap
+ * @param bucket
+ * @param index
+ * @return Pointer to the entry
+ */
+static uint8_t * get_entry(rheap_t * heap,
+                           rheap_bucket_t * bucket,
+                           size_t index)
+{
+    return bucket->entries + (index * heap->entry_size);
+}
+
+/*!
+ * @brief Read the key at the start of the entry
+ * @param entry
+ * @return Key of the entry
+ */
+static uint64_t get_entry_key(uint8_t * entry)
+{
+    uint64_t key = 0;
+    memcpy(&key, entry, sizeof(uint64_t));
+    return key;
+}
+
+/*!
+ * @brief Verify that the allocation was successful
+ * @param ptr Any allocated pointer
+ */
+static rheap_pointer_t verify_alloc(void * ptr)
+{
+    if (NULL == ptr)
+    {
+        fprintf(stderr, "[!] Could not allocate memory!\n");
+        return INVALID_PTR;
+    }
+    return VALID_PTR;
+}
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include <radix_heap.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+void rheap_payload_destroy(void * payload)
+{
+    free(payload);
+}
+
+TEST(RadixHeap, PopOrderWithDuplicates)
+{
+    rheap_t * heap = rheap_init(RHEAP_KEY_32, HEAP_MEM, sizeof(int), NULL);
+    std::mt19937 engine(1);
+    std::vector<uint64_t> keys;
+    for (int i = 0; i < 2000; i++)
+    {
+        uint64_t key = engine() % 500;
+        keys.push_back(key);
+        int payload = (int)key;
+        ASSERT_EQ(rheap_insert(heap, key, &payload), HEAP_SUCCESS);
+    }
+    EXPECT_EQ(rheap_length(heap), keys.size());
+
+    std::sort(keys.begin(), keys.end());
+    uint64_t key = 0;
+    int payload = 0;
+    for (uint64_t expected : keys)
+    {
+        ASSERT_EQ(rheap_pop_into(heap, &key, &payload), HEAP_SUCCESS);
+        EXPECT_EQ(key, expected);
+        EXPECT_EQ((uint64_t)payload, expected);
+    }
+    EXPECT_TRUE(rheap_is_empty(heap));
+    EXPECT_EQ(rheap_pop_into(heap, &key, &payload), HEAP_FAILURE);
+    EXPECT_EQ(rheap_peek_key(heap, &key), HEAP_FAILURE);
+    rheap_destroy(heap);
+}
+
+TEST(RadixHeap, RejectsKeysOutOfRange)
+{
+    rheap_t * heap = rheap_init(RHEAP_KEY_32, HEAP_MEM, 0, NULL);
+    EXPECT_EQ(rheap_insert(heap, (uint64_t)UINT32_MAX + 1, NULL),
+              HEAP_FAILURE);
+    EXPECT_EQ(rheap_insert(heap, UINT32_MAX, NULL), HEAP_SUCCESS);
+    EXPECT_EQ(rheap_insert(heap, 10, NULL), HEAP_SUCCESS);
+
+    uint64_t key = 0;
+    EXPECT_EQ(rheap_pop_into(heap, &key, NULL), HEAP_SUCCESS);
+    EXPECT_EQ(key, 10);
+
+    // Keys lower than the last popped key break the monotone order
+    EXPECT_EQ(rheap_insert(heap, 9, NULL), HEAP_FAILURE);
+    EXPECT_EQ(rheap_insert(heap, 10, NULL), HEAP_SUCCESS);
+    EXPECT_EQ(rheap_peek_key(heap, &key), HEAP_SUCCESS);
+    EXPECT_EQ(key, 10);
+
+    rheap_dump(heap);
+    EXPECT_TRUE(rheap_is_empty(heap));
+    EXPECT_EQ(rheap_insert(heap, 0, NULL), HEAP_SUCCESS);
+    rheap_destroy(heap);
+}
+
+TEST(RadixHeap, PeekDoesNotRaiseTheInsertFloor)
+{
+    rheap_t * heap = rheap_init(RHEAP_KEY_32, HEAP_MEM, 0, NULL);
+    EXPECT_EQ(rheap_insert(heap, 5, NULL), HEAP_SUCCESS);
+    EXPECT_EQ(rheap_insert(heap, 100, NULL), HEAP_SUCCESS);
+
+    uint64_t key = 0;
+    EXPECT_EQ(rheap_pop_into(heap, &key, NULL), HEAP_SUCCESS);
+    EXPECT_EQ(key, 5);
+    EXPECT_EQ(rheap_peek_key(heap, &key), HEAP_SUCCESS);
+    EXPECT_EQ(key, 100);
+
+    // Keys between the last popped key and the peeked key are still allowed
+    EXPECT_EQ(rheap_insert(heap, 50, NULL), HEAP_SUCCESS);
+    EXPECT_EQ(rheap_peek_key(heap, &key), HEAP_SUCCESS);
+    EXPECT_EQ(key, 50);
+    EXPECT_EQ(rheap_pop_into(heap, &key, NULL), HEAP_SUCCESS);
+    EXPECT_EQ(key, 50);
+    EXPECT_EQ(rheap_pop_into(heap, &key, NULL), HEAP_SUCCESS);
+    EXPECT_EQ(key, 100);
+    rheap_destroy(heap);
+}
+
+TEST(RadixHeap, MonotoneMatchesPriorityQueue)
+{
+    rheap_t * heap = rheap_init(RHEAP_KEY_64, HEAP_MEM, sizeof(uint64_t),
+                                NULL);
+    std::priority_queue<uint64_t, std::vector<uint64_t>,
+                        std::greater<uint64_t>> expected;
+    std::mt19937_64 engine(2);
+    uint64_t last = 0;
+    for (int i = 0; i < 50000; i++)
+    {
+        if ((expected.empty()) || (engine() % 2 == 0))
+        {
+            // Spread the keys over the whole 64 bit range above the last
+            uint64_t key = last + (engine() >> (engine() % 64));
+            if (key < last)
+            {
+                key = UINT64_MAX;
+            }
+            ASSERT_EQ(rheap_insert(heap, key, &key), HEAP_SUCCESS);
+            expected.push(key);
+        }
+        else
+        {
+            uint64_t key = 0;
+            uint64_t payload = 0;
+            ASSERT_EQ(rheap_pop_into(heap, &key, &payload), HEAP_SUCCESS);
+            ASSERT_EQ(key, expected.top());
+            ASSERT_EQ(payload, key);
+            expected.pop();
+            last = key;
+        }
+    }
+    rheap_destroy(heap);
+}
+
+TEST(RadixHeap, PtrMode)
+{
+    rheap_t * heap = rheap_init(RHEAP_KEY_64, HEAP_PTR, 0,
+                                rheap_payload_destroy);
+    for (int i = 100; i > 0; i--)
+    {
+        int * payload = (int *)malloc(sizeof(int));
+        * payload = i;
+        rheap_insert(heap, (uint64_t)i, payload);
+    }
+
+    uint64_t key = 0;
+    int * payload = (int *)rheap_pop(heap, &key);
+    EXPECT_EQ(key, 1);
+    EXPECT_EQ(* payload, 1);
+    free(payload);
+
+    // Discarding frees the payload with the destroy callback
+    EXPECT_EQ(rheap_pop_into(heap, &key, NULL), HEAP_SUCCESS);
+    EXPECT_EQ(key, 2);
+    rheap_destroy(heap);
+}
+
+TEST(RadixHeap, DijkstraMatchesPriorityQueue)
+{
+    const uint32_t node_count = 2000;
+    std::mt19937 engine(3);
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> edges(node_count);
+    for (uint32_t node = 0; node < node_count; node++)
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            edges[node].push_back({(uint32_t)(engine() % node_count),
+                                   (uint32_t)(engine() % 1000) + 1});
+        }
+    }
+
+    std::vector<uint64_t> expected(node_count, UINT64_MAX);
+    std::priority_queue<std::pair<uint64_t, uint32_t>,
+                        std::vector<std::pair<uint64_t, uint32_t>>,
+                        std::greater<std::pair<uint64_t, uint32_t>>> queue;
+    expected[0] = 0;
+    queue.push({0, 0});
+    while (!queue.empty())
+    {
+        std::pair<uint64_t, uint32_t> top = queue.top();
+        queue.pop();
+        if (top.first != expected[top.second])
+        {
+            continue;
+        }
+        for (std::pair<uint32_t, uint32_t> & edge : edges[top.second])
+        {
+            if (top.first + edge.second < expected[edge.first])
+            {
+                expected[edge.first] = top.first + edge.second;
+                queue.push({expected[edge.first], edge.first});
+            }
+        }
+    }
+
+    std::vector<uint64_t> distance(node_count, UINT64_MAX);
+    rheap_t * heap = rheap_init(RHEAP_KEY_64, HEAP_MEM, sizeof(uint32_t),
+                                NULL);
+    uint32_t node = 0;
+    uint64_t key = 0;
+    distance[0] = 0;
+    rheap_insert(heap, 0, &node);
+    while (HEAP_SUCCESS == rheap_pop_into(heap, &key, &node))
+    {
+        if (key != distance[node])
+        {
+            continue;
+        }
+        for (std::pair<uint32_t, uint32_t> & edge : edges[node])
+        {
+            if (key + edge.second < distance[edge.first])
+            {
+                distance[edge.first] = key + edge.second;
+                ASSERT_EQ(rheap_insert(heap, distance[edge.first],
+                                       &edge.first), HEAP_SUCCESS);
+            }
+        }
+    }
+    EXPECT_EQ(distance, expected);
+    rheap_destroy(heap);
+}
@@ -0,0 +1,163 @@
+/*
+ * Compares the timing wheel against an indexed heap_t used as a timer queue.
+ * Each round schedules timers with random timeouts, cancels nine out of ten
+ * of them and moves the clock forward, the pattern of request timeouts that
+ * are mostly cancelled before they fire.
+ *
+ * Usage: timer_wheel_bench [timers_per_round] [round_count]
+ */
+#include <timer_wheel.h>
+#include <heap.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+typedef struct
+{
+    uint64_t deadline;
+    uint32_t id;
+} timeout_entry_t;
+
+/*
+ * Sum of the expired ids, printed so the compiler can not drop the work
+ */
+static uint64_t checksum = 0;
+
+static heap_compare_t entry_compare(void * payload, void * payload2)
+{
+    uint64_t left = ((timeout_entry_t *)payload)->deadline;
+    uint64_t right = ((timeout_entry_t *)payload2)->deadline;
+    if (left > right)
+    {
+        return HEAP_GT;
+    }
+    else if (left < right)
+    {
+        return HEAP_LT;
+    }
+    return HEAP_EQ;
+}
+
+template <typename Func>
+static double time_ns(Func func)
+{
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+static void bench_heap(const std::vector<uint64_t> & timeouts,
+                       size_t per_round)
+{
+    heap_t * heap = heap_init_indexed(MIN_HEAP, HEAP_MEM,
+                                      sizeof(timeout_entry_t), NULL,
+                                      entry_compare, HEAP_4_ARY);
+    std::vector<heap_handle_t> handles(per_round);
+    uint64_t now = 0;
+
+    double elapsed = time_ns([&]() {
+        for (size_t start = 0; start < timeouts.size(); start += per_round)
+        {
+            for (size_t i = 0; i < per_round; i++)
+            {
+                timeout_entry_t entry = {now + timeouts[start + i],
+                                       (uint32_t)i};
+                handles[i] = heap_insert_handle(heap, &entry);
+            }
+            for (size_t i = 0; i < per_round; i++)
+            {
+                if (0 != i % 10)
+                {
+                    heap_remove(heap, handles[i], NULL);
+                }
+            }
+
+            now += 1000;
+            timeout_entry_t * first = (timeout_entry_t *)heap_peek_ref(heap);
+            while ((NULL != first) && (first->deadline <= now))
+            {
+                checksum += first->id;
+                heap_pop_into(heap, first);
+                first = (timeout_entry_t *)heap_peek_ref(heap);
+            }
+        }
+    });
+    heap_destroy(heap);
+    printf("%-24s %8.2f ns/timer\n", "heap_t indexed",
+           elapsed / (double)timeouts.size());
+}
+
+static void bench_wheel(const std::vector<uint64_t> & timeouts,
+                        size_t per_round)
+{
+    twheel_t * wheel = twheel_init(0, NULL);
+    std::vector<twheel_handle_t> handles(per_round);
+    std::vector<twheel_expired_t> expired(256);
+    uint64_t now = 0;
+
+    double elapsed = time_ns([&]() {
+        for (size_t start = 0; start < timeouts.size(); start += per_round)
+        {
+            for (size_t i = 0; i < per_round; i++)
+            {
+                handles[i] = twheel_schedule(wheel, now + timeouts[start + i],
+                                             (void *)(uintptr_t)i);
+            }
+            for (size_t i = 0; i < per_round; i++)
+            {
+                if (0 != i % 10)
+                {
+                    twheel_cancel(wheel, handles[i], NULL);
+                }
+            }
+
+            now += 1000;
+            size_t count = 0;
+            do
+            {
+                count = twheel_advance(wheel, now, expired.data(),
+                                       expired.size());
+                for (size_t i = 0; i < count; i++)
+                {
+                    checksum += (uintptr_t)expired[i].payload;
+                }
+            } while (count == expired.size());
+        }
+    });
+    twheel_destroy(wheel);
+    printf("%-24s %8.2f ns/timer\n", "timer wheel",
+           elapsed / (double)timeouts.size());
+}
+
+int main(int argc, char ** argv)
+{
+    size_t per_round = 100000;
+    size_t round_count = 20;
+    if (argc > 1)
+    {
+        per_round = strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2)
+    {
+        round_count = strtoul(argv[2], NULL, 10);
+    }
+
+    std::mt19937_64 engine(99);
+    std::uniform_int_distribution<uint64_t> distribution(1, 30000);
+    std::vector<uint64_t> timeouts(per_round * round_count);
+    for (uint64_t & timeout : timeouts)
+    {
+        timeout = distribution(engine);
+    }
+
+    printf("%zu rounds of %zu timers, 90%% cancelled\n", round_count,
+           per_round);
+    bench_heap(timeouts, per_round);
+    bench_wheel(timeouts, per_round);
+    printf("checksum %llu\n", (unsigned long long)checksum);
+    return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <heap.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Hierarchical timing wheel for timeouts counted in ticks. Scheduling and
+ * cancelling are O(1) and deadlines beyond the reach of the wheel are kept in
+ * a heap_t until they come within reach. The result codes are shared with
+ * heap.h.
+ */
+
+// Reference to a scheduled timer. Handles of timers that expired or were
+// cancelled are never confused with the timers scheduled after them.
+typedef uint64_t twheel_handle_t;
+#define TWHEEL_INVALID_HANDLE UINT64_MAX
+
+// Timer handed back by twheel_advance, the payload belongs to the caller
+typedef struct
+{
+    uint64_t deadline;
+    void * payload;
+} twheel_expired_t;
+
+typedef struct twheel_t twheel_t;
+
+twheel_t * twheel_init(uint64_t start_tick, void (* destroy)(void *));
+void twheel_destroy(twheel_t * wheel);
+twheel_handle_t twheel_schedule(twheel_t * wheel,
+                                uint64_t deadline,
+                                void * payload);
+heap_result_t twheel_cancel(twheel_t * wheel,
+                            twheel_handle_t handle,
+                            void ** out);
+bool twheel_is_scheduled(twheel_t * wheel, twheel_handle_t handle);
+size_t twheel_advance(twheel_t * wheel,
+                      uint64_t now,
+                      twheel_expired_t * expired,
+                      size_t max_count);
+uint64_t twheel_current_tick(twheel_t * wheel);
+size_t twheel_length(twheel_t * wheel);
+bool twheel_is_empty(twheel_t * wheel);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+#endif //TIMER_WHEEL_H
@@ -0,0 +1,657 @@
+#include <timer_wheel.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+typedef enum
+{
+    NODE_BASE_SIZE = 64,
+    LEVEL_BITS = 8,                 // Bits of the tick covered by each level
+    SLOT_COUNT = 256,               // Slots of each level, 1 << LEVEL_BITS
+    LEVEL_COUNT = 4,                // The wheel reaches 2^32 ticks ahead
+    BITMAP_WORDS = 4,               // Words of the bitmap of each level
+} twheel_default_t;
+
+// Where a node is kept, the wheel levels come first
+typedef enum
+{
+    LOCATION_HEAP = LEVEL_COUNT,    // Too far ahead for the wheel
+    LOCATION_FREE                   // Not scheduled
+} twheel_location_t;
+
+// Enum for determining if malloc calls were valid
+typedef enum
+{
+    VALID_PTR = 1,
+    INVALID_PTR = 0
+} twheel_pointer_t;
+
+#define SLOT_MASK ((uint64_t)SLOT_COUNT - 1)
+#define WHEEL_SPAN ((uint64_t)1 << (LEVEL_BITS * LEVEL_COUNT))
+#define NIL_INDEX UINT32_MAX
+
+// Nodes are linked by index so the node array can be reallocated
+typedef struct twheel_node_t
+{
+    uint64_t deadline;
+    void * payload;
+    heap_handle_t heap_handle;      // Handle in the far heap
+    uint32_t next;                  // Next node of the slot or free list
+    uint32_t prev;                  // Previous node of the slot
+    uint32_t generation;            // Bumped every time the node is freed
+    uint8_t location;               // Wheel level, heap or free
+    uint8_t slot;                   // Slot of the level
+} twheel_node_t;
+
+// Entry of the heap of the timers too far ahead for the wheel
+typedef struct far_entry_t
+{
+    uint64_t deadline;
+    uint32_t index;                 // Index of the node
+} far_entry_t;
+
+typedef struct twheel_t
+{
+    uint64_t current;               // Every tick before this one has expired
+    size_t length;                  // Timers in the wheel and the heap
+    size_t wheel_length;            // Timers in the wheel levels
+    twheel_node_t * nodes;
+    uint32_t node_count;            // Number of nodes ever handed out
+    uint32_t node_size;             // Physical size of the node array
+    uint32_t free_node;             // Head of the list of released nodes
+    heap_t * far_heap;
+    void (* destroy)(void * payload);
+    uint32_t heads[LEVEL_COUNT][SLOT_COUNT];
+    uint64_t occupied[LEVEL_COUNT][BITMAP_WORDS];
+} twheel_t;
+
+static void place_node(twheel_t * wheel, uint32_t index);
+static void unlink_node(twheel_t * wheel, uint32_t index);
+static uint32_t acquire_node(twheel_t * wheel);
+static void release_node(twheel_t * wheel, uint32_t index);
+static void pull_far(twheel_t * wheel);
+static void cascade(twheel_t * wheel);
+static size_t expire_slot(twheel_t * wheel,
+                          twheel_expired_t * expired,
+                          size_t max_count);
+
+static uint64_t get_next_tick(twheel_t * wheel);
+static size_t get_next_slot(twheel_t * wheel, size_t level, size_t slot);
+static size_t get_highest_bit(uint64_t value);
+static size_t get_lowest_bit(uint64_t value);
+static heap_compare_t compare_far(void * payload, void * payload2);
+static twheel_pointer_t verify_alloc(void * ptr);
+
+
+
+/*!
+ * @brief Create the timing wheel
+ *
+ * The wheel has four levels of 256 slots. A timer goes in the lowest level
+ * whose slots still tell its deadline apart from the current tick, so a
+ * timer in level 0 expires when the wheel reaches its slot and a timer in a
+ * higher level is moved down a level when the wheel reaches its slot.
+ * Deadlines 2^32 ticks ahead or more are kept in a heap_t until the wheel
+ * comes within reach. Scheduling and cancelling are O(1) for timers in the
+ * wheel and O(log n) for the timers in the heap.
+ * @param start_tick First tick of the wheel
+ * @param destroy Pointer to function that frees the payloads left in the
+ * wheel, or NULL
+ * @return Pointer to twheel_t or NULL
+ */
+twheel_t * twheel_init(uint64_t start_tick, void (* destroy)(void *))
+{
+    twheel_t * wheel = (twheel_t *)calloc(1, sizeof(twheel_t));
+    if (INVALID_PTR == verify_alloc((void *)wheel))
+    {
+        return NULL;
+    }
+
+    wheel->far_heap = heap_init_indexed(MIN_HEAP,
+                                        HEAP_MEM,
+                                        sizeof(far_entry_t),
+                                        NULL,
+                                        compare_far,
+                                        HEAP_4_ARY);
+    if (NULL == wheel->far_heap)
+    {
+        free(wheel);
+        return NULL;
+    }
+
+    wheel->current = start_tick;
+    wheel->free_node = NIL_INDEX;
+    wheel->destroy = destroy;
+    for (size_t level = 0; level < LEVEL_COUNT; level++)
+    {
+        for (size_t slot = 0; slot < SLOT_COUNT; slot++)
+        {
+            wheel->heads[level][slot] = NIL_INDEX;
+        }
+    }
+    return wheel;
+}
+
+/*!
+ * @brief Destroy the wheel and the payloads of the timers left in it
+ * @param wheel
+ */
+void twheel_destroy(twheel_t * wheel)
+{
+    assert(wheel);
+    if (NULL != wheel->destroy)
+    {
+        for (uint32_t i = 0; i < wheel->node_count; i++)
+        {
+            if (LOCATION_FREE != wheel->nodes[i].location)
+            {
+                wheel->destroy(wheel->nodes[i].payload);
+            }
+        }
+    }
+    heap_destroy(wheel->far_heap);
+    free(wheel->nodes);
+    free(wheel);
+}
+
+/*!
+ * @brief Schedule the payload to expire at the deadline. A deadline before
+ * the current tick expires on the current tick.
+ * @param wheel
+ * @param deadline Tick the timer expires on
+ * @param payload Pointer handed back when the timer expires
+ * @return Handle of the timer or TWHEEL_INVALID_HANDLE if the memory could
+ * not be allocated
+ */
+twheel_handle_t twheel_schedule(twheel_t * wheel,
+                                uint64_t deadline,
+                                void * payload)
+{
+    assert(wheel);
+    uint32_t index = acquire_node(wheel);
+    if (NIL_INDEX == index)
+    {
+        return TWHEEL_INVALID_HANDLE;
+    }
+
+    twheel_node_t * node = &wheel->nodes[index];
+    node->deadline = (deadline < wheel->current) ? wheel->current : deadline;
+    node->payload = payload;
+    place_node(wheel, index);
+    wheel->length++;
+    return ((twheel_handle_t)node->generation << 32) | index;
+}
+
+/*!
+ * @brief Cancel the timer of the handle.
+ *
+ * The payload is written to out. If out is NULL the payload is passed to
+ * destroy if one was provided.
+ * @param wheel
+ * @param handle Handle returned by twheel_schedule
+ * @param out Caller owned storage for the payload or NULL
+ * @return HEAP_SUCCESS or HEAP_FAILURE if the timer already expired or was
+ * cancelled
+ */
+heap_result_t twheel_cancel(twheel_t * wheel,
+                            twheel_handle_t handle,
+                            void ** out)
+{
+    if (!(twheel_is_scheduled(wheel, handle)))
+    {
+        return HEAP_FAILURE;
+    }
+
+    uint32_t index = (uint32_t)handle;
+    void * payload = wheel->nodes[index].payload;
+    unlink_node(wheel, index);
+    release_node(wheel, index);
+    wheel->length--;
+
+    if (NULL != out)
+    {
+        * out = payload;
+    }
+    else if (NULL != wheel->destroy)
+    {
+        wheel->destroy(payload);
+    }
+    return HEAP_SUCCESS;
+}
+
+/*!
+ * @brief Check if the timer of the handle is still waiting to expire
+ * @param wheel
+ * @param handle Handle returned by twheel_schedule
+ * @return True if the timer did not expire and was not cancelled
+ */
+bool twheel_is_scheduled(twheel_t * wheel, twheel_handle_t handle)
+{
+    assert(wheel);
+    uint32_t index = (uint32_t)handle;
+    if (index >= wheel->node_count)
+    {
+        return false;
+    }
+
+    twheel_node_t * node = &wheel->nodes[index];
+    return (LOCATION_FREE != node->location)
+           && (node->generation == (uint32_t)(handle >> 32));
+}
+
+/*!
+ * @brief Move the wheel up to the tick now and hand back the timers that
+ * expired.
+ *
+ * Timers come out in the order of their deadlines. At most max_count timers
+ * are written to expired. If more timers expired, the wheel stops on the
+ * tick of the last one and the next call carries on from there, so the
+ * caller can drain the wheel in batches until fewer than max_count timers are
+ * returned. Runs of empty ticks are skipped without visiting them.
+ * @param wheel
+ * @param now Last tick to expire, lower than UINT64_MAX
+ * @param expired Caller owned array of at least max_count entries
+ * @param max_count Size of the expired array
+ * @return Number of timers written to expired
+ */
+size_t twheel_advance(twheel_t * wheel,
+                      uint64_t now,
+                      twheel_expired_t * expired,
+                      size_t max_count)
+{
+    assert(wheel);
+    assert(expired);
+    assert(UINT64_MAX != now);
+
+    size_t count = 0;
+    while ((count < max_count) && (wheel->current <= now))
+    {
+        pull_far(wheel);
+        cascade(wheel);
+        count += expire_slot(wheel, expired + count, max_count - count);
+
+        // Stay on the tick if the batch filled up before the slot emptied
+        if (NIL_INDEX != wheel->heads[0][wheel->current & SLOT_MASK])
+        {
+            break;
+        }
+
+        uint64_t next = get_next_tick(wheel);
+        wheel->current = (next > now) ? now + 1 : next;
+    }
+    return count;
+}
+
+/*!
+ * @brief Return the first tick that has not expired yet
+ * @param wheel
+ * @return Current tick
+ */
+uint64_t twheel_current_tick(twheel_t * wheel)
+{
+    assert(wheel);
+    return wheel->current;
+}
+
+/*!
+ * @brief Return the number of scheduled timers
+ * @param wheel
+ * @return Number of timers
+ */
+size_t twheel_length(twheel_t * wheel)
+{
+    assert(wheel);
+    return wheel->length;
+}
+
+/*!
+ * @brief Check if no timers are scheduled
+ * @param wheel
+ * @return True if the wheel is empty
+ */
+bool twheel_is_empty(twheel_t * wheel)
+{
+    assert(wheel);
+    return 0 == wheel->length;
+}
+
+/*!
+ * @brief Put the node in the slot of the lowest level that tells its
+ * deadline apart from the current tick, or in the far heap if no level does
+ * @param wheel
+ * @param index Index of the node
+ */
+static void place_node(twheel_t * wheel, uint32_t index)
+{
+    twheel_node_t * node = &wheel->nodes[index];
+    uint64_t difference = node->deadline ^ wheel->current;
+    size_t level = (0 == difference)
+                   ? 0 : get_highest_bit(difference) / LEVEL_BITS;
+    if (level >= LEVEL_COUNT)
+    {
+        far_entry_t entry = {
+            .deadline   = node->deadline,
+            .index      = index
+        };
+        node->location = LOCATION_HEAP;
+        node->heap_handle = heap_insert_handle(wheel->far_heap, &entry);
+        return;
+    }
+
+    size_t slot = (size_t)((node->deadline >> (level * LEVEL_BITS))
+                           & SLOT_MASK);
+    uint32_t head = wheel->heads[level][slot];
+    node->location = (uint8_t)level;
+    node->slot = (uint8_t)slot;
+    node->prev = NIL_INDEX;
+    node->next = head;
+    if (NIL_INDEX != head)
+    {
+        wheel->nodes[head].prev = index;
+    }
+    wheel->heads[level][slot] = index;
+    wheel->occupied[level][slot / 64] |= (uint64_t)1 << (slot % 64);
+    wheel->wheel_length++;
+}
+
+/*!
+ * @brief Take the node out of its slot or out of the far heap
+ * @param wheel
+ * @param index Index of the node
+ */
+static void unlink_node(twheel_t * wheel, uint32_t index)
+{
+    twheel_node_t * node = &wheel->nodes[index];
+    if (LOCATION_HEAP == node->location)
+    {
+        heap_remove(wheel->far_heap, node->heap_handle, NULL);
+        return;
+    }
+
+    size_t level = node->location;
+    size_t slot = node->slot;
+    if (NIL_INDEX != node->prev)
+    {
+        wheel->nodes[node->prev].next = node->next;
+    }
+    else
+    {
+        wheel->heads[level][slot] = node->next;
+    }
+    if (NIL_INDEX != node->next)
+    {
+        wheel->nodes[node->next].prev = node->prev;
+    }
+
+    if (NIL_INDEX == wheel->heads[level][slot])
+    {
+        wheel->occupied[level][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+    }
+    wheel->wheel_length--;
+}
+
+/*!
+ * @brief Hand out a node. Released nodes are reused before the node array
+ * grows.
+ * @param wheel
+ * @return Index of the node or NIL_INDEX if the memory could not be allocated
+ */
+static uint32_t acquire_node(twheel_t * wheel)
+{
+    uint32_t index = wheel->free_node;
+    if (NIL_INDEX != index)
+    {
+        wheel->free_node = wheel->nodes[index].next;
+        return index;
+    }
+
+    if (wheel->node_count == wheel->node_size)
+    {
+        uint32_t node_size = (0 == wheel->node_size)
+                             ? NODE_BASE_SIZE : wheel->node_size * 2;
+        if (node_size <= wheel->node_size)
+        {
+            return NIL_INDEX;
+        }
+
+        void * re_alloc = realloc(wheel->nodes,
+                                  sizeof(twheel_node_t) * node_size);
+        if (INVALID_PTR == verify_alloc(re_alloc))
+        {
+            return NIL_INDEX;
+        }
+        wheel->nodes = re_alloc;
+        wheel->node_size = node_size;
+    }
+
+    index = wheel->node_count;
+    wheel->node_count++;
+    wheel->nodes[index].generation = 0;
+    return index;
+}
+
+/*!
+ * @brief Put the node on the free list. Its generation changes so the
+ * handles of the old timer no longer match it.
+ * @param wheel
+ * @param index Index of the node
+ */
+static void release_node(twheel_t * wheel, uint32_t index)
+{
+    twheel_node_t * node = &wheel->nodes[index];
+    node->location = LOCATION_FREE;
+    node->payload = NULL;
+    node->generation++;
+    node->next = wheel->free_node;
+    wheel->free_node = index;
+}
+
+/*!
+ * @brief Move the timers of the far heap that came within reach of the
+ * wheel into the wheel
+ * @param wheel
+ */
+static void pull_far(twheel_t * wheel)
+{
+    far_entry_t entry;
+    far_entry_t * first = (far_entry_t *)heap_peek_ref(wheel->far_heap);
+    while ((NULL != first) && ((first->deadline ^ wheel->current) < WHEEL_SPAN))
+    {
+        heap_pop_into(wheel->far_heap, &entry);
+        place_node(wheel, entry.index);
+        first = (far_entry_t *)heap_peek_ref(wheel->far_heap);
+    }
+}
+
+/*!
+ * @brief Move the timers of the slots the current tick starts down to the
+ * lower levels. The highest level goes first so its timers can be moved down
+ * again by the levels below.
+ * @param wheel
+ */
+static void cascade(twheel_t * wheel)
+{
+    for (size_t level = LEVEL_COUNT - 1; level > 0; level--)
+    {
+        size_t shift = level * LEVEL_BITS;
+        if (0 != (wheel->current & (((uint64_t)1 << shift) - 1)))
+        {
+            continue;
+        }
+
+        size_t slot = (size_t)((wheel->current >> shift) & SLOT_MASK);
+        uint32_t index = wheel->heads[level][slot];
+        wheel->heads[level][slot] = NIL_INDEX;
+        wheel->occupied[level][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+        while (NIL_INDEX != index)
+        {
+            uint32_t next = wheel->nodes[index].next;
+            wheel->wheel_length--;
+            place_node(wheel, index);
+            index = next;
+        }
+    }
+}
+
+/*!
+ * @brief Take up to max_count timers out of the level 0 slot of the current
+ * tick
+ * @param wheel
+ * @param expired Array the timers are written to
+ * @param max_count Size of the array
+ * @return Number of timers written
+ */
+static size_t expire_slot(twheel_t * wheel,
+                          twheel_expired_t * expired,
+                          size_t max_count)
+{
+    size_t slot = (size_t)(wheel->current & SLOT_MASK);
+    size_t count = 0;
+    while ((count < max_count) && (NIL_INDEX != wheel->heads[0][slot]))
+    {
+        uint32_t index = wheel->heads[0][slot];
+        twheel_node_t * node = &wheel->nodes[index];
+        expired[count] = (twheel_expired_t){
+            .deadline   = node->deadline,
+            .payload    = node->payload
+        };
+        unlink_node(wheel, index);
+        release_node(wheel, index);
+        wheel->length--;
+        count++;
+    }
+    return count;
+}
+
+/*!
+ * @brief Return the next tick where a slot has to be visited, either to
+ * expire its timers or to move them down a level.
+ *
+ * A level only holds timers in the slots after the digit of the current tick,
+ * and every slot of a level comes before the next slot of the level above, so
+ * the first occupied slot of the lowest level is the next tick. The far heap
+ * is only visited once the wheel is empty.
+ * @param wheel
+ * @return Next tick or UINT64_MAX if no timer is scheduled
+ */
+static uint64_t get_next_tick(twheel_t * wheel)
+{
+    for (size_t level = 0; level < LEVEL_COUNT; level++)
+    {
+        size_t shift = level * LEVEL_BITS;
+        size_t digit = (size_t)((wheel->current >> shift) & SLOT_MASK);
+        size_t slot = get_next_slot(wheel, level, digit + 1);
+        if (slot < SLOT_COUNT)
+        {
+            uint64_t base = (wheel->current >> (shift + LEVEL_BITS))
+                            << (shift + LEVEL_BITS);
+            return base + ((uint64_t)slot << shift);
+        }
+    }
+
+    // The earliest far timer comes within reach at the start of its span
+    far_entry_t * first = (far_entry_t *)heap_peek_ref(wheel->far_heap);
+    if (NULL != first)
+    {
+        return first->deadline & ~(WHEEL_SPAN - 1);
+    }
+    return UINT64_MAX;
+}
+
+/*!
+ * @brief Return the first occupied slot of the level from the slot onwards
+ * @param wheel
+ * @param level
+ * @param slot First slot to look at
+ * @return Index of the slot or SLOT_COUNT if there is none
+ */
+static size_t get_next_slot(twheel_t * wheel, size_t level, size_t slot)
+{
+    while (slot < SLOT_COUNT)
+    {
+        uint64_t word = wheel->occupied[level][slot / 64]
+                        & (UINT64_MAX << (slot % 64));
+        if (0 != word)
+        {
+            return (slot & ~(size_t)63) + get_lowest_bit(word);
+        }
+        slot = (slot & ~(size_t)63) + 64;
+    }
+    return SLOT_COUNT;
+}
+
+/*!
+ * @brief Return the index of the highest set bit
+ * @param value Value that is not 0
+ * @return Index of the bit, 0 for the lowest bit
+ */
+static size_t get_highest_bit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return (size_t)(63 - __builtin_clzll(value));
+#else
+    size_t bit = 0;
+    while (value >>= 1)
+    {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/*!
+ * @brief Return the index of the lowest set bit
+ * @param value Value that is not 0
+ * @return Index of the bit, 0 for the lowest bit
+ */
+static size_t get_lowest_bit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctzll(value);
+#else
+    size_t bit = 0;
+    while (0 == (value & 1))
+    {
+        value >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/*!
+ * @brief Order the far heap by deadline
+ * @param payload far_entry_t
+ * @param payload2 far_entry_t
+ * @return The result of the comparison
+ */
+static heap_compare_t compare_far(void * payload, void * payload2)
+{
+    uint64_t left = ((far_entry_t *)payload)->deadline;
+    uint64_t right = ((far_entry_t *)payload2)->deadline;
+    if (left > right)
+    {
+        return HEAP_GT;
+    }
+    else if (left < right)
+    {
+        return HEAP_LT;
+    }
+    return HEAP_EQ;
+}
+
+/*!
+ * Function verifies the alloc and reports the failure
+ *
+ * @param ptr Any allocated pointer
+ */
+static twheel_pointer_t verify_alloc(void * ptr)
+{
+    if (NULL == ptr)
+    {
+        fprintf(stderr, "[!] Could not allocate memory!\n");
+        return INVALID_PTR;
+    }
+    return VALID_PTR;
+}
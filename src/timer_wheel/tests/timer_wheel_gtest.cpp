@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+#include <timer_wheel.h>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+void twheel_payload_destroy(void * payload)
+{
+    free(payload);
+}
+
+/*
+ * Advance the wheel to now in batches and return every expired timer
+ */
+static std::vector<twheel_expired_t> drain(twheel_t * wheel, uint64_t now,
+                                           size_t batch_size)
+{
+    std::vector<twheel_expired_t> result;
+    std::vector<twheel_expired_t> batch(batch_size);
+    size_t count = 0;
+    do
+    {
+        count = twheel_advance(wheel, now, batch.data(), batch_size);
+        result.insert(result.end(), batch.begin(),
+                      batch.begin() + (long)count);
+    } while (count == batch_size);
+    return result;
+}
+
+TEST(TimerWheel, ExpiresInDeadlineOrder)
+{
+    twheel_t * wheel = twheel_init(0, NULL);
+    std::mt19937_64 engine(1);
+    std::vector<uint64_t> deadlines(20000);
+    for (uint64_t & deadline : deadlines)
+    {
+        // Spread the deadlines over every level of the wheel
+        deadline = engine() >> (engine() % 32 + 32);
+        ASSERT_NE(twheel_schedule(wheel, deadline, &deadline),
+                  TWHEEL_INVALID_HANDLE);
+    }
+    EXPECT_EQ(twheel_length(wheel), deadlines.size());
+
+    uint64_t now = 0;
+    uint64_t last = 0;
+    size_t expired_count = 0;
+    while (!twheel_is_empty(wheel))
+    {
+        now += engine() % 100000000;
+        for (twheel_expired_t & expired : drain(wheel, now, 64))
+        {
+            ASSERT_LE(expired.deadline, now);
+            ASSERT_GE(expired.deadline, last);
+            ASSERT_EQ(* (uint64_t *)expired.payload, expired.deadline);
+            last = expired.deadline;
+            expired_count++;
+        }
+        EXPECT_EQ(twheel_current_tick(wheel), now + 1);
+    }
+    EXPECT_EQ(expired_count, deadlines.size());
+    twheel_destroy(wheel);
+}
+
+TEST(TimerWheel, CancelMostTimers)
+{
+    twheel_t * wheel = twheel_init(1000, twheel_payload_destroy);
+    std::vector<twheel_handle_t> handles;
+    for (int i = 0; i < 10000; i++)
+    {
+        int * payload = (int *)malloc(sizeof(int));
+        * payload = i;
+        handles.push_back(twheel_schedule(wheel, 1000 + (uint64_t)i * 7,
+                                          payload));
+    }
+
+    for (size_t i = 0; i < handles.size(); i++)
+    {
+        if (0 != i % 10)
+        {
+            ASSERT_EQ(twheel_cancel(wheel, handles[i], NULL), HEAP_SUCCESS);
+            EXPECT_FALSE(twheel_is_scheduled(wheel, handles[i]));
+            EXPECT_EQ(twheel_cancel(wheel, handles[i], NULL), HEAP_FAILURE);
+        }
+    }
+    EXPECT_EQ(twheel_length(wheel), 1000);
+
+    // The nodes of the cancelled timers are reused without matching the old
+    // handles
+    int * payload = (int *)malloc(sizeof(int));
+    twheel_handle_t handle = twheel_schedule(wheel, 5000, payload);
+    EXPECT_FALSE(twheel_is_scheduled(wheel, handles[9999]));
+    EXPECT_TRUE(twheel_is_scheduled(wheel, handle));
+    void * out = nullptr;
+    ASSERT_EQ(twheel_cancel(wheel, handle, &out), HEAP_SUCCESS);
+    EXPECT_EQ(out, payload);
+    free(out);
+
+    std::vector<twheel_expired_t> expired = drain(wheel, 1000000, 100);
+    ASSERT_EQ(expired.size(), 1000);
+    for (size_t i = 0; i < expired.size(); i++)
+    {
+        EXPECT_EQ(* (int *)expired[i].payload, (int)i * 10);
+        free(expired[i].payload);
+    }
+    EXPECT_TRUE(twheel_is_empty(wheel));
+    twheel_destroy(wheel);
+}
+
+TEST(TimerWheel, FarDeadlinesUseTheHeap)
+{
+    const uint64_t far = (uint64_t)1 << 40;
+    twheel_t * wheel = twheel_init(5, NULL);
+    twheel_handle_t cancelled = twheel_schedule(wheel, far + 3, NULL);
+    twheel_schedule(wheel, far + 1, NULL);
+    twheel_schedule(wheel, far, NULL);
+    twheel_schedule(wheel, far * 4, NULL);
+    twheel_schedule(wheel, 10, NULL);
+    ASSERT_EQ(twheel_cancel(wheel, cancelled, NULL), HEAP_SUCCESS);
+
+    std::vector<twheel_expired_t> expired = drain(wheel, far, 2);
+    ASSERT_EQ(expired.size(), 2);
+    EXPECT_EQ(expired[0].deadline, 10);
+    EXPECT_EQ(expired[1].deadline, far);
+
+    expired = drain(wheel, far * 4 - 1, 2);
+    ASSERT_EQ(expired.size(), 1);
+    EXPECT_EQ(expired[0].deadline, far + 1);
+    EXPECT_EQ(twheel_length(wheel), 1);
+
+    expired = drain(wheel, far * 4, 2);
+    ASSERT_EQ(expired.size(), 1);
+    EXPECT_EQ(expired[0].deadline, far * 4);
+    twheel_destroy(wheel);
+}
+
+TEST(TimerWheel, BatchesAndPastDeadlines)
+{
+    twheel_t * wheel = twheel_init(0, NULL);
+    for (int i = 0; i < 100; i++)
+    {
+        twheel_schedule(wheel, 300, NULL);
+    }
+
+    std::vector<twheel_expired_t> batch(16);
+    size_t total = 0;
+    size_t count = 0;
+    while (0 != (count = twheel_advance(wheel, 1000, batch.data(), 16)))
+    {
+        total += count;
+        EXPECT_EQ(batch[0].deadline, 300);
+        EXPECT_EQ(twheel_current_tick(wheel), (total < 100) ? 300 : 1001);
+    }
+    EXPECT_EQ(total, 100);
+
+    // A deadline that passed expires on the next tick
+    twheel_schedule(wheel, 10, NULL);
+    EXPECT_EQ(twheel_advance(wheel, 1000, batch.data(), 16), 0);
+    ASSERT_EQ(twheel_advance(wheel, 1001, batch.data(), 16), 1);
+    EXPECT_EQ(batch[0].deadline, 1001);
+    twheel_destroy(wheel);
+}
+
+TEST(TimerWheel, RandomOperationsMatchMultimap)
+{
+    twheel_t * wheel = twheel_init(0, NULL);
+    std::multimap<uint64_t, uintptr_t> expected;
+    std::map<uintptr_t, std::pair<uint64_t, twheel_handle_t>> timers;
+    std::mt19937_64 engine(7);
+    uint64_t now = 0;
+    uintptr_t next_id = 1;
+
+    // Erase the timer of the id from the expected timers
+    auto erase_expected = [&](uint64_t deadline, uintptr_t id) {
+        auto range = expected.equal_range(deadline);
+        for (auto item = range.first; item != range.second; item++)
+        {
+            if (item->second == id)
+            {
+                expected.erase(item);
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (int round = 0; round < 200; round++)
+    {
+        for (int i = 0; i < 500; i++)
+        {
+            // Deadlines up to 2^40 ticks ahead reach the far heap
+            uint64_t deadline = now + 1 + (engine() >> (engine() % 40 + 24));
+            timers[next_id] = {deadline,
+                               twheel_schedule(wheel, deadline,
+                                               (void *)next_id)};
+            expected.insert({deadline, next_id});
+            next_id++;
+        }
+
+        // Cancel most of the timers
+        for (auto it = timers.begin(); it != timers.end();)
+        {
+            if (engine() % 4 == 0)
+            {
+                it++;
+                continue;
+            }
+            void * out = nullptr;
+            ASSERT_EQ(twheel_cancel(wheel, it->second.second, &out),
+                      HEAP_SUCCESS);
+            ASSERT_EQ((uintptr_t)out, it->first);
+            ASSERT_TRUE(erase_expected(it->second.first, it->first));
+            it = timers.erase(it);
+        }
+
+        now += engine() >> (engine() % 34 + 30);
+        std::vector<twheel_expired_t> expired = drain(wheel, now, 32);
+        size_t expected_count = (size_t)std::distance(
+            expected.begin(), expected.upper_bound(now));
+        ASSERT_EQ(expired.size(), expected_count);
+        for (twheel_expired_t & item : expired)
+        {
+            uintptr_t id = (uintptr_t)item.payload;
+            ASSERT_EQ(item.deadline, expected.begin()->first);
+            ASSERT_TRUE(erase_expected(item.deadline, id));
+            ASSERT_FALSE(twheel_is_scheduled(wheel, timers[id].second));
+            timers.erase(id);
+        }
+        ASSERT_EQ(twheel_length(wheel), expected.size());
+    }
+    twheel_destroy(wheel);
+}